@@ -0,0 +1,69 @@
+// simpleDB parse-throughput microbenchmark
+//
+// Times SelectProcessor::parse and InsertProcessor::parse in a loop over a
+// 5-column table and prints the best average per statement. Built only with
+// -DSIMPLEDB_BUILD_BENCH=ON; uses the database "parse_bench" under
+// ~/simpledb.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../includes/storage.h"
+#include "../includes/query_handler/insert.h"
+#include "../includes/query_handler/select.h"
+
+// Best of several rounds of iterations calls, in microseconds per call.
+template<typename Fn>
+static double microsPerCall(size_t iterations, Fn&& fn) {
+    double best = 1e300;
+    for (int round = 0; round < 5; ++round) {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) fn();
+        const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count() / iterations);
+    }
+    return best;
+}
+
+int main() {
+    Storage storage("parse_bench", 1);
+    try {
+        storage.createTable("u", {"id", "name", "age", "city", "active"},
+                            {Value::INT, Value::STRING, Value::INT, Value::STRING, Value::BOOL});
+    } catch (const std::invalid_argument&) {
+        // Left by an earlier run
+    }
+    SelectProcessor selectProcessor(storage);
+    InsertProcessor insertProcessor(storage);
+
+    std::string manyRows = "INSERT INTO u VALUES ";
+    for (int i = 0; i < 100; ++i) {
+        manyRows += (i ? ", (" : "(") + std::to_string(i) + ", alice, 30, Berlin, true)";
+    }
+
+    const std::vector<std::string> selects = {
+        "SELECT id, name, age FROM u WHERE age = 42",
+        "SELECT * FROM u WHERE city = Berlin",
+        "SELECT name FROM u WHERE age BETWEEN 18 AND 30",
+    };
+    const std::vector<std::string> inserts = {
+        "INSERT INTO u VALUES 1, alice, 30, Berlin, true",
+        manyRows,
+    };
+
+    size_t checksum = 0; // Keeps the parses from being optimized away
+    for (const std::string& query : selects) {
+        const double us = microsPerCall(200000, [&] { checksum += selectProcessor.parse(query).select.colIndices.size(); });
+        std::printf("%-50.50s %8.2f us\n", query.c_str(), us);
+    }
+    for (const std::string& query : inserts) {
+        const size_t iterations = query.size() > 100 ? 5000 : 200000;
+        const double us = microsPerCall(iterations, [&] { checksum += insertProcessor.parse(query).insert.rows.size(); });
+        std::printf("%-50.50s %8.2f us\n", query.c_str(), us);
+    }
+    std::printf("(checksum %zu)\n", checksum);
+    return 0;
+}
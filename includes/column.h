@@ -2,64 +2,421 @@
 #define COLUMN_H
 
 #include "value.h"
+#include "string_dictionary.h"
+#include "simd/scan_kernels.h"
+#include <algorithm>
+#include <climits>
+#include <memory>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <cstdint>
 #include <stdexcept>
 #include <iostream>
 #include <unordered_map>
 
+/*
+===========================================================================
+Column Class:
+Stores every value of a single table column in one contiguous, typed array.
+
+Only the vector matching the column type is populated, so a scan over an
+INT column streams plain ints instead of chasing full Value objects. Values
+are converted back into Value on the way out (getValue) for callers that
+work with rows.
+
+STRING columns are dictionary encoded: each distinct string is stored once
+in a StringDictionary and cells hold its uint32 code. Equality scans look
+the target up once and then compare codes; range scans evaluate the bounds
+once per distinct string instead of once per row.
+===========================================================================
+*/
 class Column {
 private:
   std::string columnName;
   Value::Type columnType;
-  std::vector<Value> values;
+  std::vector<int> intValues;
+  std::vector<uint8_t> boolValues; // uint8_t instead of vector<bool> to keep byte-addressable storage
+  std::vector<uint32_t> stringCodes;
+  std::unique_ptr<StringDictionary> dictionary; // STRING columns only; heap-allocated so its address survives moves
   bool isPrimaryKey;
+
+  void checkType(const Value& val) const {
+    if (!Value::isValidType(val, columnType)) {
+      throw std::invalid_argument("Type mismatch for column");
+    }
+  }
+
+  // Range scan over one typed array; key converts a bound to the element type.
+  template<typename T, typename KeyFn>
+  static void scanTypedRange(const std::vector<T>& values, const ValueRange& range, KeyFn key,
+                             size_t begin, size_t end, std::vector<size_t>& matches) {
+    const bool hasLower = range.lower.has_value();
+    const bool hasUpper = range.upper.has_value();
+    const T lower = hasLower ? key(*range.lower) : T();
+    const T upper = hasUpper ? key(*range.upper) : T();
+    for (size_t i = begin; i < end; ++i) {
+      const T& v = values[i];
+      if (hasLower && (range.lowerInclusive ? v < lower : !(lower < v))) continue;
+      if (hasUpper && (range.upperInclusive ? upper < v : !(v < upper))) continue;
+      matches.push_back(i);
+    }
+  }
+
+  void checkRowIndex(size_t rowIndex) const {
+    if (rowIndex >= size()) {
+      throw std::out_of_range("Row index out of range");
+    }
+  }
+
 public:
-  Column() = default;
-  Column(const std::string& name, Value::Type type, bool primaryKey = false) : columnName(name), columnType(type), isPrimaryKey(primaryKey) {}
-  
+  Column() : columnType(Value::NULL_TYPE), isPrimaryKey(false) {}
+  Column(const std::string& name, Value::Type type, bool primaryKey = false) : columnName(name), columnType(type), isPrimaryKey(primaryKey) {
+    if (type == Value::STRING) {
+      dictionary = std::make_unique<StringDictionary>();
+    }
+  }
+
+  Column(const Column& other)
+      : columnName(other.columnName), columnType(other.columnType), intValues(other.intValues),
+        boolValues(other.boolValues), stringCodes(other.stringCodes),
+        dictionary(other.dictionary ? std::make_unique<StringDictionary>(*other.dictionary) : nullptr),
+        isPrimaryKey(other.isPrimaryKey) {}
+
+  Column& operator=(const Column& other) {
+    if (this != &other) {
+      Column copy(other);
+      *this = std::move(copy);
+    }
+    return *this;
+  }
+
+  Column(Column&&) noexcept = default;
+  Column& operator=(Column&&) noexcept = default;
+
   const std::string& getName() const { return columnName; }
   Value::Type getType() const { return columnType; }
   bool getIsPrimaryKey() const { return isPrimaryKey; }
-  
-  void insertValue(const Value& val) { // Bound to be changed when btree is implemented
-    if (!Value::isValidType(val, columnType)) {
-      throw std::invalid_argument("Type mismatch for column");
+
+  /**
+   * Returns the number of values stored in the column.
+   *
+   * @return Number of values.
+   */
+  size_t size() const {
+    switch (columnType) {
+      case Value::INT:
+        return intValues.size();
+      case Value::BOOL:
+        return boolValues.size();
+      case Value::STRING:
+        return stringCodes.size();
+      default:
+        return 0;
+    }
+  }
+
+  /**
+   * Reserves capacity for at least n values.
+   *
+   * @param n Number of values to reserve space for.
+   */
+  void reserve(size_t n) {
+    switch (columnType) {
+      case Value::INT:
+        intValues.reserve(n);
+        break;
+      case Value::BOOL:
+        boolValues.reserve(n);
+        break;
+      case Value::STRING:
+        stringCodes.reserve(n);
+        break;
+      default:
+        break;
+    }
+  }
+
+  /**
+   * Appends a value to the end of the column.
+   *
+   * @param val Value to append.
+   * @throws std::invalid_argument if the value type does not match the column type.
+   *
+   * @example
+   * Column ages("age", Value::INT);
+   * ages.insertValue(Value(30));
+   */
+  void insertValue(const Value& val) {
+    checkType(val);
+    switch (columnType) {
+      case Value::INT:
+        intValues.push_back(val.getInt());
+        break;
+      case Value::BOOL:
+        boolValues.push_back(val.getBool() ? 1 : 0);
+        break;
+      case Value::STRING:
+        stringCodes.push_back(dictionary->encode(val.getStringView()));
+        break;
+      default:
+        break;
     }
-    values.push_back(val);
   }
 
   void setValue (const Value& val, size_t rowIndex) {
-    if (!Value::isValidType(val, columnType)) {
-      throw std::invalid_argument("Type mismatch for column");
+    checkType(val);
+    checkRowIndex(rowIndex);
+    switch (columnType) {
+      case Value::INT:
+        intValues[rowIndex] = val.getInt();
+        break;
+      case Value::BOOL:
+        boolValues[rowIndex] = val.getBool() ? 1 : 0;
+        break;
+      case Value::STRING:
+        stringCodes[rowIndex] = dictionary->encode(val.getStringView());
+        break;
+      default:
+        break;
     }
-    if (rowIndex >= values.size()) {
-      throw std::out_of_range("Row index out of range");
+  }
+
+  /**
+   * Reconstructs the Value stored at the given row.
+   *
+   * @param rowIndex Index of the row.
+   * @return The stored value.
+   * @throws std::out_of_range if the row index is out of range.
+   *
+   * @example
+   * Column names("name", Value::STRING);
+   * names.insertValue(Value("Alice"));
+   * Value v = names.getValue(0); // "Alice"
+   */
+  Value getValue(size_t rowIndex) const {
+    checkRowIndex(rowIndex);
+    switch (columnType) {
+      case Value::INT:
+        return Value(intValues[rowIndex]);
+      case Value::BOOL:
+        return Value(boolValues[rowIndex] != 0);
+      case Value::STRING:
+        return Value(dictionary->decode(stringCodes[rowIndex]));
+      default:
+        return Value();
+    }
+  }
+
+  /**
+   * Compares the value at the given row with val without materializing a Value.
+   *
+   * @param rowIndex Index of the row.
+   * @param val Value to compare against.
+   * @return true if the stored value equals val.
+   */
+  bool equals(size_t rowIndex, const Value& val) const {
+    if (val.getType() != columnType) return false;
+    switch (columnType) {
+      case Value::INT:
+        return intValues[rowIndex] == val.getInt();
+      case Value::BOOL:
+        return (boolValues[rowIndex] != 0) == val.getBool();
+      case Value::STRING:
+        return dictionary->decode(stringCodes[rowIndex]) == val.getStringView();
+      default:
+        return false;
+    }
+  }
+
+  /**
+   * Returns the indices of all rows whose value equals val.
+   * The value type is resolved once, then the typed array is scanned with
+   * the vectorized kernels in simd/scan_kernels.h.
+   *
+   * @param val Value to search for.
+   * @return Row indices in ascending order.
+   *
+   * @example
+   * std::vector<size_t> matches = ages.scanEquals(Value(30));
+   */
+  std::vector<size_t> scanEquals(const Value& val) const {
+    std::vector<size_t> matches;
+    scanEquals(val, 0, size(), matches);
+    return matches;
+  }
+
+  /**
+   * Appends the indices of the rows in [begin, end) whose value equals val.
+   * Used by morsel-parallel scans, each thread covering one slice.
+   *
+   * @param val Value to search for.
+   * @param begin First row to test.
+   * @param end One past the last row to test; must not exceed size().
+   * @param matches Receives the matching row indices in ascending order.
+   */
+  void scanEquals(const Value& val, size_t begin, size_t end, std::vector<size_t>& matches) const {
+    if (val.getType() != columnType || begin >= end) return;
+
+    switch (columnType) {
+      case Value::INT:
+        ScanKernels::equalsInt32(intValues.data() + begin, end - begin, val.getInt(), begin, matches);
+        break;
+      case Value::BOOL:
+        ScanKernels::equalsUInt8(boolValues.data() + begin, end - begin, val.getBool() ? 1 : 0, begin, matches);
+        break;
+      case Value::STRING: {
+        const std::optional<uint32_t> target = dictionary->find(val.getStringView());
+        if (target) {
+          ScanKernels::equalsUInt32(stringCodes.data() + begin, end - begin, *target, begin, matches);
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  /**
+   * Returns the indices of all rows whose value lies in range.
+   * Bounds of a different type than the column match nothing.
+   *
+   * @param range Lower/upper bounds; a missing bound is open.
+   * @return Row indices in ascending order.
+   *
+   * @example
+   * ValueRange adults{Value(18), true, std::nullopt, true};
+   * std::vector<size_t> matches = ages.scanRange(adults);
+   */
+  std::vector<size_t> scanRange(const ValueRange& range) const {
+    std::vector<size_t> matches;
+    scanRange(range, 0, size(), matches);
+    return matches;
+  }
+
+  /**
+   * Appends the indices of the rows in [begin, end) whose value lies in range.
+   *
+   * @param range Lower/upper bounds; a missing bound is open.
+   * @param begin First row to test.
+   * @param end One past the last row to test; must not exceed size().
+   * @param matches Receives the matching row indices in ascending order.
+   */
+  void scanRange(const ValueRange& range, size_t begin, size_t end, std::vector<size_t>& matches) const {
+    if ((range.lower && range.lower->getType() != columnType) ||
+        (range.upper && range.upper->getType() != columnType) || begin >= end) {
+      return;
+    }
+
+    switch (columnType) {
+      case Value::INT: {
+        // Turn the bounds into an inclusive [lo, hi] for the vector kernel.
+        int lo = INT_MIN;
+        int hi = INT_MAX;
+        if (range.lower) {
+          lo = range.lower->getInt();
+          if (!range.lowerInclusive) {
+            if (lo == INT_MAX) break;
+            ++lo;
+          }
+        }
+        if (range.upper) {
+          hi = range.upper->getInt();
+          if (!range.upperInclusive) {
+            if (hi == INT_MIN) break;
+            --hi;
+          }
+        }
+        if (lo <= hi) {
+          ScanKernels::betweenInt32(intValues.data() + begin, end - begin, lo, hi, begin, matches);
+        }
+        break;
+      }
+      case Value::BOOL: {
+        auto key = [](const Value& v) { return static_cast<uint8_t>(v.getBool() ? 1 : 0); };
+        scanTypedRange(boolValues, range, key, begin, end, matches);
+        break;
+      }
+      case Value::STRING: {
+        if (dictionary->size() > end - begin) {
+          // More distinct strings than rows in this slice: test the rows directly.
+          for (size_t i = begin; i < end; ++i) {
+            if (range.contains(Value(std::string_view(dictionary->decode(stringCodes[i]))))) {
+              matches.push_back(i);
+            }
+          }
+          break;
+        }
+        // Test each distinct string once, then scan the codes.
+        std::vector<uint8_t> codeMatches(dictionary->size());
+        for (uint32_t code = 0; code < codeMatches.size(); ++code) {
+          codeMatches[code] = range.contains(Value(std::string_view(dictionary->decode(code)))) ? 1 : 0;
+        }
+        for (size_t i = begin; i < end; ++i) {
+          if (codeMatches[stringCodes[i]]) matches.push_back(i);
+        }
+        break;
+      }
+      default:
+        break;
     }
-    values[rowIndex] = val;
   }
 
   void deleteValue(size_t rowIndex) {
-    if (rowIndex >= values.size()) {
-      throw std::out_of_range("Row index out of range");
+    checkRowIndex(rowIndex);
+    switch (columnType) {
+      case Value::INT:
+        intValues.erase(intValues.begin() + rowIndex);
+        break;
+      case Value::BOOL:
+        boolValues.erase(boolValues.begin() + rowIndex);
+        break;
+      case Value::STRING:
+        stringCodes.erase(stringCodes.begin() + rowIndex);
+        break;
+      default:
+        break;
     }
-    values.erase(values.begin() + rowIndex);
+  }
+
+  /**
+   * Drops every value from row n on, e.g. to undo a failed bulk append.
+   * Strings added to the dictionary by the dropped rows stay in it.
+   *
+   * @param n Number of rows to keep; values beyond size() are ignored.
+   */
+  void truncate(size_t n) {
+    if (n >= size()) return;
+    intValues.resize(std::min(n, intValues.size()));
+    boolValues.resize(std::min(n, boolValues.size()));
+    stringCodes.resize(std::min(n, stringCodes.size()));
+  }
+
+  /**
+   * Removes all values from the column, keeping its name and type.
+   */
+  void clear() {
+    intValues.clear();
+    boolValues.clear();
+    stringCodes.clear();
+    if (dictionary) dictionary->clear();
   }
 
   void findValue(const Value& val) const {
-    for (size_t i = 0; i < values.size(); ++i) {
-      if (values[i] == val) {
+    for (size_t i = 0; i < size(); ++i) {
+      if (equals(i, val)) {
         std::cout << "Value found at index: " << i << std::endl;
         return;
       }
     }
     std::cout << "Value not found in column." << std::endl;
   }
-  
-  const std::vector<Value>& getValues() const { return values; }
+
+  // Raw typed storage, valid only for the matching column type.
+  const std::vector<int>& getIntValues() const { return intValues; }
+  const std::vector<uint8_t>& getBoolValues() const { return boolValues; }
+  const std::vector<uint32_t>& getStringCodes() const { return stringCodes; }
+  const StringDictionary& getDictionary() const { return *dictionary; }
 };
 
 #endif
-
-
-
@@ -0,0 +1,93 @@
+#ifndef MORSEL_SCAN_H
+#define MORSEL_SCAN_H
+
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+/*
+===========================================================================
+MorselScan:
+Splits a scan over rows [0, rowCount) into fixed-size morsels of
+MORSEL_ROWS rows and runs them on a ThreadPool. Threads claim the next
+unprocessed morsel as they finish one, so a slow morsel never holds up
+the rest. Morsel results are kept per morsel and concatenated in morsel
+order, so the output is identical to a serial scan.
+
+Scans shorter than two morsels, or without a pool, run serially on the
+calling thread.
+===========================================================================
+*/
+class MorselScan {
+public:
+  static constexpr size_t MORSEL_ROWS = 64 * 1024;
+
+  static size_t morselCount(size_t rowCount) {
+    return (rowCount + MORSEL_ROWS - 1) / MORSEL_ROWS;
+  }
+
+  /**
+   * Calls fn(begin, end) once per morsel, possibly concurrently.
+   *
+   * @param pool Pool to run on; nullptr runs serially.
+   * @param rowCount Number of rows to cover.
+   * @param fn Callable taking the half-open row range [begin, end).
+   *
+   * @example
+   * MorselScan::forEachMorsel(pool, rows.size(), [&](size_t begin, size_t end) {
+   *   for (size_t i = begin; i < end; ++i) out[i] = column.getValue(rows[i]);
+   * });
+   */
+  template<typename Fn>
+  static void forEachMorsel(ThreadPool* pool, size_t rowCount, Fn&& fn) {
+    const size_t morsels = morselCount(rowCount);
+    if (!pool || pool->size() == 1 || morsels < 2) {
+      if (rowCount > 0) fn(size_t(0), rowCount);
+      return;
+    }
+    pool->parallelFor(morsels, [&](size_t m) {
+      const size_t begin = m * MORSEL_ROWS;
+      fn(begin, std::min(rowCount, begin + MORSEL_ROWS));
+    });
+  }
+
+  /**
+   * Runs a filter over every morsel and returns the matching row numbers in
+   * ascending order.
+   *
+   * @param pool Pool to run on; nullptr runs serially.
+   * @param rowCount Number of rows to cover.
+   * @param filter Callable (begin, end, std::vector<size_t>& out) appending
+   *               the matching rows of [begin, end) in ascending order.
+   * @return The matching rows of all morsels.
+   *
+   * @example
+   * std::vector<size_t> rows = MorselScan::collectRows(pool, column.size(),
+   *     [&](size_t begin, size_t end, std::vector<size_t>& out) { column.scanEquals(val, begin, end, out); });
+   */
+  template<typename Filter>
+  static std::vector<size_t> collectRows(ThreadPool* pool, size_t rowCount, Filter&& filter) {
+    const size_t morsels = morselCount(rowCount);
+    if (!pool || pool->size() == 1 || morsels < 2) {
+      std::vector<size_t> rows;
+      filter(size_t(0), rowCount, rows);
+      return rows;
+    }
+
+    std::vector<std::vector<size_t>> parts(morsels);
+    pool->parallelFor(morsels, [&](size_t m) {
+      const size_t begin = m * MORSEL_ROWS;
+      filter(begin, std::min(rowCount, begin + MORSEL_ROWS), parts[m]);
+    });
+
+    size_t total = 0;
+    for (const std::vector<size_t>& part : parts) total += part.size();
+    std::vector<size_t> rows;
+    rows.reserve(total);
+    for (const std::vector<size_t>& part : parts) rows.insert(rows.end(), part.begin(), part.end());
+    return rows;
+  }
+};
+
+#endif
@@ -0,0 +1,231 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+===========================================================================
+ThreadPool Class:
+Fixed set of worker threads with one task deque each (work stealing).
+
+A task submitted from one of the pool's workers goes to that worker's own
+deque, which it pops from the back (newest first, still hot in cache);
+tasks from other threads are dealt round-robin. A worker whose deque is
+empty steals the oldest task from the front of another worker's deque, so
+no worker sits idle while another has a backlog.
+
+parallelFor is the main entry point. The calling thread works on the loop
+too, claiming iterations from a shared counter alongside the workers, so a
+parallelFor issued from inside another parallelFor (e.g. per-column index
+builds inside per-table loads) always makes progress instead of waiting
+for a free worker.
+===========================================================================
+*/
+class ThreadPool {
+private:
+  struct WorkQueue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  std::vector<std::thread> workers;
+  std::vector<std::unique_ptr<WorkQueue>> queues; // queues[i] belongs to workers[i]
+  std::atomic<size_t> pending{0};                 // Tasks queued and not yet taken
+  std::atomic<size_t> nextQueue{0};               // Round-robin target for outside submits
+  std::mutex sleepMutex;
+  std::condition_variable available;
+  bool stopping = false;
+
+  // Position of the current thread in this pool, or -1 outside it.
+  int currentWorker() const {
+    return workerPool() == this ? workerIndex() : -1;
+  }
+
+  static const ThreadPool*& workerPool() {
+    static thread_local const ThreadPool* pool = nullptr;
+    return pool;
+  }
+
+  static int& workerIndex() {
+    static thread_local int index = -1;
+    return index;
+  }
+
+  bool popOwn(size_t self, std::function<void()>& task) {
+    WorkQueue& queue = *queues[self];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    --pending;
+    return true;
+  }
+
+  bool steal(size_t self, std::function<void()>& task) {
+    for (size_t k = 1; k < queues.size(); ++k) {
+      WorkQueue& victim = *queues[(self + k) % queues.size()];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (victim.tasks.empty()) continue;
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      --pending;
+      return true;
+    }
+    return false;
+  }
+
+  void workerLoop(size_t self) {
+    workerPool() = this;
+    workerIndex() = static_cast<int>(self);
+    while (true) {
+      std::function<void()> task;
+      if (popOwn(self, task) || steal(self, task)) {
+        task();
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(sleepMutex);
+      available.wait(lock, [this] { return stopping || pending.load() > 0; });
+      if (stopping && pending.load() == 0) return;
+    }
+  }
+
+  void submit(std::function<void()> task) {
+    const int self = currentWorker();
+    const size_t target = self >= 0 ? static_cast<size_t>(self) : nextQueue++ % queues.size();
+    {
+      std::lock_guard<std::mutex> lock(queues[target]->mutex);
+      queues[target]->tasks.push_back(std::move(task));
+      ++pending;
+    }
+    // Taking sleepMutex orders this against a worker that has just checked pending.
+    { std::lock_guard<std::mutex> lock(sleepMutex); }
+    available.notify_one();
+  }
+
+  // Stops the workers started so far and waits for them to exit.
+  void stopWorkers() {
+    {
+      std::lock_guard<std::mutex> lock(sleepMutex);
+      stopping = true;
+    }
+    available.notify_all();
+    for (std::thread& worker : workers) {
+      worker.join();
+    }
+  }
+
+public:
+  // Most threads a pool may be asked for: a few per hardware thread.
+  static size_t maxThreads() {
+    return 4 * std::max<size_t>(1, std::thread::hardware_concurrency());
+  }
+
+  /**
+   * Starts a pool with the given number of threads, counting the thread
+   * that calls parallelFor. A pool of 1 runs everything on the caller.
+   *
+   * @param threadCount Total threads; 0 means one per hardware thread.
+   * @throws std::system_error if a worker thread cannot be started; the
+   *         workers already started are stopped first.
+   *
+   * @example
+   * ThreadPool pool(8);
+   */
+  explicit ThreadPool(size_t threadCount = 0) {
+    if (threadCount == 0) {
+      threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 1; i < threadCount; ++i) {
+      queues.push_back(std::make_unique<WorkQueue>());
+    }
+    try {
+      for (size_t i = 0; i + 1 < threadCount; ++i) {
+        workers.emplace_back([this, i] { workerLoop(i); });
+      }
+    } catch (...) {
+      stopWorkers();
+      throw;
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  ~ThreadPool() {
+    stopWorkers();
+  }
+
+  // Total number of threads, including the caller of parallelFor.
+  size_t size() const { return workers.size() + 1; }
+
+  /**
+   * Runs body(i) for every i in [0, count) across the pool and waits for all
+   * iterations to finish. The first exception thrown by an iteration is
+   * rethrown to the caller once every started iteration is done.
+   *
+   * @param count Number of iterations.
+   * @param body Function invoked with each iteration index.
+   *
+   * @example
+   * pool.parallelFor(columns.size(), [&](size_t col) { buildIndex(col); });
+   */
+  void parallelFor(size_t count, const std::function<void(size_t)>& body) {
+    if (count == 0) return;
+    if (count == 1 || workers.empty()) {
+      for (size_t i = 0; i < count; ++i) body(i);
+      return;
+    }
+
+    struct LoopState {
+      std::atomic<size_t> next{0};
+      size_t finished = 0;
+      std::exception_ptr error;
+      std::mutex mutex;
+      std::condition_variable done;
+    };
+    auto state = std::make_shared<LoopState>();
+    const std::function<void(size_t)>* loopBody = &body;
+
+    auto runIterations = [state, loopBody, count] {
+      size_t completed = 0;
+      std::exception_ptr error;
+      for (size_t i = state->next++; i < count; i = state->next++) {
+        try {
+          (*loopBody)(i);
+        } catch (...) {
+          if (!error) error = std::current_exception();
+        }
+        ++completed;
+      }
+      if (completed == 0) return;
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (error && !state->error) state->error = error;
+      state->finished += completed;
+      if (state->finished == count) state->done.notify_all();
+    };
+
+    const size_t helpers = std::min(workers.size(), count - 1);
+    for (size_t i = 0; i < helpers; ++i) {
+      submit(runIterations);
+    }
+    runIterations();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&] { return state->finished == count; });
+    if (state->error) {
+      std::rethrow_exception(state->error);
+    }
+  }
+};
+
+#endif
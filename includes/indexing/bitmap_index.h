@@ -0,0 +1,94 @@
+#ifndef BITMAP_INDEX_H
+#define BITMAP_INDEX_H
+
+#include "roaring_bitmap.h"
+#include <cstdint>
+#include <map>
+#include <vector>
+
+// Bitmap index (CREATE INDEX ... USING bitmap) for BOOL and other
+// low-cardinality columns: one compressed RoaringBitmap of row positions
+// per distinct key. An equality lookup is a single map probe, and the
+// per-key bitmaps can be combined with & and | without first expanding
+// them into row-id vectors. Each distinct key costs at least one
+// container, so high-cardinality columns are better served by hash or
+// B+tree indexes.
+template<typename KeyType>
+class BitmapIndex {
+private:
+    std::map<KeyType, RoaringBitmap> bitmaps;
+
+public:
+    /**
+     * Adds rowIndex to the bitmap of key.
+     *
+     * @param key Key of the row.
+     * @param rowIndex Position of the row in the table.
+     * @throws std::length_error if rowIndex does not fit in 32 bits.
+     */
+    void insert(const KeyType& key, size_t rowIndex) {
+        bitmaps[key].add(rowIndex);
+    }
+
+    /**
+     * Replaces the contents with keys[i] -> row i for every i. Rows are
+     * added in increasing order, so every container append is O(1).
+     *
+     * @param source Key of every row, in row order.
+     */
+    template<typename Source>
+    void bulkLoad(const std::vector<Source>& source) {
+        bitmaps.clear();
+        if (source.empty()) return;
+        // Consecutive rows usually share a key in low-cardinality data.
+        KeyType lastKey = static_cast<KeyType>(source[0]);
+        RoaringBitmap* last = &bitmaps[lastKey];
+        for (size_t i = 0; i < source.size(); ++i) {
+            const KeyType key = static_cast<KeyType>(source[i]);
+            if (!(key == lastKey)) {
+                lastKey = key;
+                last = &bitmaps[key];
+            }
+            last->add(i);
+        }
+    }
+
+    /**
+     * Returns the bitmap of key without copying it.
+     *
+     * @param key Key to look up.
+     * @return The key's rows, or nullptr if the key is absent.
+     */
+    const RoaringBitmap* find(const KeyType& key) const {
+        auto it = bitmaps.find(key);
+        return it == bitmaps.end() ? nullptr : &it->second;
+    }
+
+    /**
+     * Returns the rows of key in increasing row order.
+     *
+     * @param key Key to look up.
+     * @return Row indices, empty if the key is absent.
+     */
+    std::vector<size_t> search(const KeyType& key) const {
+        const RoaringBitmap* bitmap = find(key);
+        return bitmap ? bitmap->toRows() : std::vector<size_t>();
+    }
+
+    /**
+     * Appends the rows of key to out, in increasing row order.
+     *
+     * @param key Key to look up.
+     * @param out Receives the row indices; nothing is appended if the key is absent.
+     */
+    void searchInto(const KeyType& key, std::vector<size_t>& out) const {
+        if (const RoaringBitmap* bitmap = find(key)) {
+            bitmap->forEach([&out](size_t row) { out.push_back(row); });
+        }
+    }
+
+    bool isEmpty() const { return bitmaps.empty(); }
+    size_t distinctKeys() const { return bitmaps.size(); }
+};
+
+#endif
@@ -0,0 +1,530 @@
+#ifndef BPLUSTREE_H
+#define BPLUSTREE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// One end of a key range. inclusive selects <= / >= over < / >.
+template<typename KeyType>
+struct KeyBound {
+    KeyType key;
+    bool inclusive;
+};
+
+// B+tree index supporting equality lookups and ordered range scans.
+//
+// Nodes live in per-tree arenas instead of individually allocated objects:
+// every leaf owns a fixed run of slots in leafKeys/leafRows and every inner
+// node a fixed run in innerKeys/innerChildren, so a node's keys are
+// contiguous and binary-searched in place, and nodes refer to each other by
+// 32-bit arena index. Row indices live in the leaves only, and the leaves
+// are chained left to right for range scans.
+//
+// fanout is the maximum number of children of an inner node (and of keys in
+// a leaf). The default packs a node's keys into roughly 512 bytes.
+// Inner node i: children[i] holds keys < keys[i], children[i + 1] keys >= keys[i].
+template<typename KeyType>
+class BPlusTree {
+private:
+    using NodeRef = uint32_t;
+    static constexpr NodeRef NO_NODE = UINT32_MAX;
+    static constexpr NodeRef LEAF_BIT = 0x80000000u;  // Set on references to leaves
+
+    struct LeafHeader {
+        uint32_t count = 0;
+        NodeRef next = NO_NODE;  // Right sibling leaf
+    };
+
+    struct InnerHeader {
+        uint32_t count = 0;  // Number of keys; children = count + 1
+    };
+
+public:
+    static constexpr size_t MIN_FANOUT = 4;
+    static constexpr size_t DEFAULT_FANOUT =
+        std::max<size_t>(16, std::min<size_t>(128, 512 / sizeof(KeyType)));
+
+    // Forward iterator over the keys of a range, in ascending key order.
+    // Invalidated by inserts into the tree.
+    class RangeIterator {
+    private:
+        const BPlusTree* tree;
+        NodeRef leaf;
+        uint32_t pos;
+        std::optional<KeyBound<KeyType>> upper;
+
+    public:
+        RangeIterator(const BPlusTree* owner, NodeRef startLeaf, uint32_t startPos,
+                      std::optional<KeyBound<KeyType>> hi);
+
+        bool valid() const;
+        KeyType key() const { return tree->leafKeys[tree->leafSlot(leaf) + pos]; }
+        const std::vector<size_t>& rows() const { return tree->leafRows[tree->leafSlot(leaf) + pos]; }
+        void next();
+    };
+
+    explicit BPlusTree(size_t nodeFanout = DEFAULT_FANOUT);
+
+    void insert(const KeyType& key, size_t rowIndex);
+    // Replaces the contents with keys[i] -> row i for every i, built bottom-up.
+    template<typename Source>
+    void bulkLoad(const std::vector<Source>& keys);
+    // Same as bulkLoad for a dictionary-encoded column (row i has key
+    // dictionary.decode(codes[i])): only the distinct keys are sorted, then
+    // rows are bucketed by the rank of their code.
+    template<typename Dictionary>
+    void bulkLoadEncoded(const Dictionary& dictionary, const std::vector<uint32_t>& codes);
+    std::vector<size_t> search(const KeyType& key) const;
+    // Appends the rows of key to out, without copying them into a vector of their own first.
+    void searchInto(const KeyType& key, std::vector<size_t>& out) const;
+    RangeIterator rangeSearch(const std::optional<KeyBound<KeyType>>& lo,
+                              const std::optional<KeyBound<KeyType>>& hi) const;
+    // Smallest and largest key, read from the ends of the leaf level; nullopt if the tree is empty.
+    std::optional<KeyType> minKey() const;
+    std::optional<KeyType> maxKey() const;
+    bool isEmpty() const { return root == NO_NODE; }
+    size_t getFanout() const { return fanout; }
+
+private:
+    size_t fanout;
+
+    // Builds packed leaves and inner levels from rows sorted by key: group g
+    // holds rows order[groupStart[g] .. groupStart[g + 1]), all with key keyAt(row).
+    template<typename KeyAt>
+    void buildSorted(const std::vector<size_t>& order, const std::vector<size_t>& groupStart, KeyAt keyAt);
+    NodeRef root = NO_NODE;
+
+    std::vector<LeafHeader> leaves;
+    std::vector<KeyType> leafKeys;                // fanout + 1 slots per leaf (one for overflow before a split)
+    std::vector<std::vector<size_t>> leafRows;    // Parallel to leafKeys
+    std::vector<InnerHeader> inners;
+    std::vector<KeyType> innerKeys;               // fanout slots per inner node
+    std::vector<NodeRef> innerChildren;           // fanout + 1 slots per inner node
+
+    static bool isLeafRef(NodeRef ref) { return (ref & LEAF_BIT) != 0; }
+    static uint32_t nodeId(NodeRef ref) { return ref & ~LEAF_BIT; }
+
+    size_t leafSlot(NodeRef ref) const { return static_cast<size_t>(nodeId(ref)) * (fanout + 1); }
+    size_t innerKeySlot(NodeRef ref) const { return static_cast<size_t>(ref) * fanout; }
+    size_t innerChildSlot(NodeRef ref) const { return static_cast<size_t>(ref) * (fanout + 1); }
+
+    NodeRef allocateLeaf();
+    NodeRef allocateInner();
+    void clear();
+
+    // Index of the child of inner node ref that covers key.
+    size_t childIndex(NodeRef ref, const KeyType& key) const;
+
+    // Inserts below node. Returns true if node split, with the separator key
+    // and new right sibling in sepOut / siblingOut.
+    bool insertInto(NodeRef node, const KeyType& key, size_t rowIndex, KeyType& sepOut, NodeRef& siblingOut);
+    bool insertIntoLeaf(NodeRef leaf, const KeyType& key, size_t rowIndex, KeyType& sepOut, NodeRef& siblingOut);
+    NodeRef findLeaf(const KeyType& key) const;
+    NodeRef leftmostLeaf() const;
+    NodeRef rightmostLeaf() const;
+};
+
+// Implementation details
+template<typename KeyType>
+BPlusTree<KeyType>::RangeIterator::RangeIterator(const BPlusTree* owner, NodeRef startLeaf, uint32_t startPos,
+                                                 std::optional<KeyBound<KeyType>> hi)
+    : tree(owner), leaf(startLeaf), pos(startPos), upper(std::move(hi)) {
+    // Skip past the end of a leaf onto the next non-empty one.
+    while (leaf != NO_NODE && pos >= tree->leaves[nodeId(leaf)].count) {
+        leaf = tree->leaves[nodeId(leaf)].next;
+        pos = 0;
+    }
+}
+
+template<typename KeyType>
+bool BPlusTree<KeyType>::RangeIterator::valid() const {
+    if (leaf == NO_NODE) return false;
+    if (!upper) return true;
+    const KeyType k = key();
+    return upper->inclusive ? !(upper->key < k) : k < upper->key;
+}
+
+template<typename KeyType>
+void BPlusTree<KeyType>::RangeIterator::next() {
+    if (++pos >= tree->leaves[nodeId(leaf)].count) {
+        leaf = tree->leaves[nodeId(leaf)].next;
+        pos = 0;
+    }
+}
+
+template<typename KeyType>
+BPlusTree<KeyType>::BPlusTree(size_t nodeFanout) : fanout(nodeFanout) {
+    if (fanout < MIN_FANOUT) {
+        throw std::invalid_argument("B+tree fanout must be at least " + std::to_string(MIN_FANOUT));
+    }
+}
+
+template<typename KeyType>
+typename BPlusTree<KeyType>::NodeRef BPlusTree<KeyType>::allocateLeaf() {
+    const NodeRef ref = static_cast<NodeRef>(leaves.size()) | LEAF_BIT;
+    leaves.emplace_back();
+    leafKeys.resize(leafKeys.size() + fanout + 1);
+    leafRows.resize(leafRows.size() + fanout + 1);
+    return ref;
+}
+
+template<typename KeyType>
+typename BPlusTree<KeyType>::NodeRef BPlusTree<KeyType>::allocateInner() {
+    const NodeRef ref = static_cast<NodeRef>(inners.size());
+    inners.emplace_back();
+    innerKeys.resize(innerKeys.size() + fanout);
+    innerChildren.resize(innerChildren.size() + fanout + 1, NO_NODE);
+    return ref;
+}
+
+template<typename KeyType>
+void BPlusTree<KeyType>::clear() {
+    root = NO_NODE;
+    leaves.clear();
+    leafKeys.clear();
+    leafRows.clear();
+    inners.clear();
+    innerKeys.clear();
+    innerChildren.clear();
+}
+
+template<typename KeyType>
+size_t BPlusTree<KeyType>::childIndex(NodeRef ref, const KeyType& key) const {
+    auto first = innerKeys.begin() + innerKeySlot(ref);
+    return std::upper_bound(first, first + inners[ref].count, key) - first;
+}
+
+template<typename KeyType>
+void BPlusTree<KeyType>::insert(const KeyType& key, size_t rowIndex) {
+    if (root == NO_NODE) {
+        root = allocateLeaf();
+    }
+
+    KeyType separator{};
+    NodeRef sibling = NO_NODE;
+    if (insertInto(root, key, rowIndex, separator, sibling)) {
+        const NodeRef newRoot = allocateInner();
+        innerKeys[innerKeySlot(newRoot)] = separator;
+        innerChildren[innerChildSlot(newRoot)] = root;
+        innerChildren[innerChildSlot(newRoot) + 1] = sibling;
+        inners[newRoot].count = 1;
+        root = newRoot;
+    }
+}
+
+template<typename KeyType>
+bool BPlusTree<KeyType>::insertIntoLeaf(NodeRef leaf, const KeyType& key, size_t rowIndex,
+                                        KeyType& sepOut, NodeRef& siblingOut) {
+    const size_t base = leafSlot(leaf);
+    const size_t count = leaves[nodeId(leaf)].count;
+    auto keysBegin = leafKeys.begin() + base;
+    const size_t pos = std::lower_bound(keysBegin, keysBegin + count, key) - keysBegin;
+    if (pos < count && leafKeys[base + pos] == key) {
+        // Duplicate key: append rowIndex
+        leafRows[base + pos].push_back(rowIndex);
+        return false;
+    }
+
+    // Shift the tail right by one; the extra slot absorbs a transient overflow.
+    std::copy_backward(keysBegin + pos, keysBegin + count, keysBegin + count + 1);
+    std::move_backward(leafRows.begin() + base + pos, leafRows.begin() + base + count,
+                       leafRows.begin() + base + count + 1);
+    leafKeys[base + pos] = key;
+    leafRows[base + pos] = std::vector<size_t>{rowIndex};
+    const size_t newCount = count + 1;
+    leaves[nodeId(leaf)].count = static_cast<uint32_t>(newCount);
+    if (newCount <= fanout) return false;
+
+    // Split the leaf; the separator is copied up and stays in the right leaf.
+    // allocateLeaf may grow the arenas, so only slot offsets are kept across it.
+    const NodeRef sibling = allocateLeaf();
+    const size_t siblingBase = leafSlot(sibling);
+    const size_t mid = newCount / 2;
+    std::copy(leafKeys.begin() + base + mid, leafKeys.begin() + base + newCount, leafKeys.begin() + siblingBase);
+    std::move(leafRows.begin() + base + mid, leafRows.begin() + base + newCount, leafRows.begin() + siblingBase);
+    leaves[nodeId(sibling)].count = static_cast<uint32_t>(newCount - mid);
+    leaves[nodeId(leaf)].count = static_cast<uint32_t>(mid);
+    leaves[nodeId(sibling)].next = leaves[nodeId(leaf)].next;
+    leaves[nodeId(leaf)].next = sibling;
+    sepOut = leafKeys[siblingBase];
+    siblingOut = sibling;
+    return true;
+}
+
+template<typename KeyType>
+bool BPlusTree<KeyType>::insertInto(NodeRef node, const KeyType& key, size_t rowIndex,
+                                    KeyType& sepOut, NodeRef& siblingOut) {
+    if (isLeafRef(node)) {
+        return insertIntoLeaf(node, key, rowIndex, sepOut, siblingOut);
+    }
+
+    const size_t childIdx = childIndex(node, key);
+    KeyType childSep{};
+    NodeRef childSibling = NO_NODE;
+    if (!insertInto(innerChildren[innerChildSlot(node) + childIdx], key, rowIndex, childSep, childSibling)) {
+        return false;
+    }
+
+    // Keys use fanout slots, so an inner node holds at most fanout keys transiently.
+    const size_t keyBase = innerKeySlot(node);
+    const size_t childBase = innerChildSlot(node);
+    const size_t count = inners[node].count;
+    std::copy_backward(innerKeys.begin() + keyBase + childIdx, innerKeys.begin() + keyBase + count,
+                       innerKeys.begin() + keyBase + count + 1);
+    std::copy_backward(innerChildren.begin() + childBase + childIdx + 1, innerChildren.begin() + childBase + count + 1,
+                       innerChildren.begin() + childBase + count + 2);
+    innerKeys[keyBase + childIdx] = childSep;
+    innerChildren[childBase + childIdx + 1] = childSibling;
+    const size_t newCount = count + 1;
+    inners[node].count = static_cast<uint32_t>(newCount);
+    if (newCount < fanout) return false;
+
+    // Split the inner node; the middle key moves up.
+    const NodeRef sibling = allocateInner();
+    const size_t siblingKeyBase = innerKeySlot(sibling);
+    const size_t siblingChildBase = innerChildSlot(sibling);
+    const size_t mid = newCount / 2;
+    sepOut = innerKeys[keyBase + mid];
+    std::copy(innerKeys.begin() + keyBase + mid + 1, innerKeys.begin() + keyBase + newCount,
+              innerKeys.begin() + siblingKeyBase);
+    std::copy(innerChildren.begin() + childBase + mid + 1, innerChildren.begin() + childBase + newCount + 1,
+              innerChildren.begin() + siblingChildBase);
+    inners[sibling].count = static_cast<uint32_t>(newCount - mid - 1);
+    inners[node].count = static_cast<uint32_t>(mid);
+    siblingOut = sibling;
+    return true;
+}
+
+template<typename KeyType>
+template<typename Source>
+void BPlusTree<KeyType>::bulkLoad(const std::vector<Source>& keys) {
+    clear();
+    if (keys.empty()) return;
+
+    // Sort row positions by (key, row) so duplicates keep insertion order.
+    std::vector<size_t> order(keys.size());
+    if constexpr (std::is_arithmetic_v<Source> && sizeof(Source) == 1) {
+        // Byte keys (BOOL columns): counting sort, stable by construction.
+        size_t offsets[257] = {};
+        for (Source key : keys) ++offsets[static_cast<uint8_t>(key) + 1];
+        for (size_t b = 1; b < 257; ++b) offsets[b] += offsets[b - 1];
+        for (size_t i = 0; i < keys.size(); ++i) order[offsets[static_cast<uint8_t>(keys[i])]++] = i;
+    } else if constexpr (std::is_arithmetic_v<Source>) {
+        // Sorting (key, row) pairs keeps comparisons on contiguous memory.
+        std::vector<std::pair<Source, size_t>> pairs(keys.size());
+        for (size_t i = 0; i < keys.size(); ++i) pairs[i] = {keys[i], i};
+        std::sort(pairs.begin(), pairs.end());
+        for (size_t i = 0; i < pairs.size(); ++i) order[i] = pairs[i].second;
+    } else if constexpr (std::is_same_v<Source, std::string>) {
+        // Sort on the first 8 bytes (big-endian, so integer order matches
+        // string order) and only touch the strings to break prefix ties.
+        std::vector<std::pair<uint64_t, size_t>> pairs(keys.size());
+        for (size_t i = 0; i < keys.size(); ++i) {
+            uint64_t prefix = 0;
+            const size_t len = std::min<size_t>(8, keys[i].size());
+            for (size_t b = 0; b < len; ++b) {
+                prefix |= static_cast<uint64_t>(static_cast<unsigned char>(keys[i][b])) << (56 - 8 * b);
+            }
+            pairs[i] = {prefix, i};
+        }
+        std::sort(pairs.begin(), pairs.end(), [&keys](const auto& a, const auto& b) {
+            if (a.first != b.first) return a.first < b.first;
+            if (a.second == b.second) return false;
+            const int cmp = keys[a.second].compare(keys[b.second]);
+            return cmp < 0 || (cmp == 0 && a.second < b.second);
+        });
+        for (size_t i = 0; i < pairs.size(); ++i) order[i] = pairs[i].second;
+    } else {
+        for (size_t i = 0; i < keys.size(); ++i) order[i] = i;
+        std::sort(order.begin(), order.end(), [&keys](size_t a, size_t b) {
+            return keys[a] < keys[b] || (!(keys[b] < keys[a]) && a < b);
+        });
+    }
+
+    // Group duplicates into one entry per distinct key.
+    std::vector<size_t> groupStart;  // Offsets into order where a new key begins
+    for (size_t i = 0; i < order.size(); ++i) {
+        if (i == 0 || keys[order[i - 1]] < keys[order[i]]) groupStart.push_back(i);
+    }
+    groupStart.push_back(order.size());
+    buildSorted(order, groupStart, [&keys](size_t row) { return static_cast<KeyType>(keys[row]); });
+}
+
+template<typename KeyType>
+template<typename Dictionary>
+void BPlusTree<KeyType>::bulkLoadEncoded(const Dictionary& dictionary, const std::vector<uint32_t>& codes) {
+    clear();
+    if (codes.empty()) return;
+
+    // Rank the distinct keys; equal keys cannot occur in a dictionary.
+    std::vector<uint32_t> sortedCodes(dictionary.size());
+    for (uint32_t c = 0; c < sortedCodes.size(); ++c) sortedCodes[c] = c;
+    std::sort(sortedCodes.begin(), sortedCodes.end(), [&dictionary](uint32_t a, uint32_t b) {
+        return dictionary.decode(a) < dictionary.decode(b);
+    });
+    std::vector<uint32_t> rank(dictionary.size());
+    for (uint32_t r = 0; r < sortedCodes.size(); ++r) rank[sortedCodes[r]] = r;
+
+    // Counting sort of the rows by rank, stable so duplicates keep row order.
+    std::vector<size_t> offsets(dictionary.size() + 1, 0);
+    for (uint32_t code : codes) ++offsets[rank[code] + 1];
+    for (size_t r = 1; r < offsets.size(); ++r) offsets[r] += offsets[r - 1];
+    std::vector<size_t> groupStart;
+    for (size_t r = 0; r + 1 < offsets.size(); ++r) {
+        if (offsets[r] != offsets[r + 1]) groupStart.push_back(offsets[r]);
+    }
+    groupStart.push_back(codes.size());
+    std::vector<size_t> order(codes.size());
+    for (size_t i = 0; i < codes.size(); ++i) order[offsets[rank[codes[i]]]++] = i;
+
+    buildSorted(order, groupStart, [&](size_t row) { return static_cast<KeyType>(dictionary.decode(codes[row])); });
+}
+
+template<typename KeyType>
+template<typename KeyAt>
+void BPlusTree<KeyType>::buildSorted(const std::vector<size_t>& order, const std::vector<size_t>& groupStart,
+                                     KeyAt keyAt) {
+    const size_t distinct = groupStart.size() - 1;
+
+    // Packed leaves: distribute the keys evenly so no leaf is left nearly empty.
+    const size_t leafCount = (distinct + fanout - 1) / fanout;
+    leaves.reserve(leafCount);
+    leafKeys.reserve(leafCount * (fanout + 1));
+    leafRows.reserve(leafCount * (fanout + 1));
+    std::vector<NodeRef> level;      // Nodes of the level being built, left to right
+    std::vector<KeyType> levelMin;   // Smallest key under each of those nodes
+    level.reserve(leafCount);
+    levelMin.reserve(leafCount);
+    size_t group = 0;
+    for (size_t l = 0; l < leafCount; ++l) {
+        const size_t take = distinct / leafCount + (l < distinct % leafCount ? 1 : 0);
+        const NodeRef leaf = allocateLeaf();
+        const size_t base = leafSlot(leaf);
+        for (size_t k = 0; k < take; ++k, ++group) {
+            leafKeys[base + k] = keyAt(order[groupStart[group]]);
+            std::vector<size_t>& rows = leafRows[base + k];
+            rows.assign(order.begin() + groupStart[group], order.begin() + groupStart[group + 1]);
+        }
+        leaves[nodeId(leaf)].count = static_cast<uint32_t>(take);
+        if (!level.empty()) leaves[nodeId(level.back())].next = leaf;
+        level.push_back(leaf);
+        levelMin.push_back(leafKeys[base]);
+    }
+
+    // Inner levels: group up to fanout children per node until one node remains.
+    while (level.size() > 1) {
+        const size_t nodeCount = (level.size() + fanout - 1) / fanout;
+        std::vector<NodeRef> parents;
+        std::vector<KeyType> parentMin;
+        parents.reserve(nodeCount);
+        parentMin.reserve(nodeCount);
+        size_t child = 0;
+        for (size_t n = 0; n < nodeCount; ++n) {
+            const size_t take = level.size() / nodeCount + (n < level.size() % nodeCount ? 1 : 0);
+            const NodeRef node = allocateInner();
+            const size_t keyBase = innerKeySlot(node);
+            const size_t childBase = innerChildSlot(node);
+            parentMin.push_back(levelMin[child]);
+            for (size_t c = 0; c < take; ++c, ++child) {
+                innerChildren[childBase + c] = level[child];
+                if (c > 0) innerKeys[keyBase + c - 1] = levelMin[child];
+            }
+            inners[node].count = static_cast<uint32_t>(take - 1);
+            parents.push_back(node);
+        }
+        level = std::move(parents);
+        levelMin = std::move(parentMin);
+    }
+    root = level.front();
+}
+
+template<typename KeyType>
+typename BPlusTree<KeyType>::NodeRef BPlusTree<KeyType>::findLeaf(const KeyType& key) const {
+    NodeRef node = root;
+    while (node != NO_NODE && !isLeafRef(node)) {
+        node = innerChildren[innerChildSlot(node) + childIndex(node, key)];
+    }
+    return node;
+}
+
+template<typename KeyType>
+typename BPlusTree<KeyType>::NodeRef BPlusTree<KeyType>::leftmostLeaf() const {
+    NodeRef node = root;
+    while (node != NO_NODE && !isLeafRef(node)) {
+        node = innerChildren[innerChildSlot(node)];
+    }
+    return node;
+}
+
+template<typename KeyType>
+typename BPlusTree<KeyType>::NodeRef BPlusTree<KeyType>::rightmostLeaf() const {
+    NodeRef node = root;
+    while (node != NO_NODE && !isLeafRef(node)) {
+        node = innerChildren[innerChildSlot(node) + inners[node].count];
+    }
+    return node;
+}
+
+template<typename KeyType>
+std::vector<size_t> BPlusTree<KeyType>::search(const KeyType& key) const {
+    const NodeRef leaf = findLeaf(key);
+    if (leaf == NO_NODE) return {};
+    const size_t base = leafSlot(leaf);
+    auto first = leafKeys.begin() + base;
+    auto last = first + leaves[nodeId(leaf)].count;
+    auto it = std::lower_bound(first, last, key);
+    if (it == last || !(*it == key)) return {};
+    return leafRows[base + (it - first)];
+}
+
+template<typename KeyType>
+void BPlusTree<KeyType>::searchInto(const KeyType& key, std::vector<size_t>& out) const {
+    const NodeRef leaf = findLeaf(key);
+    if (leaf == NO_NODE) return;
+    const size_t base = leafSlot(leaf);
+    auto first = leafKeys.begin() + base;
+    auto last = first + leaves[nodeId(leaf)].count;
+    auto it = std::lower_bound(first, last, key);
+    if (it == last || !(*it == key)) return;
+    const std::vector<size_t>& rows = leafRows[base + (it - first)];
+    out.insert(out.end(), rows.begin(), rows.end());
+}
+
+template<typename KeyType>
+typename BPlusTree<KeyType>::RangeIterator BPlusTree<KeyType>::rangeSearch(
+        const std::optional<KeyBound<KeyType>>& lo,
+        const std::optional<KeyBound<KeyType>>& hi) const {
+    if (!lo) {
+        return RangeIterator(this, leftmostLeaf(), 0, hi);
+    }
+    const NodeRef leaf = findLeaf(lo->key);
+    if (leaf == NO_NODE) {
+        return RangeIterator(this, NO_NODE, 0, hi);
+    }
+    auto first = leafKeys.begin() + leafSlot(leaf);
+    auto last = first + leaves[nodeId(leaf)].count;
+    auto it = lo->inclusive ? std::lower_bound(first, last, lo->key) : std::upper_bound(first, last, lo->key);
+    return RangeIterator(this, leaf, static_cast<uint32_t>(it - first), hi);
+}
+
+template<typename KeyType>
+std::optional<KeyType> BPlusTree<KeyType>::minKey() const {
+    const RangeIterator it = rangeSearch(std::nullopt, std::nullopt);
+    if (!it.valid()) return std::nullopt;
+    return it.key();
+}
+
+template<typename KeyType>
+std::optional<KeyType> BPlusTree<KeyType>::maxKey() const {
+    const NodeRef leaf = rightmostLeaf();
+    if (leaf == NO_NODE || leaves[nodeId(leaf)].count == 0) return std::nullopt;
+    return leafKeys[leafSlot(leaf) + leaves[nodeId(leaf)].count - 1];
+}
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef HASH_INDEX_H
+#define HASH_INDEX_H
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Hash index for equality lookups (CREATE INDEX ... USING hash).
+//
+// Open addressing with linear probing over a power-of-two slot array. A
+// slot holds the id of a distinct key plus 32 bits of its hash, so probes
+// compare keys only when the tags match. Distinct keys live densely in
+// keys; the row positions of each key form a chain through the flat
+// postingRows/postingNext arrays, so inserting a row never allocates on
+// its own (the arrays just grow).
+template<typename KeyType>
+class HashIndex {
+private:
+    static constexpr uint32_t EMPTY = std::numeric_limits<uint32_t>::max();
+    static constexpr uint32_t NO_POSTING = std::numeric_limits<uint32_t>::max();
+    static constexpr size_t MIN_SLOTS = 16;
+
+    struct Slot {
+        uint32_t keyId = EMPTY;
+        uint32_t hashTag = 0;
+    };
+
+    std::vector<Slot> slots;
+    size_t slotMask = 0;
+
+    std::vector<KeyType> keys;         // Distinct keys by id
+    std::vector<uint32_t> firstPosting; // Per key id
+    std::vector<uint32_t> lastPosting;  // Per key id
+    std::vector<uint32_t> rowCounts;    // Per key id
+    std::vector<size_t> postingRows;
+    std::vector<uint32_t> postingNext;
+
+    static uint64_t hashKey(const KeyType& key) {
+        uint64_t h;
+        if constexpr (std::is_integral_v<KeyType>) {
+            h = static_cast<uint64_t>(key);
+        } else {
+            h = std::hash<KeyType>{}(key);
+        }
+        // Finalizer from MurmurHash3; spreads clustered integers over the table.
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    // Slot holding key, or the empty slot where it would go.
+    size_t findSlot(const KeyType& key, uint64_t hash) const {
+        const uint32_t tag = static_cast<uint32_t>(hash >> 32);
+        size_t pos = static_cast<size_t>(hash) & slotMask;
+        while (true) {
+            const Slot& slot = slots[pos];
+            if (slot.keyId == EMPTY) return pos;
+            if (slot.hashTag == tag && keys[slot.keyId] == key) return pos;
+            pos = (pos + 1) & slotMask;
+        }
+    }
+
+    void rehash(size_t slotCount) {
+        std::vector<Slot> old(slotCount);
+        old.swap(slots);
+        slotMask = slotCount - 1;
+        for (const Slot& slot : old) {
+            if (slot.keyId == EMPTY) continue;
+            size_t pos = static_cast<size_t>(hashKey(keys[slot.keyId])) & slotMask;
+            while (slots[pos].keyId != EMPTY) pos = (pos + 1) & slotMask;
+            slots[pos] = slot;
+        }
+    }
+
+    // Keeps the load factor at or below 0.7 for distinctKeys keys.
+    void reserveKeys(size_t distinctKeys) {
+        size_t needed = slots.size();
+        while (needed * 7 < distinctKeys * 10) needed <<= 1;
+        if (needed > slots.size()) rehash(needed);
+    }
+
+public:
+    HashIndex() { rehash(MIN_SLOTS); }
+
+    /**
+     * Adds rowIndex to the rows of key.
+     *
+     * @param key Key of the row.
+     * @param rowIndex Position of the row in the table.
+     */
+    void insert(const KeyType& key, size_t rowIndex) {
+        if (postingRows.size() >= NO_POSTING) {
+            throw std::length_error("Hash index is full");
+        }
+        reserveKeys(keys.size() + 1);
+        const uint64_t hash = hashKey(key);
+        const size_t pos = findSlot(key, hash);
+        const uint32_t posting = static_cast<uint32_t>(postingRows.size());
+        postingRows.push_back(rowIndex);
+        postingNext.push_back(NO_POSTING);
+
+        if (slots[pos].keyId == EMPTY) {
+            slots[pos].keyId = static_cast<uint32_t>(keys.size());
+            slots[pos].hashTag = static_cast<uint32_t>(hash >> 32);
+            keys.push_back(key);
+            firstPosting.push_back(posting);
+            lastPosting.push_back(posting);
+            rowCounts.push_back(1);
+            return;
+        }
+        const uint32_t keyId = slots[pos].keyId;
+        postingNext[lastPosting[keyId]] = posting;
+        lastPosting[keyId] = posting;
+        ++rowCounts[keyId];
+    }
+
+    /**
+     * Replaces the contents with keys[i] -> row i for every i.
+     *
+     * @param source Key of every row, in row order.
+     */
+    template<typename Source>
+    void bulkLoad(const std::vector<Source>& source) {
+        slots.clear();
+        keys.clear();
+        firstPosting.clear();
+        lastPosting.clear();
+        rowCounts.clear();
+        postingRows.clear();
+        postingNext.clear();
+        rehash(MIN_SLOTS);
+        postingRows.reserve(source.size());
+        postingNext.reserve(source.size());
+        for (size_t i = 0; i < source.size(); ++i) {
+            insert(static_cast<KeyType>(source[i]), i);
+        }
+    }
+
+    /**
+     * Returns the rows of key in insertion order.
+     *
+     * @param key Key to look up.
+     * @return Row indices, empty if the key is absent.
+     */
+    std::vector<size_t> search(const KeyType& key) const {
+        const Slot& slot = slots[findSlot(key, hashKey(key))];
+        if (slot.keyId == EMPTY) return {};
+        std::vector<size_t> rows;
+        rows.reserve(rowCounts[slot.keyId]);
+        for (uint32_t p = firstPosting[slot.keyId]; p != NO_POSTING; p = postingNext[p]) {
+            rows.push_back(postingRows[p]);
+        }
+        return rows;
+    }
+
+    /**
+     * Appends the rows of key to out, in insertion order.
+     *
+     * @param key Key to look up.
+     * @param out Receives the row indices; nothing is appended if the key is absent.
+     */
+    void searchInto(const KeyType& key, std::vector<size_t>& out) const {
+        const Slot& slot = slots[findSlot(key, hashKey(key))];
+        if (slot.keyId == EMPTY) return;
+        for (uint32_t p = firstPosting[slot.keyId]; p != NO_POSTING; p = postingNext[p]) {
+            out.push_back(postingRows[p]);
+        }
+    }
+
+    bool isEmpty() const { return keys.empty(); }
+    size_t distinctKeys() const { return keys.size(); }
+};
+
+#endif
@@ -1,102 +1,493 @@
 #ifndef INDEX_MANAGER_H
 #define INDEX_MANAGER_H
 
-#include "btree.h"
+#include "bplustree.h"
+#include "hash_index.h"
+#include "bitmap_index.h"
 #include "value.h"
+#include "string_dictionary.h"
 #include <unordered_map>
 #include <string>
+#include <cctype>
+#include <cstdint>
+#include <vector>
+#include <optional>
+#include <type_traits>
+#include <stdexcept>
+#include <algorithm>
 
+// Data structure behind an index. BTREE answers equality and range
+// predicates; HASH answers equality only, with O(1) probes; BITMAP keeps a
+// compressed bitmap per distinct key, for BOOL and low-cardinality columns.
+enum class IndexKind { BTREE, HASH, BITMAP };
+
+// A named index over one column, as declared by CREATE INDEX.
+struct IndexDefinition {
+    std::string name;
+    std::string column;
+    IndexKind kind = IndexKind::BTREE;
+    size_t fanout = 0;  // B+tree fanout; 0 picks the default for the key type
+
+    static std::string kindToString(IndexKind kind) {
+        switch (kind) {
+            case IndexKind::BTREE: return "btree";
+            case IndexKind::HASH: return "hash";
+            case IndexKind::BITMAP: return "bitmap";
+        }
+        return "unknown";
+    }
+
+    // Accepts "btree" / "hash" / "bitmap" in any case.
+    static IndexKind stringToKind(const std::string& str) {
+        std::string lower = str;
+        std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+        if (lower == "btree") return IndexKind::BTREE;
+        if (lower == "hash") return IndexKind::HASH;
+        if (lower == "bitmap") return IndexKind::BITMAP;
+        throw std::invalid_argument("Unknown index method: " + str);
+    }
+};
+
+// Owns the indexes of one table, keyed by index name. Which column an
+// index covers is recorded in its IndexDefinition.
 class IndexManager {
 private:
-    std::unordered_map<std::string, BTree<int>> intIndexes;
-    std::unordered_map<std::string, BTree<std::string>> stringIndexes;
-    std::unordered_map<std::string, BTree<bool>> boolIndexes;
-    
+    std::vector<IndexDefinition> definitions;  // In creation order
+    std::unordered_map<std::string, BPlusTree<int>> intIndexes;
+    std::unordered_map<std::string, BPlusTree<std::string>> stringIndexes;
+    std::unordered_map<std::string, BPlusTree<bool>> boolIndexes;
+    std::unordered_map<std::string, HashIndex<int>> intHashIndexes;
+    std::unordered_map<std::string, HashIndex<uint32_t>> stringHashIndexes;    // Keyed by dictionary code
+    std::unordered_map<std::string, HashIndex<bool>> boolHashIndexes;
+    std::unordered_map<std::string, BitmapIndex<int>> intBitmapIndexes;
+    std::unordered_map<std::string, BitmapIndex<uint32_t>> stringBitmapIndexes; // Keyed by dictionary code
+    std::unordered_map<std::string, BitmapIndex<bool>> boolBitmapIndexes;
+    std::unordered_map<std::string, const StringDictionary*> dictionaries;  // Column dictionary of each STRING code index
+
+    // Checks that key has the index's type and returns it as the key type.
+    template<typename KeyType>
+    static KeyType typedKey(const Value& key, const std::string& indexName);
+
+    // Dictionary code of a STRING key, or std::nullopt if the column never held it.
+    std::optional<uint32_t> codeKey(const Value& key, const std::string& indexName) const;
+
+    // Converts a range bound to the key type of an index.
+    template<typename KeyType>
+    static std::optional<KeyBound<KeyType>> toKeyBound(const std::optional<Value>& bound, bool inclusive,
+                                                       Value::Type type, const std::string& indexName);
+
+    // Appends the rows of each key to rows, closing offsets after each; toKey
+    // converts a key to the index's key type (nullopt: the key cannot occur).
+    template<typename Index, typename ToKey>
+    static void searchEach(const Index& index, const std::vector<Value>& keys, ToKey toKey,
+                           std::vector<size_t>& offsets, std::vector<size_t>& rows);
+
+    template<typename KeyType>
+    static std::vector<size_t> collectRange(const BPlusTree<KeyType>& tree, const ValueRange& range,
+                                            Value::Type type, const std::string& indexName);
+
 public:
-    void createIndex(const std::string& indexName, Value::Type getType);
+    // Creates an empty index; getType is the type of the indexed column. STRING
+    // columns pass their dictionary, which must outlive the index.
+    void createIndex(const IndexDefinition& definition, Value::Type getType,
+                     const StringDictionary* dictionary = nullptr);
+    void dropIndex(const std::string& indexName);
+    const std::vector<IndexDefinition>& getDefinitions() const { return definitions; }
+    // An index on column, or nullptr. Hash indexes are preferred for equality;
+    // ordered restricts the search to indexes that support ranges.
+    const IndexDefinition* findIndexForColumn(const std::string& column, bool ordered = false) const;
     void insertIntoIndex(const std::string& indexName, const Value& key, size_t rowIndex);
-    std::vector<size_t> searchIndex(const std::string& indexName, const Value& key);
+    // Rebuilds an index from a whole column at once (row i has key keys[i], or
+    // dictionary.decode(codes[i]) for STRING columns).
+    void bulkLoadIndex(const std::string& indexName, const std::vector<int>& keys);
+    void bulkLoadIndex(const std::string& indexName, const StringDictionary& dictionary,
+                       const std::vector<uint32_t>& codes);
+    void bulkLoadIndex(const std::string& indexName, const std::vector<uint8_t>& keys);  // BOOL columns
+    std::vector<size_t> searchIndex(const std::string& indexName, const Value& key) const;
+    // Looks several keys up in one index, which is found once for the batch:
+    // the rows of keys[i] end up in rows[offsets[i] .. offsets[i + 1]).
+    void searchIndexBatch(const std::string& indexName, const std::vector<Value>& keys,
+                          std::vector<size_t>& offsets, std::vector<size_t>& rows) const;
+    // Rows of key in a bitmap index, without copying; nullptr if the key is absent.
+    const RoaringBitmap* searchBitmap(const std::string& indexName, const Value& key) const;
+    // Rows whose key lies in range, in ascending key order.
+    std::vector<size_t> rangeSearchIndex(const std::string& indexName, const ValueRange& range) const;
+    // Calls visit(tree) with the BPlusTree<int>, <std::string> or <bool> of a
+    // B+tree index, for callers that walk its keys in order.
+    template<typename Visitor>
+    void visitTree(const std::string& indexName, Visitor&& visit) const;
     bool hasIndex(const std::string& indexName) const;
 };
 
-void IndexManager::createIndex(const std::string& indexName, Value::Type getType) {
+void IndexManager::createIndex(const IndexDefinition& definition, Value::Type getType,
+                               const StringDictionary* dictionary) {
+    const std::string& indexName = definition.name;
     // Prevent overwriting an existing index of any getType
     if (hasIndex(indexName)) {
-        throw std::runtime_error("Index already exists: " + indexName);
+        throw std::invalid_argument("Index already exists: " + indexName);
+    }
+    if (definition.kind == IndexKind::BITMAP) {
+        switch (getType) {
+            case Value::Type::INT:
+                intBitmapIndexes.emplace(indexName, BitmapIndex<int>());
+                break;
+            case Value::Type::STRING:
+                if (!dictionary) {
+                    throw std::invalid_argument("STRING index needs the column dictionary: " + indexName);
+                }
+                stringBitmapIndexes.emplace(indexName, BitmapIndex<uint32_t>());
+                dictionaries[indexName] = dictionary;
+                break;
+            case Value::Type::BOOL:
+                boolBitmapIndexes.emplace(indexName, BitmapIndex<bool>());
+                break;
+            default:
+                throw std::runtime_error("Unsupported index getType for: " + indexName);
+        }
+        definitions.push_back(definition);
+        return;
+    }
+
+    if (definition.kind == IndexKind::HASH) {
+        switch (getType) {
+            case Value::Type::INT:
+                intHashIndexes.emplace(indexName, HashIndex<int>());
+                break;
+            case Value::Type::STRING:
+                if (!dictionary) {
+                    throw std::invalid_argument("STRING index needs the column dictionary: " + indexName);
+                }
+                stringHashIndexes.emplace(indexName, HashIndex<uint32_t>());
+                dictionaries[indexName] = dictionary;
+                break;
+            case Value::Type::BOOL:
+                boolHashIndexes.emplace(indexName, HashIndex<bool>());
+                break;
+            default:
+                throw std::runtime_error("Unsupported index getType for: " + indexName);
+        }
+        definitions.push_back(definition);
+        return;
     }
 
+    const size_t fanout = definition.fanout;
     switch (getType) {
         case Value::Type::INT:
-            intIndexes.emplace(indexName, BTree<int>(/*degree=*/3));
+            intIndexes.emplace(indexName, BPlusTree<int>(fanout ? fanout : BPlusTree<int>::DEFAULT_FANOUT));
             break;
         case Value::Type::STRING:
-            stringIndexes.emplace(indexName, BTree<std::string>(/*degree=*/3));
+            stringIndexes.emplace(indexName, BPlusTree<std::string>(fanout ? fanout : BPlusTree<std::string>::DEFAULT_FANOUT));
             break;
         case Value::Type::BOOL:
-            boolIndexes.emplace(indexName, BTree<bool>(/*degree=*/3));
+            boolIndexes.emplace(indexName, BPlusTree<bool>(fanout ? fanout : BPlusTree<bool>::DEFAULT_FANOUT));
             break;
         default:
             throw std::runtime_error("Unsupported index getType for: " + indexName);
     }
+    definitions.push_back(definition);
 }
 
-void IndexManager::insertIntoIndex(const std::string& indexName, const Value& key, size_t rowIndex) {
-    // Try INT
-    if (auto it = intIndexes.find(indexName); it != intIndexes.end()) {
+void IndexManager::dropIndex(const std::string& indexName) {
+    auto it = std::find_if(definitions.begin(), definitions.end(),
+                           [&](const IndexDefinition& def) { return def.name == indexName; });
+    if (it == definitions.end()) {
+        throw std::invalid_argument("Index not found: " + indexName);
+    }
+    definitions.erase(it);
+    intIndexes.erase(indexName);
+    stringIndexes.erase(indexName);
+    boolIndexes.erase(indexName);
+    intHashIndexes.erase(indexName);
+    stringHashIndexes.erase(indexName);
+    boolHashIndexes.erase(indexName);
+    intBitmapIndexes.erase(indexName);
+    stringBitmapIndexes.erase(indexName);
+    dictionaries.erase(indexName);
+    boolBitmapIndexes.erase(indexName);
+}
+
+const IndexDefinition* IndexManager::findIndexForColumn(const std::string& column, bool ordered) const {
+    if (!ordered) {
+        for (IndexKind preferred : {IndexKind::HASH, IndexKind::BITMAP}) {
+            for (const IndexDefinition& def : definitions) {
+                if (def.column == column && def.kind == preferred) {
+                    return &def;
+                }
+            }
+        }
+    }
+    for (const IndexDefinition& def : definitions) {
+        if (def.column == column && (!ordered || def.kind == IndexKind::BTREE)) {
+            return &def;
+        }
+    }
+    return nullptr;
+}
+
+template<typename KeyType>
+KeyType IndexManager::typedKey(const Value& key, const std::string& indexName) {
+    if constexpr (std::is_same_v<KeyType, int>) {
         if (key.getType() != Value::Type::INT) {
             throw std::runtime_error("Type mismatch: expected INT for index " + indexName);
         }
-        it->second.insert(key.getInt(), rowIndex);
+        return key.getInt();
+    } else if constexpr (std::is_same_v<KeyType, bool>) {
+        if (key.getType() != Value::Type::BOOL) {
+            throw std::runtime_error("Type mismatch: expected BOOL for index " + indexName);
+        }
+        return key.getBool();
+    } else {
+        if (key.getType() != Value::Type::STRING) {
+            throw std::runtime_error("Type mismatch: expected STRING for index " + indexName);
+        }
+        return key.getString();
+    }
+}
+
+std::optional<uint32_t> IndexManager::codeKey(const Value& key, const std::string& indexName) const {
+    if (key.getType() != Value::Type::STRING) {
+        throw std::runtime_error("Type mismatch: expected STRING for index " + indexName);
+    }
+    return dictionaries.at(indexName)->find(key.getStringView());
+}
+
+void IndexManager::insertIntoIndex(const std::string& indexName, const Value& key, size_t rowIndex) {
+    // Try INT
+    if (auto it = intIndexes.find(indexName); it != intIndexes.end()) {
+        it->second.insert(typedKey<int>(key, indexName), rowIndex);
+        return;
+    }
+    if (auto it = intHashIndexes.find(indexName); it != intHashIndexes.end()) {
+        it->second.insert(typedKey<int>(key, indexName), rowIndex);
+        return;
+    }
+    if (auto it = intBitmapIndexes.find(indexName); it != intBitmapIndexes.end()) {
+        it->second.insert(typedKey<int>(key, indexName), rowIndex);
         return;
     }
 
     // Try STRING
     if (auto it = stringIndexes.find(indexName); it != stringIndexes.end()) {
-        if (key.getType() != Value::Type::STRING) {
-            throw std::runtime_error("Type mismatch: expected STRING for index " + indexName);
-        }
-        it->second.insert(key.getString(), rowIndex);
+        it->second.insert(typedKey<std::string>(key, indexName), rowIndex);
+        return;
+    }
+    // Code indexes: the column encoded the value before the index sees it.
+    if (auto it = stringHashIndexes.find(indexName); it != stringHashIndexes.end()) {
+        it->second.insert(codeKey(key, indexName).value(), rowIndex);
+        return;
+    }
+    if (auto it = stringBitmapIndexes.find(indexName); it != stringBitmapIndexes.end()) {
+        it->second.insert(codeKey(key, indexName).value(), rowIndex);
         return;
     }
 
     // Try BOOL
     if (auto it = boolIndexes.find(indexName); it != boolIndexes.end()) {
-        if (key.getType() != Value::Type::BOOL) {
-            throw std::runtime_error("Type mismatch: expected BOOL for index " + indexName);
-        }
-        it->second.insert(key.getBool(), rowIndex);
+        it->second.insert(typedKey<bool>(key, indexName), rowIndex);
+        return;
+    }
+    if (auto it = boolHashIndexes.find(indexName); it != boolHashIndexes.end()) {
+        it->second.insert(typedKey<bool>(key, indexName), rowIndex);
+        return;
+    }
+    if (auto it = boolBitmapIndexes.find(indexName); it != boolBitmapIndexes.end()) {
+        it->second.insert(typedKey<bool>(key, indexName), rowIndex);
         return;
     }
 
     throw std::runtime_error("Index not found: " + indexName);
 }
 
-std::vector<size_t> IndexManager::searchIndex(const std::string& indexName, const Value& key) {
+void IndexManager::bulkLoadIndex(const std::string& indexName, const std::vector<int>& keys) {
     if (auto it = intIndexes.find(indexName); it != intIndexes.end()) {
-        if (key.getType() != Value::Type::INT) {
-            throw std::runtime_error("Type mismatch: expected INT for index " + indexName);
-        }
-        return it->second.search(key.getInt());
+        it->second.bulkLoad(keys);
+    } else if (auto hashIt = intHashIndexes.find(indexName); hashIt != intHashIndexes.end()) {
+        hashIt->second.bulkLoad(keys);
+    } else if (auto bitmapIt = intBitmapIndexes.find(indexName); bitmapIt != intBitmapIndexes.end()) {
+        bitmapIt->second.bulkLoad(keys);
+    } else {
+        throw std::runtime_error("INT index not found: " + indexName);
     }
+}
+
+void IndexManager::bulkLoadIndex(const std::string& indexName, const StringDictionary& dictionary,
+                                 const std::vector<uint32_t>& codes) {
     if (auto it = stringIndexes.find(indexName); it != stringIndexes.end()) {
-        if (key.getType() != Value::Type::STRING) {
-            throw std::runtime_error("Type mismatch: expected STRING for index " + indexName);
-        }
-        return it->second.search(key.getString());
+        it->second.bulkLoadEncoded(dictionary, codes);
+    } else if (auto hashIt = stringHashIndexes.find(indexName); hashIt != stringHashIndexes.end()) {
+        hashIt->second.bulkLoad(codes);
+    } else if (auto bitmapIt = stringBitmapIndexes.find(indexName); bitmapIt != stringBitmapIndexes.end()) {
+        bitmapIt->second.bulkLoad(codes);
+    } else {
+        throw std::runtime_error("STRING index not found: " + indexName);
     }
+}
+
+void IndexManager::bulkLoadIndex(const std::string& indexName, const std::vector<uint8_t>& keys) {
     if (auto it = boolIndexes.find(indexName); it != boolIndexes.end()) {
-        if (key.getType() != Value::Type::BOOL) {
-            throw std::runtime_error("Type mismatch: expected BOOL for index " + indexName);
-        }
-        return it->second.search(key.getBool());
+        it->second.bulkLoad(keys);
+    } else if (auto hashIt = boolHashIndexes.find(indexName); hashIt != boolHashIndexes.end()) {
+        hashIt->second.bulkLoad(keys);
+    } else if (auto bitmapIt = boolBitmapIndexes.find(indexName); bitmapIt != boolBitmapIndexes.end()) {
+        bitmapIt->second.bulkLoad(keys);
+    } else {
+        throw std::runtime_error("BOOL index not found: " + indexName);
+    }
+}
+
+std::vector<size_t> IndexManager::searchIndex(const std::string& indexName, const Value& key) const {
+    if (auto it = intHashIndexes.find(indexName); it != intHashIndexes.end()) {
+        return it->second.search(typedKey<int>(key, indexName));
+    }
+    if (auto it = intBitmapIndexes.find(indexName); it != intBitmapIndexes.end()) {
+        return it->second.search(typedKey<int>(key, indexName));
+    }
+    if (auto it = stringHashIndexes.find(indexName); it != stringHashIndexes.end()) {
+        std::optional<uint32_t> code = codeKey(key, indexName);
+        return code ? it->second.search(*code) : std::vector<size_t>();
+    }
+    if (auto it = stringBitmapIndexes.find(indexName); it != stringBitmapIndexes.end()) {
+        std::optional<uint32_t> code = codeKey(key, indexName);
+        return code ? it->second.search(*code) : std::vector<size_t>();
+    }
+    if (auto it = boolHashIndexes.find(indexName); it != boolHashIndexes.end()) {
+        return it->second.search(typedKey<bool>(key, indexName));
+    }
+    if (auto it = boolBitmapIndexes.find(indexName); it != boolBitmapIndexes.end()) {
+        return it->second.search(typedKey<bool>(key, indexName));
+    }
+    if (auto it = intIndexes.find(indexName); it != intIndexes.end()) {
+        return it->second.search(typedKey<int>(key, indexName));
+    }
+    if (auto it = stringIndexes.find(indexName); it != stringIndexes.end()) {
+        return it->second.search(typedKey<std::string>(key, indexName));
+    }
+    if (auto it = boolIndexes.find(indexName); it != boolIndexes.end()) {
+        return it->second.search(typedKey<bool>(key, indexName));
     }
     throw std::runtime_error("Index not found: " + indexName);
 }
 
+template<typename Index, typename ToKey>
+void IndexManager::searchEach(const Index& index, const std::vector<Value>& keys, ToKey toKey,
+                              std::vector<size_t>& offsets, std::vector<size_t>& rows) {
+    offsets.assign(1, 0);
+    offsets.reserve(keys.size() + 1);
+    rows.clear();
+    for (const Value& key : keys) {
+        if (const auto typed = toKey(key)) index.searchInto(*typed, rows);
+        offsets.push_back(rows.size());
+    }
+}
+
+void IndexManager::searchIndexBatch(const std::string& indexName, const std::vector<Value>& keys,
+                                    std::vector<size_t>& offsets, std::vector<size_t>& rows) const {
+    auto intKey = [&](const Value& key) { return std::optional<int>(typedKey<int>(key, indexName)); };
+    auto boolKey = [&](const Value& key) { return std::optional<bool>(typedKey<bool>(key, indexName)); };
+    auto stringKey = [&](const Value& key) { return std::optional<std::string>(typedKey<std::string>(key, indexName)); };
+    auto code = [&](const Value& key) { return codeKey(key, indexName); };
+    if (auto it = intHashIndexes.find(indexName); it != intHashIndexes.end()) {
+        searchEach(it->second, keys, intKey, offsets, rows);
+    } else if (auto it = intBitmapIndexes.find(indexName); it != intBitmapIndexes.end()) {
+        searchEach(it->second, keys, intKey, offsets, rows);
+    } else if (auto it = stringHashIndexes.find(indexName); it != stringHashIndexes.end()) {
+        searchEach(it->second, keys, code, offsets, rows);
+    } else if (auto it = stringBitmapIndexes.find(indexName); it != stringBitmapIndexes.end()) {
+        searchEach(it->second, keys, code, offsets, rows);
+    } else if (auto it = boolHashIndexes.find(indexName); it != boolHashIndexes.end()) {
+        searchEach(it->second, keys, boolKey, offsets, rows);
+    } else if (auto it = boolBitmapIndexes.find(indexName); it != boolBitmapIndexes.end()) {
+        searchEach(it->second, keys, boolKey, offsets, rows);
+    } else if (auto it = intIndexes.find(indexName); it != intIndexes.end()) {
+        searchEach(it->second, keys, intKey, offsets, rows);
+    } else if (auto it = stringIndexes.find(indexName); it != stringIndexes.end()) {
+        searchEach(it->second, keys, stringKey, offsets, rows);
+    } else if (auto it = boolIndexes.find(indexName); it != boolIndexes.end()) {
+        searchEach(it->second, keys, boolKey, offsets, rows);
+    } else {
+        throw std::runtime_error("Index not found: " + indexName);
+    }
+}
+
+template<typename KeyType>
+std::optional<KeyBound<KeyType>> IndexManager::toKeyBound(const std::optional<Value>& bound, bool inclusive,
+                                                          Value::Type type, const std::string& indexName) {
+    if (!bound) return std::nullopt;
+    if (bound->getType() != type) {
+        throw std::runtime_error("Type mismatch: expected " + Value::typeToString(type) + " for index " + indexName);
+    }
+    if constexpr (std::is_same_v<KeyType, int>) {
+        return KeyBound<int>{bound->getInt(), inclusive};
+    } else if constexpr (std::is_same_v<KeyType, bool>) {
+        return KeyBound<bool>{bound->getBool(), inclusive};
+    } else {
+        return KeyBound<std::string>{bound->getString(), inclusive};
+    }
+}
+
+template<typename KeyType>
+std::vector<size_t> IndexManager::collectRange(const BPlusTree<KeyType>& tree, const ValueRange& range,
+                                               Value::Type type, const std::string& indexName) {
+    std::vector<size_t> rows;
+    auto it = tree.rangeSearch(toKeyBound<KeyType>(range.lower, range.lowerInclusive, type, indexName),
+                               toKeyBound<KeyType>(range.upper, range.upperInclusive, type, indexName));
+    for (; it.valid(); it.next()) {
+        const std::vector<size_t>& keyRows = it.rows();
+        rows.insert(rows.end(), keyRows.begin(), keyRows.end());
+    }
+    return rows;
+}
+
+std::vector<size_t> IndexManager::rangeSearchIndex(const std::string& indexName, const ValueRange& range) const {
+    if (auto it = intIndexes.find(indexName); it != intIndexes.end()) {
+        return collectRange(it->second, range, Value::Type::INT, indexName);
+    }
+    if (auto it = stringIndexes.find(indexName); it != stringIndexes.end()) {
+        return collectRange(it->second, range, Value::Type::STRING, indexName);
+    }
+    if (auto it = boolIndexes.find(indexName); it != boolIndexes.end()) {
+        return collectRange(it->second, range, Value::Type::BOOL, indexName);
+    }
+    throw std::runtime_error("Index not found: " + indexName);
+}
+
+template<typename Visitor>
+void IndexManager::visitTree(const std::string& indexName, Visitor&& visit) const {
+    if (auto it = intIndexes.find(indexName); it != intIndexes.end()) {
+        visit(it->second);
+    } else if (auto stringIt = stringIndexes.find(indexName); stringIt != stringIndexes.end()) {
+        visit(stringIt->second);
+    } else if (auto boolIt = boolIndexes.find(indexName); boolIt != boolIndexes.end()) {
+        visit(boolIt->second);
+    } else {
+        throw std::runtime_error("B+tree index not found: " + indexName);
+    }
+}
+
+const RoaringBitmap* IndexManager::searchBitmap(const std::string& indexName, const Value& key) const {
+    if (auto it = intBitmapIndexes.find(indexName); it != intBitmapIndexes.end()) {
+        return it->second.find(typedKey<int>(key, indexName));
+    }
+    if (auto it = stringBitmapIndexes.find(indexName); it != stringBitmapIndexes.end()) {
+        std::optional<uint32_t> code = codeKey(key, indexName);
+        return code ? it->second.find(*code) : nullptr;
+    }
+    if (auto it = boolBitmapIndexes.find(indexName); it != boolBitmapIndexes.end()) {
+        return it->second.find(typedKey<bool>(key, indexName));
+    }
+    throw std::runtime_error("Bitmap index not found: " + indexName);
+}
+
 bool IndexManager::hasIndex(const std::string& indexName) const {
     return intIndexes.count(indexName) ||
            stringIndexes.count(indexName) ||
-           boolIndexes.count(indexName);
+           boolIndexes.count(indexName) ||
+           intHashIndexes.count(indexName) ||
+           stringHashIndexes.count(indexName) ||
+           boolHashIndexes.count(indexName) ||
+           intBitmapIndexes.count(indexName) ||
+           stringBitmapIndexes.count(indexName) ||
+           boolBitmapIndexes.count(indexName);
 }
 
 #endif
\ No newline at end of file
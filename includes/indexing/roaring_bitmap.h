@@ -0,0 +1,285 @@
+#ifndef ROARING_BITMAP_H
+#define ROARING_BITMAP_H
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Compressed set of 32-bit row positions, in the style of Roaring bitmaps.
+//
+// Positions are split into a 16-bit high part, which selects a container,
+// and a 16-bit low part stored in it. A container holds either a sorted
+// array of low parts (up to ARRAY_LIMIT entries, 2 bytes per row) or a
+// 65536-bit bitset (8 KiB), whichever is smaller for its cardinality.
+// AND/OR work container by container and never expand the set into a
+// vector of row ids.
+class RoaringBitmap {
+private:
+    static constexpr size_t ARRAY_LIMIT = 4096;
+    static constexpr size_t BITSET_WORDS = 65536 / 64;
+
+    struct Container {
+        uint16_t high = 0;
+        uint32_t cardinality = 0;
+        std::vector<uint16_t> array;  // Sorted low parts; used while bits is empty
+        std::vector<uint64_t> bits;   // BITSET_WORDS words once the array would exceed ARRAY_LIMIT
+
+        bool isBitset() const { return !bits.empty(); }
+
+        bool contains(uint16_t low) const {
+            if (isBitset()) return (bits[low >> 6] >> (low & 63)) & 1;
+            return std::binary_search(array.begin(), array.end(), low);
+        }
+
+        void add(uint16_t low) {
+            if (isBitset()) {
+                uint64_t& word = bits[low >> 6];
+                const uint64_t mask = uint64_t(1) << (low & 63);
+                if (!(word & mask)) {
+                    word |= mask;
+                    ++cardinality;
+                }
+                return;
+            }
+            // Rows are mostly added in increasing order, so try the end first.
+            if (array.empty() || array.back() < low) {
+                array.push_back(low);
+            } else {
+                auto it = std::lower_bound(array.begin(), array.end(), low);
+                if (*it == low) return;
+                array.insert(it, low);
+            }
+            ++cardinality;
+            if (array.size() > ARRAY_LIMIT) toBitset();
+        }
+
+        void toBitset() {
+            bits.assign(BITSET_WORDS, 0);
+            for (uint16_t low : array) bits[low >> 6] |= uint64_t(1) << (low & 63);
+            array.clear();
+            array.shrink_to_fit();
+        }
+
+        // Switches a bitset back to an array when that is smaller.
+        void normalize() {
+            if (!isBitset() || cardinality > ARRAY_LIMIT) return;
+            array.reserve(cardinality);
+            forEach([this](uint16_t low) { array.push_back(low); });
+            bits.clear();
+            bits.shrink_to_fit();
+        }
+
+        template<typename Fn>
+        void forEach(Fn&& fn) const {
+            if (!isBitset()) {
+                for (uint16_t low : array) fn(low);
+                return;
+            }
+            for (size_t w = 0; w < BITSET_WORDS; ++w) {
+                for (uint64_t word = bits[w]; word; word &= word - 1) {
+                    fn(static_cast<uint16_t>(w * 64 + __builtin_ctzll(word)));
+                }
+            }
+        }
+
+        static Container intersect(const Container& a, const Container& b) {
+            Container out;
+            out.high = a.high;
+            if (a.isBitset() && b.isBitset()) {
+                out.bits.resize(BITSET_WORDS);
+                uint32_t count = 0;
+                for (size_t w = 0; w < BITSET_WORDS; ++w) {
+                    out.bits[w] = a.bits[w] & b.bits[w];
+                    count += __builtin_popcountll(out.bits[w]);
+                }
+                out.cardinality = count;
+                out.normalize();
+            } else if (a.isBitset() || b.isBitset()) {
+                const Container& arr = a.isBitset() ? b : a;
+                const Container& set = a.isBitset() ? a : b;
+                for (uint16_t low : arr.array) {
+                    if (set.contains(low)) out.array.push_back(low);
+                }
+                out.cardinality = static_cast<uint32_t>(out.array.size());
+            } else {
+                std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                                      std::back_inserter(out.array));
+                out.cardinality = static_cast<uint32_t>(out.array.size());
+            }
+            return out;
+        }
+
+        static Container unite(const Container& a, const Container& b) {
+            Container out;
+            out.high = a.high;
+            if (!a.isBitset() && !b.isBitset() && a.array.size() + b.array.size() <= ARRAY_LIMIT) {
+                out.array.reserve(a.array.size() + b.array.size());
+                std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                               std::back_inserter(out.array));
+                out.cardinality = static_cast<uint32_t>(out.array.size());
+                return out;
+            }
+            out.bits.assign(BITSET_WORDS, 0);
+            for (const Container* c : {&a, &b}) {
+                if (c->isBitset()) {
+                    for (size_t w = 0; w < BITSET_WORDS; ++w) out.bits[w] |= c->bits[w];
+                } else {
+                    for (uint16_t low : c->array) out.bits[low >> 6] |= uint64_t(1) << (low & 63);
+                }
+            }
+            uint32_t count = 0;
+            for (uint64_t word : out.bits) count += __builtin_popcountll(word);
+            out.cardinality = count;
+            out.normalize();
+            return out;
+        }
+    };
+
+    std::vector<Container> containers;  // Sorted by high
+
+    static uint32_t checkedRow(size_t row) {
+        if (row > std::numeric_limits<uint32_t>::max()) {
+            throw std::length_error("Row position does not fit in a bitmap index");
+        }
+        return static_cast<uint32_t>(row);
+    }
+
+    const Container* findContainer(uint16_t high) const {
+        auto it = std::lower_bound(containers.begin(), containers.end(), high,
+                                   [](const Container& c, uint16_t h) { return c.high < h; });
+        return (it != containers.end() && it->high == high) ? &*it : nullptr;
+    }
+
+public:
+    /**
+     * Adds a row position to the set.
+     *
+     * @param row Row position; must fit in 32 bits.
+     * @throws std::length_error if row does not fit in 32 bits.
+     */
+    void add(size_t row) {
+        const uint32_t value = checkedRow(row);
+        const uint16_t high = static_cast<uint16_t>(value >> 16);
+        if (containers.empty() || containers.back().high < high) {
+            containers.emplace_back();
+            containers.back().high = high;
+            containers.back().add(static_cast<uint16_t>(value));
+            return;
+        }
+        auto it = std::lower_bound(containers.begin(), containers.end(), high,
+                                   [](const Container& c, uint16_t h) { return c.high < h; });
+        if (it == containers.end() || it->high != high) {
+            it = containers.emplace(it);
+            it->high = high;
+        }
+        it->add(static_cast<uint16_t>(value));
+    }
+
+    bool contains(size_t row) const {
+        if (row > std::numeric_limits<uint32_t>::max()) return false;
+        const Container* c = findContainer(static_cast<uint16_t>(row >> 16));
+        return c && c->contains(static_cast<uint16_t>(row));
+    }
+
+    size_t cardinality() const {
+        size_t total = 0;
+        for (const Container& c : containers) total += c.cardinality;
+        return total;
+    }
+
+    bool isEmpty() const { return containers.empty(); }
+
+    /**
+     * Calls fn(row) for every row position in increasing order.
+     *
+     * @param fn Callable taking a size_t.
+     */
+    template<typename Fn>
+    void forEach(Fn&& fn) const {
+        for (const Container& c : containers) {
+            const size_t base = size_t(c.high) << 16;
+            c.forEach([&](uint16_t low) { fn(base | low); });
+        }
+    }
+
+    /**
+     * Returns the row positions in increasing order.
+     *
+     * @return Row positions.
+     */
+    std::vector<size_t> toRows() const {
+        std::vector<size_t> rows;
+        rows.reserve(cardinality());
+        forEach([&](size_t row) { rows.push_back(row); });
+        return rows;
+    }
+
+    /**
+     * Rows present in both sets.
+     *
+     * @example
+     * RoaringBitmap activeAdmins = active & admins;
+     */
+    friend RoaringBitmap operator&(const RoaringBitmap& a, const RoaringBitmap& b) {
+        RoaringBitmap out;
+        size_t i = 0, j = 0;
+        while (i < a.containers.size() && j < b.containers.size()) {
+            const Container& ca = a.containers[i];
+            const Container& cb = b.containers[j];
+            if (ca.high < cb.high) {
+                ++i;
+            } else if (cb.high < ca.high) {
+                ++j;
+            } else {
+                Container c = Container::intersect(ca, cb);
+                if (c.cardinality) out.containers.push_back(std::move(c));
+                ++i;
+                ++j;
+            }
+        }
+        return out;
+    }
+
+    /**
+     * Rows present in either set.
+     *
+     * @example
+     * RoaringBitmap flagged = suspended | deleted;
+     */
+    friend RoaringBitmap operator|(const RoaringBitmap& a, const RoaringBitmap& b) {
+        RoaringBitmap out;
+        out.containers.reserve(a.containers.size() + b.containers.size());
+        size_t i = 0, j = 0;
+        while (i < a.containers.size() || j < b.containers.size()) {
+            if (j == b.containers.size() || (i < a.containers.size() && a.containers[i].high < b.containers[j].high)) {
+                out.containers.push_back(a.containers[i++]);
+            } else if (i == a.containers.size() || b.containers[j].high < a.containers[i].high) {
+                out.containers.push_back(b.containers[j++]);
+            } else {
+                out.containers.push_back(Container::unite(a.containers[i++], b.containers[j++]));
+            }
+        }
+        return out;
+    }
+
+    RoaringBitmap& operator&=(const RoaringBitmap& other) { return *this = *this & other; }
+    RoaringBitmap& operator|=(const RoaringBitmap& other) { return *this = *this | other; }
+
+    bool operator==(const RoaringBitmap& other) const {
+        if (containers.size() != other.containers.size()) return false;
+        for (size_t i = 0; i < containers.size(); ++i) {
+            const Container& a = containers[i];
+            const Container& b = other.containers[i];
+            if (a.high != b.high || a.cardinality != b.cardinality) return false;
+            if (a.isBitset() != b.isBitset()) return false;
+            if (a.isBitset() ? a.bits != b.bits : a.array != b.array) return false;
+        }
+        return true;
+    }
+};
+
+#endif
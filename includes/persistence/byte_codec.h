@@ -0,0 +1,149 @@
+#ifndef BYTE_CODEC_H
+#define BYTE_CODEC_H
+
+#include "../value.h"
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+/*
+===========================================================================
+ByteCodec:
+Little-endian encoding helpers shared by the on-disk formats.
+
+Values are encoded as a uint8 Value::Type tag followed by their data:
+int32 for INT, uint8 for BOOL, uint32 length plus bytes for STRING and
+nothing for NULL.
+===========================================================================
+*/
+class ByteCodec {
+public:
+  static void putU8(std::string& out, uint8_t v) { out.push_back(static_cast<char>(v)); }
+
+  static void putU16(std::string& out, uint16_t v) {
+    for (int i = 0; i < 2; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+  }
+
+  static void putU32(std::string& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+  }
+
+  static void putU64(std::string& out, uint64_t v) {
+    for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+  }
+
+  static void putString(std::string& out, std::string_view str) {
+    putU32(out, static_cast<uint32_t>(str.size()));
+    out += str;
+  }
+
+  static void putValue(std::string& out, const Value& val) {
+    putU8(out, static_cast<uint8_t>(val.getType()));
+    switch (val.getType()) {
+      case Value::INT:
+        putU32(out, static_cast<uint32_t>(val.getInt()));
+        break;
+      case Value::BOOL:
+        putU8(out, val.getBool() ? 1 : 0);
+        break;
+      case Value::STRING:
+        putString(out, val.getStringView());
+        break;
+      default:
+        break;
+    }
+  }
+
+  static uint16_t getU16(const unsigned char* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+  }
+
+  static uint32_t getU32(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+  }
+
+  static uint64_t getU64(const unsigned char* p) {
+    return static_cast<uint64_t>(getU32(p)) | (static_cast<uint64_t>(getU32(p + 4)) << 32);
+  }
+
+  static void setU32(unsigned char* p, uint32_t v) {
+    for (int i = 0; i < 4; ++i) p[i] = static_cast<unsigned char>((v >> (8 * i)) & 0xFF);
+  }
+};
+
+/*
+===========================================================================
+ByteReader:
+Bounds-checked cursor over an in-memory byte range.
+Throws std::runtime_error when a read would run past the end.
+===========================================================================
+*/
+class ByteReader {
+private:
+  const unsigned char* data;
+  size_t size;
+  size_t pos = 0;
+
+  void need(size_t n) const {
+    if (n > size - pos) {
+      throw std::runtime_error("Unexpected end of data");
+    }
+  }
+
+public:
+  ByteReader(const unsigned char* d, size_t s) : data(d), size(s) {}
+
+  uint8_t readU8() {
+    need(1);
+    return data[pos++];
+  }
+
+  uint32_t readU32() {
+    need(4);
+    uint32_t v = ByteCodec::getU32(data + pos);
+    pos += 4;
+    return v;
+  }
+
+  uint64_t readU64() {
+    need(8);
+    uint64_t v = ByteCodec::getU64(data + pos);
+    pos += 8;
+    return v;
+  }
+
+  std::string readString() {
+    uint32_t length = readU32();
+    need(length);
+    std::string str(reinterpret_cast<const char*>(data + pos), length);
+    pos += length;
+    return str;
+  }
+
+  Value readValue() {
+    switch (static_cast<Value::Type>(readU8())) {
+      case Value::INT:
+        return Value(static_cast<int>(readU32()));
+      case Value::BOOL:
+        return Value(readU8() != 0);
+      case Value::STRING: {
+        uint32_t length = readU32();
+        need(length);
+        Value val(std::string_view(reinterpret_cast<const char*>(data + pos), length));
+        pos += length;
+        return val;
+      }
+      case Value::NULL_TYPE:
+        return Value();
+      default:
+        throw std::runtime_error("Unknown value type");
+    }
+  }
+
+  size_t remaining() const { return size - pos; }
+};
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+/*
+===========================================================================
+CRC-32 (IEEE 802.3, reflected polynomial 0xEDB88320).
+Used to detect torn or corrupted pages in on-disk files.
+===========================================================================
+*/
+class Crc32 {
+private:
+  static const std::array<uint32_t, 256>& table() {
+    static const std::array<uint32_t, 256> lookup = [] {
+      std::array<uint32_t, 256> t{};
+      for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) {
+          c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        t[i] = c;
+      }
+      return t;
+    }();
+    return lookup;
+  }
+
+public:
+  /**
+   * Computes the CRC-32 of a byte range.
+   *
+   * @param data Pointer to the first byte.
+   * @param length Number of bytes.
+   * @param seed Result of a previous call, to checksum data in several pieces.
+   * @return The checksum.
+   *
+   * @example
+   * uint32_t crc = Crc32::compute(page.data(), page.size());
+   */
+  static uint32_t compute(const void* data, size_t length, uint32_t seed = 0) {
+    const std::array<uint32_t, 256>& t = table();
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint32_t c = seed ^ 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; ++i) {
+      c = t[(c ^ bytes[i]) & 0xFF] ^ (c >> 8);
+    }
+    return c ^ 0xFFFFFFFFu;
+  }
+};
+
+#endif
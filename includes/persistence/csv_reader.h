@@ -0,0 +1,152 @@
+#ifndef CSV_READER_H
+#define CSV_READER_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+===========================================================================
+CsvReader Class:
+Splits comma-separated text (RFC 4180) into records without copying it.
+
+Fields are returned as string_views into the input, so the input must stay
+alive while they are used. Only a quoted field containing an escaped quote
+("") has to be rewritten; it is copied into a per-record scratch buffer and
+its view points there, valid until the next call to nextRecord.
+
+Records end at LF or CRLF; line breaks inside quoted fields are part of the
+field. Empty lines are skipped.
+===========================================================================
+*/
+class CsvReader {
+private:
+  struct EscapedField {
+    size_t field;  // Position in the record
+    size_t offset; // Start of the unescaped text in scratch
+    size_t length;
+  };
+
+  const char* pos;
+  const char* end;
+  size_t line = 1;       // Line pos is on
+  size_t recordLine = 0; // Line the last record started on
+  std::string scratch;
+  std::vector<EscapedField> escaped;
+
+  [[noreturn]] void fail(const std::string& message) const {
+    throw std::invalid_argument("CSV line " + std::to_string(line) + ": " + message);
+  }
+
+  void readQuoted(std::vector<std::string_view>& fields) {
+    ++pos; // Opening quote
+    const char* segment = pos;
+    bool hasEscape = false;
+    const size_t offset = scratch.size();
+    while (true) {
+      if (pos == end) fail("unterminated quoted field");
+      if (*pos == '"') {
+        if (pos + 1 < end && pos[1] == '"') {
+          scratch.append(segment, pos + 1); // Keep one quote
+          pos += 2;
+          segment = pos;
+          hasEscape = true;
+          continue;
+        }
+        break;
+      }
+      if (*pos == '\n') ++line;
+      ++pos;
+    }
+    if (hasEscape) {
+      scratch.append(segment, pos);
+      escaped.push_back({fields.size(), offset, scratch.size() - offset});
+      fields.emplace_back();
+    } else {
+      fields.emplace_back(segment, static_cast<size_t>(pos - segment));
+    }
+    ++pos; // Closing quote
+    if (pos != end && *pos != ',' && *pos != '\n' && !(*pos == '\r' && pos + 1 < end && pos[1] == '\n')) {
+      fail("unexpected character after closing quote");
+    }
+  }
+
+  void readUnquoted(std::vector<std::string_view>& fields) {
+    const char* start = pos;
+    while (pos != end && *pos != ',' && *pos != '\n') ++pos;
+    const char* fieldEnd = pos;
+    if (pos != end && *pos == '\n' && fieldEnd > start && fieldEnd[-1] == '\r') --fieldEnd;
+    fields.emplace_back(start, static_cast<size_t>(fieldEnd - start));
+  }
+
+public:
+  /**
+   * Reads CSV text from memory.
+   *
+   * @param data Start of the text; must outlive the reader and the fields it returns.
+   * @param size Length of the text in bytes.
+   *
+   * @example
+   * MappedFile file("users.csv");
+   * CsvReader reader(reinterpret_cast<const char*>(file.data()), file.size());
+   */
+  CsvReader(const char* data, size_t size) : pos(data), end(data + size) {}
+
+  /**
+   * Reads the next record.
+   *
+   * @param fields Receives the record's fields, replacing its contents.
+   * @return false at the end of the input.
+   * @throws std::invalid_argument on malformed quoting, naming the line.
+   *
+   * @example
+   * std::vector<std::string_view> fields;
+   * while (reader.nextRecord(fields)) { ... }
+   */
+  bool nextRecord(std::vector<std::string_view>& fields) {
+    fields.clear();
+    scratch.clear();
+    escaped.clear();
+
+    // Skip empty lines
+    while (pos != end && (*pos == '\n' || (*pos == '\r' && pos + 1 < end && pos[1] == '\n'))) {
+      pos += (*pos == '\r') ? 2 : 1;
+      ++line;
+    }
+    if (pos == end) return false;
+
+    recordLine = line;
+    while (true) {
+      if (*pos == '"') {
+        readQuoted(fields);
+      } else {
+        readUnquoted(fields);
+      }
+      if (pos == end) break;
+      if (*pos == ',') {
+        ++pos;
+        if (pos == end) {
+          fields.emplace_back(); // Trailing empty field
+          break;
+        }
+        continue;
+      }
+      // End of record: LF or CRLF
+      pos += (*pos == '\r') ? 2 : 1;
+      ++line;
+      break;
+    }
+
+    for (const EscapedField& field : escaped) {
+      fields[field.field] = std::string_view(scratch.data() + field.offset, field.length);
+    }
+    return true;
+  }
+
+  // Line on which the record last returned by nextRecord starts (1-based).
+  size_t recordLineNumber() const { return recordLine; }
+};
+
+#endif
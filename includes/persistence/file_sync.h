@@ -0,0 +1,82 @@
+#ifndef FILE_SYNC_H
+#define FILE_SYNC_H
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+/*
+===========================================================================
+FileSync:
+fsync helpers for making writes survive an OS crash or power loss.
+A file that was renamed into place also needs its directory synced so the
+new directory entry is durable.
+===========================================================================
+*/
+class FileSync {
+public:
+  /**
+   * Flushes an open file descriptor's data to stable storage.
+   *
+   * @param fd Open file descriptor.
+   * @throws std::runtime_error if the sync fails.
+   */
+  static void syncDescriptor(int fd) {
+    while (::fdatasync(fd) != 0) {
+      if (errno != EINTR) {
+        throw std::runtime_error("fdatasync failed: " + std::string(std::strerror(errno)));
+      }
+    }
+  }
+
+  /**
+   * Flushes a file's data to stable storage.
+   *
+   * @param path Path of the file.
+   * @throws std::runtime_error if the file cannot be opened or synced.
+   */
+  static void syncFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      throw std::runtime_error("Failed to open " + path + " for sync");
+    }
+    try {
+      syncDescriptor(fd);
+    } catch (...) {
+      ::close(fd);
+      throw;
+    }
+    ::close(fd);
+  }
+
+  /**
+   * Makes renames and creations inside a directory durable.
+   *
+   * @param path Path of the directory.
+   * @throws std::runtime_error if the directory cannot be opened or synced.
+   */
+  static void syncDirectory(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+      throw std::runtime_error("Failed to open directory " + path + " for sync");
+    }
+    int rc = ::fsync(fd);
+    ::close(fd);
+    if (rc != 0) {
+      throw std::runtime_error("fsync failed on directory " + path);
+    }
+  }
+
+  // Directory part of a file path ("." if there is none).
+  static std::string parentDirectory(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    if (slash == std::string::npos) return ".";
+    if (slash == 0) return "/";
+    return path.substr(0, slash);
+  }
+};
+
+#endif
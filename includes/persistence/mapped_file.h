@@ -0,0 +1,71 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+===========================================================================
+MappedFile Class:
+Read-only memory mapping of a whole file. Pages are faulted in by the OS
+as they are touched, so only the parts of the file that are actually read
+cost I/O and memory. The mapping is released in the destructor.
+===========================================================================
+*/
+class MappedFile {
+private:
+  void* address = nullptr;
+  size_t length = 0;
+
+public:
+  /**
+   * Maps the file at path read-only.
+   *
+   * @param path Path of the file to map.
+   * @throws std::runtime_error if the file cannot be opened or mapped.
+   *
+   * @example
+   * MappedFile file("/home/me/simpledb/db/users.tbl");
+   * const unsigned char* bytes = file.data();
+   */
+  explicit MappedFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      throw std::runtime_error("Failed to open file for reading: " + path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+      ::close(fd);
+      throw std::runtime_error("Failed to stat file: " + path);
+    }
+    length = static_cast<size_t>(info.st_size);
+    if (length > 0) {
+      address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (address == MAP_FAILED) {
+        address = nullptr;
+        ::close(fd);
+        throw std::runtime_error("Failed to map file: " + path);
+      }
+      ::madvise(address, length, MADV_SEQUENTIAL);
+    }
+    ::close(fd); // The mapping stays valid after the descriptor is closed
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  ~MappedFile() {
+    if (address) {
+      ::munmap(address, length);
+    }
+  }
+
+  const unsigned char* data() const { return static_cast<const unsigned char*>(address); }
+  size_t size() const { return length; }
+};
+
+#endif
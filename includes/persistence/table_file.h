@@ -0,0 +1,647 @@
+#ifndef TABLE_FILE_H
+#define TABLE_FILE_H
+
+#include "crc32.h"
+#include "byte_codec.h"
+#include "file_sync.h"
+#include "../table.h"
+#include "../table_statistics.h"
+#include "../value.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+===========================================================================
+TableFile:
+Binary, page-based on-disk format for a single table (.tbl).
+
+Layout (all integers little-endian):
+
+  File header (HEADER_SIZE bytes)
+    char[4]  magic "SDBT"
+    uint16   format version
+    uint16   reserved (0)
+    uint32   page size
+    uint32   number of data pages
+    uint64   row count
+    uint32   schema block size
+    uint32   schema block CRC-32
+    uint32   CRC-32 of the preceding header bytes
+
+  Schema block
+    uint32   column count
+    per column: uint8 type, uint32 name length, name bytes
+    uint32   section count
+    per section: uint32 tag, uint32 length, payload
+      SECTION_CHECKPOINT_LSN: uint64 LSN of the last WAL record folded into this file
+      SECTION_INDEXES: uint32 count, then per index: uint32 length + name,
+        uint32 length + column name, uint8 IndexKind, uint32 fanout (0 = default)
+      SECTION_DICTIONARIES (version 2): uint32 count, then per STRING column:
+        uint32 column position, uint32 entry count, entries as uint32 length + bytes
+      SECTION_STATISTICS (written once the table was analyzed): uint64 row count,
+        uint32 column count, then per column: uint64 row count, uint64 null count,
+        uint64 distinct count, uint32 bound count, bounds as type-tagged values
+    Unknown sections are skipped by readers.
+
+  Data pages, starting at the first page-aligned offset after the schema.
+  Each page is exactly `page size` bytes:
+    uint32   CRC-32 of the remaining page bytes
+    uint32   payload length
+    payload, zero padded
+
+The payloads of all pages form one byte stream holding the rows in order.
+Every cell is a uint8 Value::Type tag followed by its data: int32 for INT,
+uint8 for BOOL, uint32 length plus bytes for STRING, nothing for NULL.
+Version 2 writes STRING cells as CELL_DICTIONARY_CODE followed by a uint32
+code into the column's entry in SECTION_DICTIONARIES; version 1 files
+(inline strings only) are still read. A cell may continue on the next page.
+===========================================================================
+*/
+class TableFile {
+public:
+  static constexpr char MAGIC[4] = {'S', 'D', 'B', 'T'};
+  static constexpr uint16_t VERSION = 2;
+  static constexpr uint16_t MIN_VERSION = 1; // Oldest version read() accepts
+  static constexpr uint8_t CELL_DICTIONARY_CODE = 0x80;
+  static constexpr uint32_t PAGE_SIZE = 4096;
+  static constexpr size_t HEADER_SIZE = 36;
+  static constexpr size_t PAGE_HEADER_SIZE = 8;
+
+  enum SectionTag : uint32_t {
+    SECTION_CHECKPOINT_LSN = 1,
+    SECTION_INDEXES = 2,
+    SECTION_DICTIONARIES = 3,
+    SECTION_STATISTICS = 4
+  };
+
+private:
+  static size_t dataOffset(size_t schemaSize, uint32_t pageSize) {
+    size_t end = HEADER_SIZE + schemaSize;
+    return (end + pageSize - 1) / pageSize * pageSize;
+  }
+
+  // Splits the row byte stream into checksummed fixed-size pages.
+  class PageWriter {
+  private:
+    std::ostream& out;
+    std::string page;
+    size_t used = 0;
+    uint32_t pageCount = 0;
+
+    void flushPage() {
+      std::memset(&page[PAGE_HEADER_SIZE + used], 0, PAGE_SIZE - PAGE_HEADER_SIZE - used);
+      unsigned char* p = reinterpret_cast<unsigned char*>(&page[0]);
+      ByteCodec::setU32(p + 4, static_cast<uint32_t>(used));
+      ByteCodec::setU32(p, Crc32::compute(p + 4, PAGE_SIZE - 4));
+      out.write(page.data(), PAGE_SIZE);
+      used = 0;
+      ++pageCount;
+    }
+
+  public:
+    PageWriter(std::ostream& os) : out(os), page(PAGE_SIZE, '\0') {}
+
+    void write(const char* data, size_t length) {
+      const size_t capacity = PAGE_SIZE - PAGE_HEADER_SIZE;
+      while (length > 0) {
+        size_t chunk = std::min(length, capacity - used);
+        std::memcpy(&page[PAGE_HEADER_SIZE + used], data, chunk);
+        used += chunk;
+        data += chunk;
+        length -= chunk;
+        if (used == capacity) flushPage();
+      }
+    }
+
+    uint32_t finish() {
+      if (used > 0) flushPage();
+      return pageCount;
+    }
+  };
+
+  // Reads the row byte stream back, verifying each page checksum on entry.
+  class PageReader {
+  private:
+    const unsigned char* data;
+    size_t size;
+    size_t offset;
+    uint32_t pageSize;
+    uint32_t pagesLeft;
+    const unsigned char* payload = nullptr;
+    size_t payloadLength = 0;
+    size_t position = 0;
+
+    void nextPage() {
+      if (pagesLeft == 0 || offset + pageSize > size) {
+        throw std::runtime_error("Corrupt table file: unexpected end of data");
+      }
+      const unsigned char* page = data + offset;
+      if (Crc32::compute(page + 4, pageSize - 4) != ByteCodec::getU32(page)) {
+        throw std::runtime_error("Corrupt table file: checksum mismatch in page " +
+                                 std::to_string((offset / pageSize)));
+      }
+      payloadLength = ByteCodec::getU32(page + 4);
+      if (payloadLength > pageSize - PAGE_HEADER_SIZE) {
+        throw std::runtime_error("Corrupt table file: invalid page payload length");
+      }
+      payload = page + PAGE_HEADER_SIZE;
+      position = 0;
+      offset += pageSize;
+      --pagesLeft;
+    }
+
+  public:
+    PageReader(const unsigned char* d, size_t s, size_t start, uint32_t ps, uint32_t pages)
+        : data(d), size(s), offset(start), pageSize(ps), pagesLeft(pages) {}
+
+    void read(void* dst, size_t length) {
+      unsigned char* out = static_cast<unsigned char*>(dst);
+      while (length > 0) {
+        if (position == payloadLength) nextPage();
+        size_t chunk = std::min(length, payloadLength - position);
+        std::memcpy(out, payload + position, chunk);
+        position += chunk;
+        out += chunk;
+        length -= chunk;
+      }
+    }
+
+    uint8_t readU8() {
+      unsigned char b;
+      read(&b, 1);
+      return b;
+    }
+
+    uint32_t readU32() {
+      unsigned char b[4];
+      read(b, 4);
+      return ByteCodec::getU32(b);
+    }
+
+    // Upper bound on the stream bytes still available, used to reject corrupt lengths.
+    size_t bytesLeft() const {
+      return (payloadLength - position) + (size > offset ? size - offset : 0);
+    }
+  };
+
+  // dictionary holds the column's SECTION_DICTIONARIES entries, if any.
+  static Value readValue(PageReader& reader, const std::vector<std::string>* dictionary) {
+    const uint8_t tag = reader.readU8();
+    if (tag == CELL_DICTIONARY_CODE) {
+      uint32_t code = reader.readU32();
+      if (!dictionary || code >= dictionary->size()) {
+        throw std::runtime_error("Corrupt table file: invalid dictionary code");
+      }
+      return Value(std::string_view((*dictionary)[code]));
+    }
+    switch (static_cast<Value::Type>(tag)) {
+      case Value::INT:
+        return Value(static_cast<int>(reader.readU32()));
+      case Value::BOOL:
+        return Value(reader.readU8() != 0);
+      case Value::STRING: {
+        uint32_t length = reader.readU32();
+        if (length > reader.bytesLeft()) {
+          throw std::runtime_error("Corrupt table file: invalid string length");
+        }
+        std::string str(length, '\0');
+        reader.read(&str[0], str.size());
+        return Value(str);
+      }
+      case Value::NULL_TYPE:
+        return Value();
+      default:
+        throw std::runtime_error("Corrupt table file: unknown value type");
+    }
+  }
+
+  // Parses one legacy cell ("<typeint> <text>") starting at pos.
+  static Value parseLegacyCell(const std::string& line, size_t& pos) {
+    while (pos < line.size() && line[pos] == ' ') ++pos;
+    size_t typeEnd = line.find(' ', pos);
+    if (typeEnd == std::string::npos) {
+      throw std::runtime_error("Malformed legacy row: " + line);
+    }
+    Value::Type type = static_cast<Value::Type>(std::stoi(line.substr(pos, typeEnd - pos)));
+    pos = typeEnd + 1;
+
+    if (type == Value::STRING && pos < line.size() && line[pos] == '"') {
+      // The old writer did not escape strings, so the closing quote is the one
+      // followed by end of line or by the next "<typeint> " cell.
+      size_t close = pos + 1;
+      while ((close = line.find('"', close)) != std::string::npos) {
+        size_t next = close + 1;
+        if (next == line.size()) break;
+        if (line[next] == ' ' && next + 2 < line.size() &&
+            std::isdigit(static_cast<unsigned char>(line[next + 1])) && line[next + 2] == ' ') {
+          break;
+        }
+        ++close;
+      }
+      if (close == std::string::npos) {
+        throw std::runtime_error("Malformed legacy string in row: " + line);
+      }
+      std::string str = line.substr(pos + 1, close - pos - 1);
+      pos = close + 1;
+      return Value(str);
+    }
+
+    size_t end = line.find(' ', pos);
+    if (end == std::string::npos) end = line.size();
+    std::string text = line.substr(pos, end - pos);
+    pos = end;
+    switch (type) {
+      case Value::INT:
+        return Value(std::stoi(text));
+      case Value::BOOL:
+        return Value(text == "true");
+      case Value::STRING:
+        return Value(text);
+      default:
+        return Value();
+    }
+  }
+
+public:
+  /**
+   * Checks whether a buffer starts with the binary table file magic.
+   *
+   * @param data File contents.
+   * @param size Size of the contents in bytes.
+   * @return true if the buffer looks like a binary table file.
+   */
+  static bool isBinary(const unsigned char* data, size_t size) {
+    return size >= HEADER_SIZE && std::memcmp(data, MAGIC, sizeof(MAGIC)) == 0;
+  }
+
+  /**
+   * Writes a table to disk in the binary page format.
+   * The file is written to a temporary path and renamed over the target, so a
+   * crash mid-write leaves the previous version intact.
+   *
+   * @param table Table to write.
+   * @param path Destination file path.
+   * @param checkpointLsn LSN of the last write-ahead log record contained in the table.
+   * @param sync If true, the file and its directory are fsynced before returning.
+   * @throws std::runtime_error if the file cannot be written.
+   *
+   * @example
+   * TableFile::write(storage.getTable("users"), "/home/me/simpledb/db/users.tbl");
+   */
+  static void write(const Table& table, const std::string& path, uint64_t checkpointLsn = 0, bool sync = false) {
+    const std::vector<std::string> columnNames = table.getColumnNames();
+    const std::vector<Value::Type>& columnTypes = table.getColumnTypes();
+
+    std::string schema;
+    ByteCodec::putU32(schema, static_cast<uint32_t>(columnNames.size()));
+    for (size_t i = 0; i < columnNames.size(); ++i) {
+      ByteCodec::putU8(schema, static_cast<uint8_t>(columnTypes[i]));
+      ByteCodec::putU32(schema, static_cast<uint32_t>(columnNames[i].size()));
+      schema += columnNames[i];
+    }
+    const TableStatistics* statistics = table.getStatistics();
+    ByteCodec::putU32(schema, statistics ? 4 : 3); // Section count
+    ByteCodec::putU32(schema, SECTION_CHECKPOINT_LSN);
+    ByteCodec::putU32(schema, 8);
+    ByteCodec::putU64(schema, checkpointLsn);
+
+    std::string indexes;
+    const std::vector<IndexDefinition>& definitions = table.getIndexDefinitions();
+    ByteCodec::putU32(indexes, static_cast<uint32_t>(definitions.size()));
+    for (const IndexDefinition& def : definitions) {
+      ByteCodec::putString(indexes, def.name);
+      ByteCodec::putString(indexes, def.column);
+      ByteCodec::putU8(indexes, static_cast<uint8_t>(def.kind));
+      ByteCodec::putU32(indexes, static_cast<uint32_t>(def.fanout));
+    }
+    ByteCodec::putU32(schema, SECTION_INDEXES);
+    ByteCodec::putString(schema, indexes);
+
+    std::string dictionaries;
+    uint32_t dictionaryCount = 0;
+    for (size_t col = 0; col < columnTypes.size(); ++col) {
+      if (columnTypes[col] != Value::STRING) continue;
+      const StringDictionary& dictionary = table.getColumn(col).getDictionary();
+      ByteCodec::putU32(dictionaries, static_cast<uint32_t>(col));
+      ByteCodec::putU32(dictionaries, static_cast<uint32_t>(dictionary.size()));
+      for (uint32_t code = 0; code < dictionary.size(); ++code) {
+        ByteCodec::putString(dictionaries, dictionary.decode(code));
+      }
+      ++dictionaryCount;
+    }
+    std::string dictionarySection;
+    ByteCodec::putU32(dictionarySection, dictionaryCount);
+    dictionarySection += dictionaries;
+    ByteCodec::putU32(schema, SECTION_DICTIONARIES);
+    ByteCodec::putString(schema, dictionarySection);
+
+    if (statistics) {
+      std::string statisticsSection;
+      ByteCodec::putU64(statisticsSection, statistics->rowCount);
+      ByteCodec::putU32(statisticsSection, static_cast<uint32_t>(statistics->columns.size()));
+      for (const ColumnStatistics& column : statistics->columns) {
+        ByteCodec::putU64(statisticsSection, column.rowCount);
+        ByteCodec::putU64(statisticsSection, column.nullCount);
+        ByteCodec::putU64(statisticsSection, column.distinctCount);
+        ByteCodec::putU32(statisticsSection, static_cast<uint32_t>(column.bounds.size()));
+        for (const Value& bound : column.bounds) {
+          ByteCodec::putValue(statisticsSection, bound);
+        }
+      }
+      ByteCodec::putU32(schema, SECTION_STATISTICS);
+      ByteCodec::putString(schema, statisticsSection);
+    }
+
+    const std::string tmpPath = path + ".tmp";
+    std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      throw std::runtime_error("Failed to open file for writing");
+    }
+
+    // Header is rewritten once the page count is known.
+    std::string padding(dataOffset(schema.size(), PAGE_SIZE), '\0');
+    std::memcpy(&padding[HEADER_SIZE], schema.data(), schema.size());
+    out.write(padding.data(), padding.size());
+
+    PageWriter pages(out);
+    std::string cell;
+    for (size_t row = 0; row < table.getRowCount(); ++row) {
+      for (size_t col = 0; col < columnNames.size(); ++col) {
+        const Column& column = table.getColumn(col);
+        cell.clear();
+        ByteCodec::putU8(cell, columnTypes[col] == Value::STRING ? CELL_DICTIONARY_CODE
+                                                               : static_cast<uint8_t>(columnTypes[col]));
+        switch (columnTypes[col]) {
+          case Value::INT:
+            ByteCodec::putU32(cell, static_cast<uint32_t>(column.getIntValues()[row]));
+            break;
+          case Value::BOOL:
+            ByteCodec::putU8(cell, column.getBoolValues()[row]);
+            break;
+          case Value::STRING:
+            ByteCodec::putU32(cell, column.getStringCodes()[row]);
+            break;
+          default:
+            break;
+        }
+        pages.write(cell.data(), cell.size());
+      }
+    }
+    uint32_t pageCount = pages.finish();
+
+    std::string header(MAGIC, sizeof(MAGIC));
+    ByteCodec::putU16(header, VERSION);
+    ByteCodec::putU16(header, 0);
+    ByteCodec::putU32(header, PAGE_SIZE);
+    ByteCodec::putU32(header, pageCount);
+    ByteCodec::putU64(header, table.getRowCount());
+    ByteCodec::putU32(header, static_cast<uint32_t>(schema.size()));
+    ByteCodec::putU32(header, Crc32::compute(schema.data(), schema.size()));
+    ByteCodec::putU32(header, Crc32::compute(header.data(), header.size()));
+    out.seekp(0);
+    out.write(header.data(), header.size());
+    out.close();
+    if (!out) {
+      throw std::runtime_error("Failed to write table file");
+    }
+
+    if (sync) {
+      FileSync::syncFile(tmpPath);
+    }
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+      throw std::runtime_error("Failed to replace table file: " + path);
+    }
+    if (sync) {
+      FileSync::syncDirectory(FileSync::parentDirectory(path));
+    }
+  }
+
+  // Everything stored before the first data page.
+  struct Header {
+    uint32_t pageSize = 0;
+    uint32_t pageCount = 0;
+    uint64_t rowCount = 0;
+    uint32_t schemaSize = 0;
+    uint64_t checkpointLsn = 0;
+    std::vector<std::string> columnNames;
+    std::vector<Value::Type> columnTypes;
+    std::vector<IndexDefinition> indexes;
+    std::vector<std::vector<std::string>> dictionaries; // Per column; empty unless dictionary encoded
+    std::optional<TableStatistics> statistics;
+  };
+
+  /**
+   * Validates and decodes the header and schema block of a binary table file
+   * without touching the data pages.
+   *
+   * @param data File contents.
+   * @param size Size of the contents in bytes.
+   * @return The decoded header.
+   * @throws std::runtime_error if the header is corrupt or of an unsupported version.
+   */
+  static Header readHeader(const unsigned char* data, size_t size) {
+    if (!isBinary(data, size)) {
+      throw std::runtime_error("Not a binary table file");
+    }
+    if (Crc32::compute(data, HEADER_SIZE - 4) != ByteCodec::getU32(data + HEADER_SIZE - 4)) {
+      throw std::runtime_error("Corrupt table file: header checksum mismatch");
+    }
+    uint16_t version = ByteCodec::getU16(data + 4);
+    if (version < MIN_VERSION || version > VERSION) {
+      throw std::runtime_error("Unsupported table file version: " + std::to_string(version));
+    }
+    Header header;
+    header.pageSize = ByteCodec::getU32(data + 8);
+    header.pageCount = ByteCodec::getU32(data + 12);
+    header.rowCount = ByteCodec::getU64(data + 16);
+    header.schemaSize = ByteCodec::getU32(data + 24);
+    if (header.pageSize <= PAGE_HEADER_SIZE || HEADER_SIZE + header.schemaSize > size) {
+      throw std::runtime_error("Corrupt table file: invalid header");
+    }
+    const unsigned char* schema = data + HEADER_SIZE;
+    if (Crc32::compute(schema, header.schemaSize) != ByteCodec::getU32(data + 28)) {
+      throw std::runtime_error("Corrupt table file: schema checksum mismatch");
+    }
+
+    try {
+      ByteReader reader(schema, header.schemaSize);
+      uint32_t columnCount = reader.readU32();
+      for (uint32_t i = 0; i < columnCount; ++i) {
+        header.columnTypes.push_back(static_cast<Value::Type>(reader.readU8()));
+        header.columnNames.push_back(reader.readString());
+      }
+      uint32_t sectionCount = reader.readU32();
+      for (uint32_t i = 0; i < sectionCount; ++i) {
+        uint32_t tag = reader.readU32();
+        std::string payload = reader.readString();
+        if (tag == SECTION_CHECKPOINT_LSN && payload.size() == 8) {
+          header.checkpointLsn = ByteCodec::getU64(reinterpret_cast<const unsigned char*>(payload.data()));
+        } else if (tag == SECTION_INDEXES) {
+          ByteReader indexReader(reinterpret_cast<const unsigned char*>(payload.data()), payload.size());
+          uint32_t indexCount = indexReader.readU32();
+          for (uint32_t j = 0; j < indexCount; ++j) {
+            IndexDefinition def;
+            def.name = indexReader.readString();
+            def.column = indexReader.readString();
+            def.kind = static_cast<IndexKind>(indexReader.readU8());
+            def.fanout = indexReader.readU32();
+            header.indexes.push_back(def);
+          }
+        } else if (tag == SECTION_DICTIONARIES) {
+          ByteReader dictionaryReader(reinterpret_cast<const unsigned char*>(payload.data()), payload.size());
+          header.dictionaries.resize(columnCount);
+          uint32_t dictionaryCount = dictionaryReader.readU32();
+          for (uint32_t j = 0; j < dictionaryCount; ++j) {
+            uint32_t column = dictionaryReader.readU32();
+            uint32_t entryCount = dictionaryReader.readU32();
+            if (column >= columnCount || entryCount > dictionaryReader.remaining() / 4) {
+              throw std::runtime_error("Corrupt table file: invalid dictionary");
+            }
+            std::vector<std::string>& entries = header.dictionaries[column];
+            entries.reserve(entryCount);
+            for (uint32_t k = 0; k < entryCount; ++k) {
+              entries.push_back(dictionaryReader.readString());
+            }
+          }
+        } else if (tag == SECTION_STATISTICS) {
+          ByteReader statisticsReader(reinterpret_cast<const unsigned char*>(payload.data()), payload.size());
+          TableStatistics statistics;
+          statistics.rowCount = statisticsReader.readU64();
+          uint32_t statisticsColumns = statisticsReader.readU32();
+          if (statisticsColumns != columnCount) {
+            throw std::runtime_error("Corrupt table file: invalid statistics");
+          }
+          statistics.columns.resize(statisticsColumns);
+          for (ColumnStatistics& column : statistics.columns) {
+            column.rowCount = statisticsReader.readU64();
+            column.nullCount = statisticsReader.readU64();
+            column.distinctCount = statisticsReader.readU64();
+            uint32_t boundCount = statisticsReader.readU32();
+            if (boundCount > statisticsReader.remaining()) {
+              throw std::runtime_error("Corrupt table file: invalid statistics");
+            }
+            for (uint32_t k = 0; k < boundCount; ++k) {
+              column.bounds.push_back(statisticsReader.readValue());
+            }
+          }
+          header.statistics = std::move(statistics);
+        }
+      }
+    } catch (const std::runtime_error&) {
+      throw std::runtime_error("Corrupt table file: truncated schema");
+    }
+    return header;
+  }
+
+  /**
+   * Decodes a table from the contents of a binary table file.
+   *
+   * @param tableName Name to give the loaded table.
+   * @param data File contents.
+   * @param size Size of the contents in bytes.
+   * @param checkpointLsn If non-null, receives the LSN stored by write().
+   * @param pool Optional thread pool to build the column indexes on.
+   * @return The decoded table with its declared indexes built.
+   * @throws std::runtime_error if the file is truncated, corrupt or of an unsupported version.
+   *
+   * @example
+   * Table users = TableFile::read("users", bytes.data(), bytes.size());
+   */
+  static Table read(const std::string& tableName, const unsigned char* data, size_t size,
+                    uint64_t* checkpointLsn = nullptr, ThreadPool* pool = nullptr) {
+    Header header = readHeader(data, size);
+    if (checkpointLsn) {
+      *checkpointLsn = header.checkpointLsn;
+    }
+
+    const size_t columnCount = header.columnNames.size();
+    Table table(tableName, header.columnNames, header.columnTypes);
+    for (const IndexDefinition& def : header.indexes) {
+      table.createIndex(def); // Empty for now; filled by buildIndexes below
+    }
+    if (header.statistics) {
+      table.setStatistics(std::move(*header.statistics));
+    }
+    PageReader reader(data, size, dataOffset(header.schemaSize, header.pageSize), header.pageSize, header.pageCount);
+    std::vector<Value> row;
+    row.reserve(columnCount);
+    for (uint64_t i = 0; i < header.rowCount; ++i) {
+      row.clear();
+      for (size_t j = 0; j < columnCount; ++j) {
+        const bool encoded = j < header.dictionaries.size() && header.columnTypes[j] == Value::STRING;
+        row.push_back(readValue(reader, encoded ? &header.dictionaries[j] : nullptr));
+      }
+      table.appendRow(row);
+    }
+    table.buildIndexes(pool);
+    return table;
+  }
+
+  /**
+   * Reads a table from the legacy text format (one "<typeint> <text>" cell per
+   * value, as written by earlier versions of Storage::persistTable).
+   * Quoted strings containing spaces are recovered.
+   *
+   * @param tableName Name to give the loaded table.
+   * @param in Stream over the legacy file contents.
+   * @return The decoded table. Legacy files declare no indexes.
+   * @throws std::runtime_error if the data is malformed.
+   *
+   * @example
+   * std::ifstream in("users.tbl");
+   * Table users = TableFile::readLegacyText("users", in);
+   */
+  static Table readLegacyText(const std::string& tableName, std::istream& in) {
+    size_t columnCount;
+    if (!(in >> columnCount)) {
+      throw std::runtime_error("Malformed legacy table file");
+    }
+    in.ignore(); // Skip newline
+
+    std::vector<std::string> columnNames;
+    for (size_t i = 0; i < columnCount; ++i) {
+      std::string colName;
+      std::getline(in, colName);
+      columnNames.push_back(colName);
+    }
+
+    std::vector<Value::Type> columnTypes;
+    for (size_t i = 0; i < columnCount; ++i) {
+      std::string typeStr;
+      std::getline(in, typeStr);
+      columnTypes.push_back(Value::stringToType(typeStr));
+    }
+
+    Table table(tableName, columnNames, columnTypes);
+
+    size_t rowCount;
+    if (!(in >> rowCount)) {
+      throw std::runtime_error("Malformed legacy table file");
+    }
+    in.ignore(); // Skip newline
+
+    std::vector<Value> row;
+    std::string line;
+    for (size_t i = 0; i < rowCount && std::getline(in, line); i++) {
+      row.clear();
+      size_t pos = 0;
+      for (size_t j = 0; j < columnCount; j++) {
+        row.push_back(parseLegacyCell(line, pos));
+      }
+      table.appendRow(row);
+    }
+    return table;
+  }
+};
+
+#endif
@@ -0,0 +1,482 @@
+#ifndef WAL_H
+#define WAL_H
+
+#include "byte_codec.h"
+#include "crc32.h"
+#include "file_sync.h"
+#include "../value.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/*
+===========================================================================
+WriteAheadLog Class:
+Append-only log of table changes for one database directory (wal.log).
+
+Changes are appended here instead of rewriting table files, and replayed
+on startup. A checkpoint writes the affected tables out and resets the log.
+
+Layout (all integers little-endian):
+
+  Header (HEADER_SIZE bytes)
+    char[4]  magic "SDBW"
+    uint32   format version
+    uint64   LSN assigned to the first record after the header
+
+  Records, back to back
+    uint32   body length
+    uint32   CRC-32 of the body
+    body:    uint64 LSN, uint8 record type, record payload
+      CREATE_TABLE: table name, uint32 column count, per column: uint8 type, name
+      INSERT:       table name, uint32 value count, values (see ByteCodec)
+      INSERT_ROWS:  table name, uint32 row count, uint32 column count,
+                    values row by row; one record per multi-row INSERT, so
+                    the statement is replayed entirely or not at all
+
+Replay stops at the first truncated or corrupt record; that tail is what a
+crash in the middle of an append leaves behind, and it is cut off.
+
+Group commit:
+append() only encodes the record into an in-memory buffer. commit(lsn)
+makes it durable: the first waiting committer becomes the leader, writes
+everything buffered so far in one write() and, unless sync is OFF, one
+fdatasync(), then wakes every follower whose record was included.
+  OFF   - records reach the OS at commit but are never fsynced
+  FULL  - the leader flushes immediately
+  BATCH - the leader first waits the commit window so more committers can
+          join the same flush, trading latency for throughput
+append() and commit() are safe to call from multiple threads.
+===========================================================================
+*/
+class WriteAheadLog {
+public:
+  enum RecordType : uint8_t { CREATE_TABLE = 1, INSERT = 2, INSERT_ROWS = 3 };
+  enum class SyncMode { OFF, BATCH, FULL };
+
+  struct Record {
+    RecordType type;
+    uint64_t lsn;
+    std::string tableName;
+    std::vector<std::string> columnNames; // CREATE_TABLE only
+    std::vector<Value::Type> columnTypes; // CREATE_TABLE only
+    std::vector<Value> values;            // INSERT only
+    std::vector<std::vector<Value>> rows; // INSERT_ROWS only
+  };
+
+  static constexpr char MAGIC[4] = {'S', 'D', 'B', 'W'};
+  static constexpr uint32_t VERSION = 1;
+  static constexpr size_t HEADER_SIZE = 16;
+  static constexpr size_t FRAME_HEADER_SIZE = 8;
+
+private:
+  std::string path;
+  int fd = -1;
+  uint64_t nextLsn = 1;
+  size_t fileSize = 0;
+
+  // Group commit state, guarded by mutex.
+  mutable std::mutex mutex;
+  std::condition_variable flushDone;
+  std::string pending;      // Encoded records not yet written
+  uint64_t flushedLsn = 0;  // Highest LSN written (and synced, unless OFF)
+  bool flushing = false;    // A leader is currently writing
+  SyncMode syncMode = SyncMode::FULL;
+  std::chrono::microseconds commitWindow{1000};
+
+  void writeAll(const char* data, size_t length) {
+    while (length > 0) {
+      ssize_t written = ::write(fd, data, length);
+      if (written < 0) {
+        if (errno == EINTR) continue;
+        throw std::runtime_error("Failed to write write-ahead log: " + std::string(std::strerror(errno)));
+      }
+      data += written;
+      length -= static_cast<size_t>(written);
+    }
+  }
+
+  static std::string encodeHeader(uint64_t baseLsn) {
+    std::string header(MAGIC, sizeof(MAGIC));
+    ByteCodec::putU32(header, VERSION);
+    ByteCodec::putU64(header, baseLsn);
+    return header;
+  }
+
+  void openForAppend() {
+    fd = ::open(path.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (fd < 0) {
+      throw std::runtime_error("Failed to open write-ahead log: " + path);
+    }
+  }
+
+  // Atomically replaces the log with an empty one whose first record gets baseLsn.
+  // Caller must hold mutex or be the only thread using the log.
+  void rewriteEmpty(uint64_t baseLsn) {
+    if (fd >= 0) {
+      ::close(fd);
+      fd = -1;
+    }
+    const std::string tmpPath = path + ".tmp";
+    {
+      std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+      std::string header = encodeHeader(baseLsn);
+      out.write(header.data(), header.size());
+      if (!out) {
+        throw std::runtime_error("Failed to create write-ahead log: " + tmpPath);
+      }
+    }
+    if (syncMode != SyncMode::OFF) {
+      FileSync::syncFile(tmpPath);
+    }
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+      throw std::runtime_error("Failed to replace write-ahead log: " + path);
+    }
+    if (syncMode != SyncMode::OFF) {
+      FileSync::syncDirectory(FileSync::parentDirectory(path));
+    }
+    openForAppend();
+    fileSize = HEADER_SIZE;
+    nextLsn = baseLsn;
+    flushedLsn = baseLsn - 1;
+  }
+
+  uint64_t append(RecordType type, const std::string& payload) {
+    std::string body;
+    body.reserve(9 + payload.size());
+    ByteCodec::putU64(body, 0); // LSN, patched in under the lock
+    ByteCodec::putU8(body, type);
+    body += payload;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd < 0) {
+      throw std::runtime_error("Write-ahead log is not open");
+    }
+    const uint64_t lsn = nextLsn++;
+    for (int i = 0; i < 8; ++i) body[i] = static_cast<char>((lsn >> (8 * i)) & 0xFF);
+
+    ByteCodec::putU32(pending, static_cast<uint32_t>(body.size()));
+    ByteCodec::putU32(pending, Crc32::compute(body.data(), body.size()));
+    pending += body;
+    fileSize += FRAME_HEADER_SIZE + body.size();
+    return lsn;
+  }
+
+  static Record decode(const unsigned char* body, size_t length) {
+    ByteReader reader(body, length);
+    Record record;
+    record.lsn = reader.readU64();
+    record.type = static_cast<RecordType>(reader.readU8());
+    record.tableName = reader.readString();
+    uint32_t count = reader.readU32();
+    switch (record.type) {
+      case CREATE_TABLE:
+        for (uint32_t i = 0; i < count; ++i) {
+          record.columnTypes.push_back(static_cast<Value::Type>(reader.readU8()));
+          record.columnNames.push_back(reader.readString());
+        }
+        break;
+      case INSERT:
+        record.values.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) {
+          record.values.push_back(reader.readValue());
+        }
+        break;
+      case INSERT_ROWS: {
+        const uint32_t columnCount = reader.readU32();
+        record.rows.resize(count);
+        for (std::vector<Value>& row : record.rows) {
+          row.reserve(columnCount);
+          for (uint32_t i = 0; i < columnCount; ++i) {
+            row.push_back(reader.readValue());
+          }
+        }
+        break;
+      }
+      default:
+        throw std::runtime_error("Unknown write-ahead log record type");
+    }
+    return record;
+  }
+
+public:
+  WriteAheadLog(const std::string& logPath) : path(logPath) {}
+
+  WriteAheadLog(const WriteAheadLog&) = delete;
+  WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+  ~WriteAheadLog() {
+    if (fd >= 0) {
+      ::close(fd);
+    }
+  }
+
+  /**
+   * Opens the log, passing every intact record to apply in LSN order.
+   * A torn or corrupt tail is truncated away. Must be called once before appending.
+   *
+   * @param apply Callback invoked for each recovered record.
+   * @param minLsn Lowest LSN to hand out if the log has to be created from scratch,
+   *               so new records sort after everything already in the table files.
+   * @return Number of records replayed.
+   * @throws std::runtime_error if the log file cannot be read or created.
+   *
+   * @example
+   * WriteAheadLog wal(basePath + "/wal.log");
+   * wal.replay([&](const WriteAheadLog::Record& record) { ... });
+   */
+  size_t replay(const std::function<void(const Record&)>& apply, uint64_t minLsn = 1) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+      rewriteEmpty(std::max(nextLsn, minLsn));
+      return 0;
+    }
+    std::vector<char> contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(contents.data());
+    if (contents.size() < HEADER_SIZE || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0 ||
+        ByteCodec::getU32(data + 4) != VERSION) {
+      throw std::runtime_error("Unrecognized write-ahead log: " + path);
+    }
+    nextLsn = ByteCodec::getU64(data + 8);
+    flushedLsn = nextLsn - 1;
+
+    size_t offset = HEADER_SIZE;
+    size_t replayed = 0;
+    while (contents.size() - offset >= FRAME_HEADER_SIZE) {
+      uint32_t length = ByteCodec::getU32(data + offset);
+      uint32_t crc = ByteCodec::getU32(data + offset + 4);
+      const unsigned char* body = data + offset + FRAME_HEADER_SIZE;
+      if (length > contents.size() - offset - FRAME_HEADER_SIZE || Crc32::compute(body, length) != crc) {
+        break;
+      }
+      Record record = decode(body, length);
+      apply(record);
+      nextLsn = record.lsn + 1;
+      flushedLsn = record.lsn;
+      offset += FRAME_HEADER_SIZE + length;
+      ++replayed;
+    }
+
+    if (offset != contents.size()) {
+      if (::truncate(path.c_str(), static_cast<off_t>(offset)) != 0) {
+        throw std::runtime_error("Failed to truncate write-ahead log: " + path);
+      }
+    }
+    openForAppend();
+    fileSize = offset;
+    return replayed;
+  }
+
+  /**
+   * Appends a CREATE TABLE record.
+   *
+   * @return LSN of the record.
+   */
+  uint64_t appendCreateTable(const std::string& tableName, const std::vector<std::string>& columnNames,
+                             const std::vector<Value::Type>& columnTypes) {
+    std::string payload;
+    ByteCodec::putString(payload, tableName);
+    ByteCodec::putU32(payload, static_cast<uint32_t>(columnNames.size()));
+    for (size_t i = 0; i < columnNames.size(); ++i) {
+      ByteCodec::putU8(payload, static_cast<uint8_t>(columnTypes[i]));
+      ByteCodec::putString(payload, columnNames[i]);
+    }
+    return append(CREATE_TABLE, payload);
+  }
+
+  /**
+   * Appends an INSERT record for one row.
+   *
+   * @return LSN of the record.
+   *
+   * @example
+   * wal.appendInsert("users", {Value(1), Value("Alice")});
+   */
+  uint64_t appendInsert(const std::string& tableName, const std::vector<Value>& values) {
+    std::string payload;
+    ByteCodec::putString(payload, tableName);
+    ByteCodec::putU32(payload, static_cast<uint32_t>(values.size()));
+    for (const Value& val : values) {
+      ByteCodec::putValue(payload, val);
+    }
+    return append(INSERT, payload);
+  }
+
+  /**
+   * Appends one INSERT_ROWS record holding every row of a multi-row INSERT.
+   * All rows must have the same number of values.
+   *
+   * @return LSN of the record.
+   *
+   * @example
+   * wal.appendInsertRows("users", {{Value(1), Value("Alice")}, {Value(2), Value("Bob")}});
+   */
+  uint64_t appendInsertRows(const std::string& tableName, const std::vector<std::vector<Value>>& rows) {
+    std::string payload;
+    ByteCodec::putString(payload, tableName);
+    ByteCodec::putU32(payload, static_cast<uint32_t>(rows.size()));
+    ByteCodec::putU32(payload, static_cast<uint32_t>(rows.empty() ? 0 : rows[0].size()));
+    for (const std::vector<Value>& row : rows) {
+      for (const Value& val : row) {
+        ByteCodec::putValue(payload, val);
+      }
+    }
+    return append(INSERT_ROWS, payload);
+  }
+
+  /**
+   * Blocks until the record with the given LSN (and every earlier one) is
+   * durable according to the sync mode. Concurrent callers share one flush.
+   *
+   * @param lsn LSN returned by one of the append methods.
+   * @throws std::runtime_error if writing or syncing the log fails.
+   *
+   * @example
+   * uint64_t lsn = wal.appendInsert("users", row);
+   * wal.commit(lsn);
+   */
+  void commit(uint64_t lsn) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (flushedLsn < lsn) {
+      if (flushing) {
+        flushDone.wait(lock);
+        continue;
+      }
+
+      // Become the leader for the next flush.
+      flushing = true;
+      if (syncMode == SyncMode::BATCH && commitWindow.count() > 0) {
+        lock.unlock();
+        std::this_thread::sleep_for(commitWindow);
+        lock.lock();
+      }
+      std::string batch;
+      batch.swap(pending);
+      const uint64_t batchLsn = nextLsn - 1;
+      const bool sync = syncMode != SyncMode::OFF;
+      lock.unlock();
+
+      try {
+        writeAll(batch.data(), batch.size());
+        if (sync) {
+          FileSync::syncDescriptor(fd);
+        }
+      } catch (...) {
+        lock.lock();
+        flushing = false;
+        flushDone.notify_all();
+        throw;
+      }
+
+      lock.lock();
+      flushedLsn = batchLsn;
+      flushing = false;
+      flushDone.notify_all();
+    }
+  }
+
+  /**
+   * Makes every appended record durable.
+   */
+  void flush() {
+    commit(lastLsn());
+  }
+
+  /**
+   * Discards every record, keeping LSNs increasing across the reset.
+   * Only call once all changes in the log are safely in the table files,
+   * and while no other thread is appending.
+   */
+  void reset() {
+    flush();
+    std::lock_guard<std::mutex> lock(mutex);
+    rewriteEmpty(nextLsn);
+  }
+
+  void setSyncMode(SyncMode mode) {
+    std::lock_guard<std::mutex> lock(mutex);
+    syncMode = mode;
+  }
+
+  SyncMode getSyncMode() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return syncMode;
+  }
+
+  /**
+   * Sets how long a BATCH leader waits for other committers before flushing.
+   *
+   * @param window Commit window; zero flushes immediately like FULL.
+   */
+  void setCommitWindow(std::chrono::microseconds window) {
+    std::lock_guard<std::mutex> lock(mutex);
+    commitWindow = window;
+  }
+
+  std::chrono::microseconds getCommitWindow() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return commitWindow;
+  }
+
+  /**
+   * Parses a sync mode name ("off", "batch" or "full", any case).
+   *
+   * @throws std::invalid_argument for unknown names.
+   */
+  static SyncMode stringToSyncMode(std::string name) {
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (name == "off") return SyncMode::OFF;
+    if (name == "batch") return SyncMode::BATCH;
+    if (name == "full") return SyncMode::FULL;
+    throw std::invalid_argument("Unknown sync mode: " + name + " (expected off, batch or full)");
+  }
+
+  static std::string syncModeToString(SyncMode mode) {
+    switch (mode) {
+      case SyncMode::OFF:
+        return "off";
+      case SyncMode::BATCH:
+        return "batch";
+      case SyncMode::FULL:
+        return "full";
+    }
+    return "unknown";
+  }
+
+  // LSN of the most recently appended record, 0 if none was ever written.
+  uint64_t lastLsn() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return nextLsn - 1;
+  }
+
+  // Current size of the log file in bytes, including records not yet flushed.
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return fileSize;
+  }
+
+  // Number of bytes appended since the last reset.
+  size_t pendingBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return fileSize > HEADER_SIZE ? fileSize - HEADER_SIZE : 0;
+  }
+};
+
+#endif
@@ -0,0 +1,190 @@
+#ifndef COST_MODEL_H
+#define COST_MODEL_H
+
+#include "../table.h"
+#include "../table_statistics.h"
+#include "../value.h"
+#include "../indexing/index_manager.h"
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <string>
+
+/*
+===========================================================================
+CostModel Class:
+Chooses between answering a predicate from an index and scanning the
+column, using the statistics collected by ANALYZE.
+
+Costs are in units of testing one row in a sequential column scan (about
+0.3 ns with the SIMD kernels). The constants were measured on a 2M-row
+table: a scan also pays SCAN_MATCH_COST for every row it emits, while an
+index pays a probe plus a per-row cost that depends on the index kind.
+B+tree and bitmap results are cheap to walk; the hash index chains
+duplicate keys, so it is only worth it for few matches. A scan runs on
+every thread of the query pool; an index lookup runs on one.
+
+Without statistics the row estimate is unknown and callers keep using
+an index whenever the column has one.
+
+Joins are costed in the same units, from the sizes of their inputs: a
+hash join pays per build and per probe row, spread over the pool; an
+index nested-loop join pays one index lookup per outer row; a merge join
+walks both B+trees on one thread, or at most seeks once per key of the
+smaller one. Without statistics a lookup is
+taken to find one row, as for a foreign key.
+===========================================================================
+*/
+class CostModel {
+public:
+  static constexpr double SCAN_ROW_COST = 1.0;
+  static constexpr double SCAN_MATCH_COST = 40.0;
+  static constexpr double PREDICATE_ROW_COST = 5.0; // Testing one row against one compiled WHERE leaf
+  static constexpr double RESIDUAL_ROW_COST = 8.0;  // The same for one index candidate, fetched out of order
+  static constexpr double HASH_BUILD_ROW_COST = 250.0; // Partitioning one build row and adding it to a hash table
+  static constexpr double HASH_PROBE_ROW_COST = 80.0;  // Looking one probe row up in the hash tables
+  static constexpr double JOIN_LOOKUP_COST = 500.0;    // One index nested-loop lookup beyond indexCost: key, cache misses, pairs
+  static constexpr double MERGE_ROW_COST = 50.0;       // Stepping a merge join over one B+tree row
+  static constexpr double MERGE_SEEK_COST = 1000.0;    // A merge join seeking past a gap from the root
+
+  static double indexProbeCost(IndexKind kind) {
+    switch (kind) {
+      case IndexKind::HASH:   return 30.0;
+      case IndexKind::BITMAP: return 100.0;
+      default:                return 200.0;
+    }
+  }
+
+  static double indexRowCost(IndexKind kind) {
+    switch (kind) {
+      case IndexKind::HASH:   return 100.0;
+      case IndexKind::BITMAP: return 30.0;
+      default:                return 35.0;
+    }
+  }
+
+  /**
+   * Estimates the rows equal to value in one column.
+   *
+   * @return Estimated row count, or nullopt if the table has not been analyzed.
+   */
+  static std::optional<double> estimateEquals(const Table& table, size_t column, const Value& value) {
+    const TableStatistics* stats = table.getStatistics();
+    if (!stats) return std::nullopt;
+    return stats->columns[column].equalsFraction(value) * static_cast<double>(table.getRowCount());
+  }
+
+  /**
+   * Estimates the rows of one column inside range.
+   *
+   * @return Estimated row count, or nullopt if the table has not been analyzed.
+   */
+  static std::optional<double> estimateRange(const Table& table, size_t column, const ValueRange& range) {
+    const TableStatistics* stats = table.getStatistics();
+    if (!stats) return std::nullopt;
+    return stats->columns[column].rangeFraction(range) * static_cast<double>(table.getRowCount());
+  }
+
+  // Cost of scanning rowCount rows in morsels on pool and emitting matches of them.
+  static double scanCost(size_t rowCount, double matches, ThreadPool* pool) {
+    const size_t threads = pool ? pool->size() : 1;
+    return static_cast<double>(rowCount) * SCAN_ROW_COST / static_cast<double>(threads) + matches * SCAN_MATCH_COST;
+  }
+
+  // Cost of running a compiled WHERE with leaves leaves over rowCount rows on pool.
+  static double expressionScanCost(size_t rowCount, size_t leaves, double matches, ThreadPool* pool) {
+    const size_t threads = pool ? pool->size() : 1;
+    return static_cast<double>(rowCount * leaves) * PREDICATE_ROW_COST / static_cast<double>(threads) +
+           matches * SCAN_MATCH_COST;
+  }
+
+  // Cost of probes lookups in an index of kind returning matches rows in total.
+  static double indexCost(IndexKind kind, double matches, size_t probes = 1) {
+    return static_cast<double>(probes) * indexProbeCost(kind) + matches * indexRowCost(kind);
+  }
+
+  /**
+   * Estimates the rows an equality join finds in one table for a number of
+   * lookups: rows per distinct value of the join column, or one without
+   * statistics.
+   *
+   * @return Estimated matching rows in total.
+   */
+  static double estimateJoinMatches(const Table& table, size_t column, size_t lookups) {
+    const TableStatistics* stats = table.getStatistics();
+    double perLookup = 1.0;
+    if (stats && stats->columns[column].distinctCount > 0) {
+      perLookup = static_cast<double>(table.getRowCount()) / static_cast<double>(stats->columns[column].distinctCount);
+    }
+    return perLookup * static_cast<double>(lookups);
+  }
+
+  // Cost of hash joining buildRows rows against probeRows rows on pool.
+  static double hashJoinCost(size_t buildRows, size_t probeRows, ThreadPool* pool) {
+    const size_t threads = pool ? pool->size() : 1;
+    return (static_cast<double>(buildRows) * HASH_BUILD_ROW_COST + static_cast<double>(probeRows) * HASH_PROBE_ROW_COST) /
+           static_cast<double>(threads);
+  }
+
+  // Cost of one lookup per outer row in an index of kind, returning matches rows in total, on pool.
+  static double indexJoinCost(IndexKind kind, size_t outerRows, double matches, ThreadPool* pool) {
+    const size_t threads = pool ? pool->size() : 1;
+    return (static_cast<double>(outerRows) * JOIN_LOOKUP_COST + indexCost(kind, matches, outerRows)) /
+           static_cast<double>(threads);
+  }
+
+  // Cost of merging two B+trees holding leftRows and rightRows rows.
+  static double mergeJoinCost(size_t leftRows, size_t rightRows) {
+    return std::min(static_cast<double>(leftRows + rightRows) * MERGE_ROW_COST,
+                    static_cast<double>(std::min(leftRows, rightRows)) * MERGE_SEEK_COST);
+  }
+
+  /**
+   * Picks the cheapest index on a column for equality lookups, provided it
+   * costs less than the alternative.
+   *
+   * @param table Table to search.
+   * @param column Position of the column.
+   * @param matches Estimated matching rows, or nullopt without statistics.
+   * @param probes Number of lookups (one per IN value).
+   * @param budget Cost of answering the predicate without an index.
+   * @return The index to use, or nullptr to do without. Without statistics,
+   *         the column's preferred index (hash, then bitmap, then B+tree).
+   *
+   * @example
+   * std::optional<double> matches = CostModel::estimateEquals(table, 2, Value(true));
+   * const IndexDefinition* index = CostModel::chooseEqualityIndex(
+   *     table, 2, matches, 1, CostModel::scanCost(table.getRowCount(), matches.value_or(0), pool));
+   */
+  static const IndexDefinition* chooseEqualityIndex(const Table& table, size_t column, std::optional<double> matches,
+                                                    size_t probes, double budget) {
+    const std::string& name = table.getColumn(column).getName();
+    if (!matches) return table.findIndexForColumn(name);
+    const IndexDefinition* best = nullptr;
+    for (const IndexDefinition& def : table.getIndexDefinitions()) {
+      if (def.column != name) continue;
+      const double cost = indexCost(def.kind, *matches, probes);
+      if (cost < budget) {
+        best = &def;
+        budget = cost;
+      }
+    }
+    return best;
+  }
+
+  /**
+   * Decides whether a column's B+tree should answer a range predicate.
+   *
+   * @param matches Estimated matching rows, or nullopt without statistics.
+   * @param budget Cost of answering the predicate without an index.
+   * @return The B+tree to use, or nullptr to do without.
+   */
+  static const IndexDefinition* chooseRangeIndex(const Table& table, size_t column, std::optional<double> matches,
+                                                 double budget) {
+    const IndexDefinition* index = table.findIndexForColumn(table.getColumn(column).getName(), /*ordered=*/true);
+    if (!index || !matches) return index;
+    return indexCost(index->kind, *matches) < budget ? index : nullptr;
+  }
+};
+
+#endif
@@ -0,0 +1,445 @@
+#ifndef HASH_AGGREGATE_H
+#define HASH_AGGREGATE_H
+
+#include "../table.h"
+#include "../column.h"
+#include "../value.h"
+#include "../concurrency/morsel_scan.h"
+#include "../concurrency/thread_pool.h"
+#include "statement_plan.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+===========================================================================
+Aggregation input:
+The rows an aggregation reads from one table. A join aggregates the
+matching pairs, so it has one source per side, read in step: position i
+of both sources is one match.
+===========================================================================
+*/
+struct AggregateSource {
+  const Table* table = nullptr;
+  const std::vector<size_t>* rows = nullptr; // nullptr = every row of the table
+
+  size_t rowAt(size_t i) const { return rows ? (*rows)[i] : i; }
+};
+
+/*
+===========================================================================
+HashAggregate Class:
+GROUP BY and the aggregates COUNT, COUNT(DISTINCT), SUM, MIN, MAX and AVG.
+
+Each GROUP BY column is read as one 32-bit word per row (INT value, BOOL
+0/1, STRING dictionary code), so every group key has the same number of
+words. Groups are numbered as they are found and kept in an open-addressing
+table with linear probing: a slot packs the group number with the high half
+of its hash, so most mismatches are rejected without touching the key, and
+the keys and aggregate states sit in flat arrays indexed by group number.
+Rows are taken BATCH_ROWS at a time: the batch's group numbers are looked
+up first, then each aggregate folds its column over the batch in one loop.
+
+Each task of the query pool claims morsels and aggregates them into a
+table of its own, so no row is ever aggregated under a lock; the task
+tables are merged at the end, one step per group rather than per row.
+COUNT(DISTINCT) records the (group, value) pairs it has seen in a hash set,
+which is merged the same way and counted last.
+
+MIN and MAX compare STRING values by rank: the column's dictionary is
+sorted once and each code is replaced by its position in that order. SUM
+and AVG add up in 64 bits, but their result is an INT like the column
+(AVG rounds toward zero), and a SUM that does not fit one is an error.
+Without GROUP BY there is exactly one group, even over no rows: COUNT is
+then 0 and the other aggregates are NULL.
+===========================================================================
+*/
+class HashAggregate {
+public:
+  static constexpr size_t BATCH_ROWS = 1024;
+
+private:
+  static constexpr uint64_t EMPTY = UINT64_MAX;
+
+  static uint64_t mix(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    return key;
+  }
+
+  static uint64_t hashKey(const uint32_t* key, size_t width) {
+    uint64_t h = 0x9E3779B97F4A7C15ull;
+    for (size_t i = 0; i < width; ++i) h = mix(h ^ key[i]);
+    return h;
+  }
+
+  // A column read as integers: INT values, BOOL 0/1 and STRING codes, or
+  // the rank of each code when ranks is set.
+  struct ColumnReader {
+    const Column* column = nullptr;
+    uint8_t side = 0;
+    const int* ints = nullptr;
+    const uint8_t* bools = nullptr;
+    const uint32_t* codes = nullptr;
+    std::vector<uint32_t> ranks; // Code -> rank in string order (MIN/MAX of STRING)
+    std::vector<uint32_t> order; // Rank -> code
+
+    ColumnReader() = default;
+    ColumnReader(const Table& table, size_t index, uint8_t side, bool ranked) : column(&table.getColumn(index)), side(side) {
+      switch (column->getType()) {
+        case Value::INT:
+          ints = column->getIntValues().data();
+          break;
+        case Value::BOOL:
+          bools = column->getBoolValues().data();
+          break;
+        case Value::STRING: {
+          codes = column->getStringCodes().data();
+          if (!ranked) break;
+          const StringDictionary& dictionary = column->getDictionary();
+          order.resize(dictionary.size());
+          for (uint32_t code = 0; code < order.size(); ++code) order[code] = code;
+          std::sort(order.begin(), order.end(),
+                    [&](uint32_t a, uint32_t b) { return dictionary.decode(a) < dictionary.decode(b); });
+          ranks.resize(order.size());
+          for (uint32_t rank = 0; rank < order.size(); ++rank) ranks[order[rank]] = rank;
+          break;
+        }
+        default:
+          throw std::invalid_argument("Unsupported column type for aggregation: " + column->getName());
+      }
+    }
+
+    int64_t get(size_t row) const {
+      if (ints) return ints[row];
+      if (bools) return bools[row];
+      return ranks.empty() ? codes[row] : ranks[codes[row]];
+    }
+
+    // Inverse of get, as a value of the column.
+    Value decode(int64_t key) const {
+      switch (column->getType()) {
+        case Value::INT:
+          return Value(static_cast<int>(key));
+        case Value::BOOL:
+          return Value(key != 0);
+        default: {
+          const uint32_t code = ranks.empty() ? static_cast<uint32_t>(key) : order[static_cast<size_t>(key)];
+          return Value(std::string_view(column->getDictionary().decode(code)));
+        }
+      }
+    }
+  };
+
+  // Open-addressing set of 64-bit keys (a group number and a value, for COUNT(DISTINCT)).
+  struct DistinctSet {
+    std::vector<uint64_t> slots;
+    size_t count = 0;
+
+    void insert(uint64_t key) {
+      if ((count + 1) * 2 > slots.size()) grow();
+      const size_t mask = slots.size() - 1;
+      for (size_t i = mix(key) & mask;; i = (i + 1) & mask) {
+        if (slots[i] == key) return;
+        if (slots[i] == EMPTY) {
+          slots[i] = key;
+          ++count;
+          return;
+        }
+      }
+    }
+
+    void grow() {
+      std::vector<uint64_t> old(std::max<size_t>(16, slots.size() * 2), EMPTY);
+      old.swap(slots);
+      count = 0;
+      for (uint64_t key : old) {
+        if (key != EMPTY) insert(key);
+      }
+    }
+  };
+
+  // The groups one task has found and their aggregate states.
+  struct Partial {
+    std::vector<uint32_t> keys;               // width words per group
+    std::vector<uint64_t> slots;              // EMPTY, or hash high half << 32 | group
+    std::vector<int64_t> counts;              // Rows per group
+    std::vector<std::vector<int64_t>> states; // Per aggregate: SUM/AVG sum, MIN/MAX extreme; 0 for COUNT
+    std::vector<DistinctSet> distinct;        // Per aggregate; COUNT(DISTINCT) only
+
+    size_t groupCount() const { return counts.size(); }
+  };
+
+  const std::vector<Aggregate>& aggregates;
+  const size_t width; // GROUP BY columns
+  std::vector<ColumnReader> groupReaders;
+  std::vector<ColumnReader> aggregateReaders; // Empty for a COUNT that reads no column
+  std::vector<uint8_t> sidesRead;             // Whether each source is read at all
+
+  static int64_t initialState(const Aggregate& aggregate) {
+    switch (aggregate.function) {
+      case Aggregate::Function::MIN:
+        return std::numeric_limits<int64_t>::max();
+      case Aggregate::Function::MAX:
+        return std::numeric_limits<int64_t>::min();
+      default:
+        return 0;
+    }
+  }
+
+  void rehash(Partial& partial) const {
+    partial.slots.assign(std::max<size_t>(16, partial.slots.size() * 2), EMPTY);
+    const size_t mask = partial.slots.size() - 1;
+    for (size_t group = 0; group < partial.groupCount(); ++group) {
+      const uint64_t h = hashKey(partial.keys.data() + group * width, width);
+      size_t i = h & mask;
+      while (partial.slots[i] != EMPTY) i = (i + 1) & mask;
+      partial.slots[i] = (h >> 32 << 32) | group;
+    }
+  }
+
+  // The number of key's group in partial, which is created if it is new; h is hashKey(key).
+  uint32_t findOrInsert(Partial& partial, const uint32_t* key, uint64_t h) const {
+    if ((partial.groupCount() + 1) * 2 > partial.slots.size()) rehash(partial);
+    const uint64_t tag = h >> 32 << 32;
+    const size_t mask = partial.slots.size() - 1;
+    for (size_t i = h & mask;; i = (i + 1) & mask) {
+      const uint64_t slot = partial.slots[i];
+      if (slot == EMPTY) {
+        const uint32_t group = static_cast<uint32_t>(partial.groupCount());
+        partial.slots[i] = tag | group;
+        partial.keys.insert(partial.keys.end(), key, key + width);
+        partial.counts.push_back(0);
+        for (size_t a = 0; a < aggregates.size(); ++a) partial.states[a].push_back(initialState(aggregates[a]));
+        return group;
+      }
+      if ((slot & ~uint64_t(UINT32_MAX)) == tag &&
+          std::equal(key, key + width, partial.keys.begin() + (slot & UINT32_MAX) * width)) {
+        return static_cast<uint32_t>(slot & UINT32_MAX);
+      }
+    }
+  }
+
+  Partial newPartial() const {
+    Partial partial;
+    partial.states.resize(aggregates.size());
+    partial.distinct.resize(aggregates.size());
+    if (width == 0) findOrInsert(partial, nullptr, hashKey(nullptr, 0)); // The one group
+    return partial;
+  }
+
+  // Aggregates input positions [begin, end) into partial.
+  void aggregate(const AggregateSource sources[2], size_t begin, size_t end, Partial& partial) const {
+    std::vector<size_t> rows[2];
+    std::vector<uint32_t> groups(BATCH_ROWS, 0);
+    std::vector<uint32_t> keys(BATCH_ROWS * width);
+    std::vector<uint64_t> hashes(BATCH_ROWS);
+    for (size_t first = begin; first < end; first += BATCH_ROWS) {
+      const size_t count = std::min(BATCH_ROWS, end - first);
+      for (uint8_t side = 0; side < 2; ++side) {
+        if (!sidesRead[side]) continue;
+        rows[side].resize(count);
+        for (size_t i = 0; i < count; ++i) rows[side][i] = sources[side].rowAt(first + i);
+      }
+
+      if (width == 0) {
+        partial.counts[0] += static_cast<int64_t>(count);
+      } else {
+        // Keys a column at a time, then all hashes, then the probes.
+        for (size_t k = 0; k < width; ++k) {
+          const ColumnReader& reader = groupReaders[k];
+          const std::vector<size_t>& at = rows[reader.side];
+          for (size_t i = 0; i < count; ++i) keys[i * width + k] = static_cast<uint32_t>(reader.get(at[i]));
+        }
+        for (size_t i = 0; i < count; ++i) hashes[i] = hashKey(&keys[i * width], width);
+        for (size_t i = 0; i < count; ++i) {
+          groups[i] = findOrInsert(partial, &keys[i * width], hashes[i]);
+          ++partial.counts[groups[i]];
+        }
+      }
+
+      for (size_t a = 0; a < aggregates.size(); ++a) {
+        const Aggregate& agg = aggregates[a];
+        if (agg.function == Aggregate::Function::COUNT && !agg.distinct) continue;
+        const ColumnReader& reader = aggregateReaders[a];
+        const std::vector<size_t>& at = rows[reader.side];
+        std::vector<int64_t>& state = partial.states[a];
+        switch (agg.function) {
+          case Aggregate::Function::COUNT:
+            for (size_t i = 0; i < count; ++i) {
+              partial.distinct[a].insert(uint64_t(groups[i]) << 32 | static_cast<uint32_t>(reader.get(at[i])));
+            }
+            break;
+          case Aggregate::Function::MIN:
+            for (size_t i = 0; i < count; ++i) state[groups[i]] = std::min(state[groups[i]], reader.get(at[i]));
+            break;
+          case Aggregate::Function::MAX:
+            for (size_t i = 0; i < count; ++i) state[groups[i]] = std::max(state[groups[i]], reader.get(at[i]));
+            break;
+          default: // SUM, AVG
+            for (size_t i = 0; i < count; ++i) state[groups[i]] += reader.get(at[i]);
+            break;
+        }
+      }
+    }
+  }
+
+  // Folds the groups of from into into.
+  void merge(Partial& into, const Partial& from) const {
+    std::vector<uint32_t> target(from.groupCount());
+    for (size_t group = 0; group < from.groupCount(); ++group) {
+      const uint32_t* key = from.keys.data() + group * width;
+      const uint32_t to = target[group] = findOrInsert(into, key, hashKey(key, width));
+      into.counts[to] += from.counts[group];
+      for (size_t a = 0; a < aggregates.size(); ++a) {
+        int64_t& state = into.states[a][to];
+        const int64_t other = from.states[a][group];
+        switch (aggregates[a].function) {
+          case Aggregate::Function::MIN:
+            state = std::min(state, other);
+            break;
+          case Aggregate::Function::MAX:
+            state = std::max(state, other);
+            break;
+          default:
+            state += other;
+            break;
+        }
+      }
+    }
+    for (size_t a = 0; a < aggregates.size(); ++a) {
+      for (uint64_t key : from.distinct[a].slots) {
+        if (key != EMPTY) into.distinct[a].insert(uint64_t(target[key >> 32]) << 32 | (key & UINT32_MAX));
+      }
+    }
+  }
+
+  static Value toInt(int64_t value, const Aggregate& aggregate, const char* function) {
+    if (value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max()) {
+      throw std::overflow_error(std::string(function) + "(" + (aggregate.star ? "*" : aggregate.column) +
+                                ") does not fit an INT");
+    }
+    return Value(static_cast<int>(value));
+  }
+
+  HashAggregate(const SelectPlan& plan, const AggregateSource sources[2])
+      : aggregates(plan.aggregates), width(plan.groupIndices.size()), sidesRead(2, 0) {
+    for (size_t k = 0; k < width; ++k) {
+      const uint8_t side = plan.groupSides.empty() ? 0 : plan.groupSides[k];
+      groupReaders.emplace_back(*sources[side].table, plan.groupIndices[k], side, false);
+      sidesRead[side] = 1;
+    }
+    for (const Aggregate& agg : aggregates) {
+      if (agg.function == Aggregate::Function::COUNT && !agg.distinct) {
+        aggregateReaders.emplace_back(); // Columns hold no NULLs: COUNT(column) counts rows as COUNT(*) does
+        continue;
+      }
+      const bool ranked = agg.function == Aggregate::Function::MIN || agg.function == Aggregate::Function::MAX;
+      aggregateReaders.emplace_back(*sources[agg.side].table, agg.columnIndex, agg.side, ranked);
+      if ((agg.function == Aggregate::Function::SUM || agg.function == Aggregate::Function::AVG) &&
+          aggregateReaders.back().column->getType() != Value::INT) {
+        throw std::invalid_argument("SUM and AVG need an INT column: " + agg.column);
+      }
+      sidesRead[agg.side] = 1;
+    }
+  }
+
+public:
+  /**
+   * Groups the input by the plan's GROUP BY columns and computes its
+   * aggregates for each group.
+   *
+   * @param plan Aggregated plan (SelectPlan::aggregated) with resolved columns.
+   * @param sources The FROM table's rows and, for a join, the joined table's matching rows.
+   * @param count Number of input rows (of matches, for a join).
+   * @param pool Query pool; nullptr runs serially.
+   * @return One vector per output column of the plan, one value per group, groups in no particular order.
+   * @throws std::invalid_argument if SUM or AVG is applied to a column that is not INT.
+   * @throws std::overflow_error if a COUNT or SUM does not fit an INT.
+   *
+   * @example
+   * AggregateSource sources[2] = {{&orders, nullptr}, {}};
+   * std::vector<std::vector<Value>> columns = HashAggregate::run(plan, sources, orders.getRowCount(), pool);
+   */
+  static std::vector<std::vector<Value>> run(const SelectPlan& plan, const AggregateSource sources[2], size_t count,
+                                             ThreadPool* pool) {
+    const HashAggregate aggregation(plan, sources);
+    const size_t morsels = MorselScan::morselCount(count);
+    const size_t tasks = pool && morsels > 1 ? std::min(pool->size(), morsels) : 1;
+    std::vector<Partial> partials;
+    for (size_t t = 0; t < tasks; ++t) partials.push_back(aggregation.newPartial());
+    if (tasks == 1) {
+      aggregation.aggregate(sources, 0, count, partials[0]);
+    } else {
+      std::atomic<size_t> nextMorsel{0};
+      pool->parallelFor(tasks, [&](size_t t) {
+        for (size_t m = nextMorsel++; m < morsels; m = nextMorsel++) {
+          const size_t begin = m * MorselScan::MORSEL_ROWS;
+          aggregation.aggregate(sources, begin, std::min(count, begin + MorselScan::MORSEL_ROWS), partials[t]);
+        }
+      });
+    }
+    Partial& result = partials[0];
+    for (size_t t = 1; t < tasks; ++t) {
+      aggregation.merge(result, partials[t]);
+      partials[t] = Partial();
+    }
+    return aggregation.finish(plan, result);
+  }
+
+private:
+  std::vector<std::vector<Value>> finish(const SelectPlan& plan, const Partial& result) const {
+    const size_t groups = result.groupCount();
+    std::vector<std::vector<int64_t>> distinctCounts(aggregates.size());
+    for (size_t a = 0; a < aggregates.size(); ++a) {
+      if (!aggregates[a].distinct) continue;
+      distinctCounts[a].assign(groups, 0);
+      for (uint64_t key : result.distinct[a].slots) {
+        if (key != EMPTY) ++distinctCounts[a][key >> 32];
+      }
+    }
+
+    std::vector<std::vector<Value>> columns(plan.outputs.size());
+    for (size_t c = 0; c < plan.outputs.size(); ++c) {
+      std::vector<Value>& column = columns[c];
+      column.reserve(groups);
+      const size_t output = plan.outputs[c];
+      if (output < width) {
+        for (size_t group = 0; group < groups; ++group) {
+          column.push_back(groupReaders[output].decode(static_cast<int32_t>(result.keys[group * width + output])));
+        }
+        continue;
+      }
+      const size_t a = output - width;
+      const Aggregate& agg = aggregates[a];
+      for (size_t group = 0; group < groups; ++group) {
+        const int64_t rows = result.counts[group];
+        const int64_t state = result.states[a][group];
+        switch (agg.function) {
+          case Aggregate::Function::COUNT:
+            column.push_back(toInt(agg.distinct ? distinctCounts[a][group] : rows, agg, "COUNT"));
+            break;
+          case Aggregate::Function::SUM:
+            column.push_back(rows == 0 ? Value() : toInt(state, agg, "SUM"));
+            break;
+          case Aggregate::Function::AVG:
+            column.push_back(rows == 0 ? Value() : Value(static_cast<int>(state / rows)));
+            break;
+          default: // MIN, MAX
+            column.push_back(rows == 0 ? Value() : aggregateReaders[a].decode(state));
+            break;
+        }
+      }
+    }
+    return columns;
+  }
+};
+
+#endif
@@ -0,0 +1,432 @@
+#ifndef HASH_JOIN_H
+#define HASH_JOIN_H
+
+#include "../concurrency/thread_pool.h"
+#include "join_keys.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+/*
+===========================================================================
+HashJoin Class:
+In-memory equi-join of two JoinSides. The side with fewer rows is the
+build side; the other is probed against it.
+
+The build side is radix partitioned on the top bits of the key hash, in
+two passes over fixed slices of the input (count per slice and partition,
+then scatter), so partitioning is parallel and its output does not depend
+on the thread count. Partitions hold about PARTITION_ENTRIES build keys
+and get their own hash table, built in parallel on the query pool.
+
+While all the tables fit in CACHED_BUILD_BYTES, the probe side is read in
+place: slices of its rows are probed in parallel against the table of each
+key's partition and the results are concatenated in probe order. Beyond
+that, lookups would miss the cache, so the probe side is partitioned the
+same way and each partition is probed against its own, cache-sized, table;
+results then come in partition order. Copying the probe side costs a pass
+over fresh memory, which only pays off once the lookups it localizes are
+cache misses.
+
+When the hash tables and partitions would need more than the memory
+limit, the join spills (a Grace hash join): both sides are written to one
+temporary file per partition, and the partitions are joined one at a
+time, the build partition in memory and the probe partition streamed
+through in chunks. The limit covers the join's working memory, not the
+result, which is a pair of row numbers per match.
+===========================================================================
+*/
+class HashJoin {
+public:
+  static constexpr size_t PARTITION_ENTRIES = 32 * 1024; // Build keys per in-memory partition
+  static constexpr size_t MAX_PARTITION_BITS = 12;
+  static constexpr size_t CACHED_BUILD_BYTES = 16 << 20; // Larger build sides partition the probe side too
+
+  // How a join ran.
+  struct Stats {
+    bool buildLeft = false;
+    size_t partitions = 0;
+    bool spilled = false;
+  };
+
+private:
+  struct Entry {
+    uint64_t key;
+    uint64_t row;
+  };
+
+  static uint64_t hash(uint64_t key) {
+    key *= 0x9E3779B97F4A7C15ull;
+    return key ^ (key >> 29);
+  }
+
+  static size_t partitionOfHash(uint64_t hashed, size_t bits) {
+    return bits == 0 ? 0 : static_cast<size_t>(hashed >> (64 - bits));
+  }
+
+  static size_t partitionOf(uint64_t key, size_t bits) { return partitionOfHash(hash(key), bits); }
+
+  static size_t threadsOf(ThreadPool* pool) { return pool ? pool->size() : 1; }
+
+  // Input slices for parallel work over rows: none beyond one per thread
+  // when serial, several per thread otherwise so uneven slices balance out.
+  static size_t slicesFor(size_t rows, ThreadPool* pool) {
+    const size_t threads = threadsOf(pool);
+    if (threads == 1) return 1;
+    return std::max<size_t>(1, std::min(threads * 4, rows / 4096));
+  }
+
+  static void runTasks(ThreadPool* pool, size_t count, const std::function<void(size_t)>& task) {
+    if (pool) {
+      pool->parallelFor(count, task);
+    } else {
+      for (size_t i = 0; i < count; ++i) task(i);
+    }
+  }
+
+  static size_t bitsFor(size_t partitions) {
+    size_t bits = 0;
+    while ((size_t(1) << bits) < partitions && bits < MAX_PARTITION_BITS) ++bits;
+    return bits;
+  }
+
+  // Hash table over one partition's build entries, stored bucket by bucket:
+  // a lookup reads the bucket's bounds and then its entries, which lie
+  // together, so it touches about two cache lines. Entries of a bucket keep
+  // their input order.
+  class PartitionTable {
+  private:
+    std::vector<Entry> entries;
+    std::vector<uint32_t> bounds{0, 0}; // Bucket b holds entries [bounds[b], bounds[b + 1])
+    uint64_t mask = 0;
+
+  public:
+    PartitionTable() = default;
+
+    PartitionTable(const Entry* input, size_t count) : entries(count) {
+      size_t buckets = 1;
+      while (buckets < count) buckets <<= 1;
+      mask = buckets - 1;
+      bounds.assign(buckets + 1, 0);
+      for (size_t i = 0; i < count; ++i) ++bounds[(hash(input[i].key) & mask) + 1];
+      for (size_t b = 0; b < buckets; ++b) bounds[b + 1] += bounds[b];
+      std::vector<uint32_t> cursor(bounds.begin(), bounds.end() - 1);
+      for (size_t i = 0; i < count; ++i) entries[cursor[hash(input[i].key) & mask]++] = input[i];
+    }
+
+    // Appends the matches of a key, given its hash, to out as (left, right).
+    void probe(uint64_t key, uint64_t hashed, uint64_t probeRow, bool buildLeft, JoinPairs& out) const {
+      const uint64_t bucket = hashed & mask;
+      for (uint32_t i = bounds[bucket], end = bounds[bucket + 1]; i < end; ++i) {
+        if (entries[i].key != key) continue;
+        out.left.push_back(buildLeft ? entries[i].row : probeRow);
+        out.right.push_back(buildLeft ? probeRow : entries[i].row);
+      }
+    }
+  };
+
+  // Probes entries [begin, end) and appends the matches to out.
+  static void probeRange(const PartitionTable& table, const Entry* probe, size_t begin, size_t end, bool buildLeft,
+                         JoinPairs& out) {
+    // Most joins match each probe row about once (a foreign key); reserving
+    // that much skips the regrowth copies.
+    out.left.reserve(out.left.size() + end - begin);
+    out.right.reserve(out.right.size() + end - begin);
+    for (size_t i = begin; i < end; ++i) {
+      table.probe(probe[i].key, hash(probe[i].key), probe[i].row, buildLeft, out);
+    }
+  }
+
+  static void append(JoinPairs& to, const JoinPairs& from) {
+    to.left.insert(to.left.end(), from.left.begin(), from.left.end());
+    to.right.insert(to.right.end(), from.right.begin(), from.right.end());
+  }
+
+  static JoinPairs concatenate(std::vector<JoinPairs>& results) {
+    if (results.size() == 1) return std::move(results[0]);
+    JoinPairs pairs;
+    size_t total = 0;
+    for (const JoinPairs& result : results) total += result.size();
+    pairs.left.reserve(total);
+    pairs.right.reserve(total);
+    for (JoinPairs& result : results) {
+      append(pairs, result);
+      result = JoinPairs();
+    }
+    return pairs;
+  }
+
+  /**
+   * Radix partitions a side's keys: out receives the (key, row) entries
+   * grouped by partition, in input order within a partition, and
+   * offsets[p] .. offsets[p + 1] delimits partition p. Rows without a key
+   * are left out.
+   */
+  static void partition(const JoinSide& side, const JoinKeys& keys, size_t bits, ThreadPool* pool,
+                        std::vector<Entry>& out, std::vector<size_t>& offsets) {
+    const size_t partitions = size_t(1) << bits;
+    const size_t rows = side.size();
+    const size_t slices = slicesFor(rows, pool);
+    auto sliceBegin = [&](size_t s) { return rows * s / slices; };
+
+    // Pass 1: count each slice's rows per partition.
+    std::vector<size_t> counts(slices * partitions, 0);
+    runTasks(pool, slices, [&](size_t s) {
+      size_t* count = &counts[s * partitions];
+      uint64_t key;
+      for (size_t i = sliceBegin(s); i < sliceBegin(s + 1); ++i) {
+        if (keys.get(side.rowAt(i), key)) ++count[partitionOf(key, bits)];
+      }
+    });
+
+    // Partition-major prefix sums give every slice its own write cursor per partition.
+    offsets.assign(partitions + 1, 0);
+    size_t total = 0;
+    for (size_t p = 0; p < partitions; ++p) {
+      offsets[p] = total;
+      for (size_t s = 0; s < slices; ++s) {
+        const size_t count = counts[s * partitions + p];
+        counts[s * partitions + p] = total;
+        total += count;
+      }
+    }
+    offsets[partitions] = total;
+
+    // Pass 2: scatter.
+    out.resize(total);
+    runTasks(pool, slices, [&](size_t s) {
+      size_t* cursor = &counts[s * partitions];
+      uint64_t key;
+      for (size_t i = sliceBegin(s); i < sliceBegin(s + 1); ++i) {
+        const size_t row = side.rowAt(i);
+        if (keys.get(row, key)) out[cursor[partitionOf(key, bits)]++] = Entry{key, row};
+      }
+    });
+  }
+
+  static JoinPairs joinInMemory(const JoinSide& build, const JoinKeys& buildKeys, const JoinSide& probe,
+                                const JoinKeys& probeKeys, bool buildLeft, ThreadPool* pool, Stats& stats) {
+    const bool partitionProbe = buildBytes(build.size()) > CACHED_BUILD_BYTES;
+    size_t wanted = (build.size() + PARTITION_ENTRIES - 1) / PARTITION_ENTRIES;
+    if (partitionProbe) wanted = std::max(wanted, threadsOf(pool) * 4);
+    const size_t bits = bitsFor(wanted);
+    const size_t partitions = size_t(1) << bits;
+    stats.partitions = partitions;
+
+    std::vector<Entry> buildEntries;
+    std::vector<size_t> buildOffsets;
+    partition(build, buildKeys, bits, pool, buildEntries, buildOffsets);
+    std::vector<PartitionTable> tables(partitions);
+    runTasks(pool, partitions, [&](size_t p) {
+      const size_t count = buildOffsets[p + 1] - buildOffsets[p];
+      if (count > 0) tables[p] = PartitionTable(buildEntries.data() + buildOffsets[p], count);
+    });
+
+    if (!partitionProbe) {
+      const size_t rows = probe.size();
+      const size_t slices = slicesFor(rows, pool);
+      std::vector<JoinPairs> results(slices);
+      runTasks(pool, slices, [&](size_t s) {
+        JoinPairs out;
+        const size_t begin = rows * s / slices, end = rows * (s + 1) / slices;
+        out.left.reserve(end - begin);
+        out.right.reserve(end - begin);
+        uint64_t key;
+        for (size_t i = begin; i < end; ++i) {
+          const size_t row = probe.rowAt(i);
+          if (!probeKeys.get(row, key)) continue;
+          const uint64_t hashed = hash(key);
+          tables[partitionOfHash(hashed, bits)].probe(key, hashed, row, buildLeft, out);
+        }
+        results[s] = std::move(out);
+      });
+      return concatenate(results);
+    }
+
+    std::vector<Entry> probeEntries;
+    std::vector<size_t> probeOffsets;
+    partition(probe, probeKeys, bits, pool, probeEntries, probeOffsets);
+    std::vector<JoinPairs> results(partitions);
+    runTasks(pool, partitions, [&](size_t p) {
+      probeRange(tables[p], probeEntries.data(), probeOffsets[p], probeOffsets[p + 1], buildLeft, results[p]);
+    });
+    return concatenate(results);
+  }
+
+  // One temporary file per partition, removed when the set is destroyed.
+  class SpillFiles {
+  private:
+    std::vector<std::FILE*> files;
+    std::vector<std::string> paths;
+
+  public:
+    SpillFiles(const std::string& directory, const char* side, size_t count) {
+      static std::atomic<uint64_t> sequence{0};
+      std::filesystem::create_directories(directory);
+      const std::string prefix = directory + "/join-" + std::to_string(::getpid()) + "-" +
+                                 std::to_string(sequence++) + "-" + side;
+      for (size_t p = 0; p < count; ++p) {
+        paths.push_back(prefix + std::to_string(p) + ".tmp");
+        files.push_back(std::fopen(paths.back().c_str(), "w+b"));
+        if (!files.back()) {
+          throw std::runtime_error("Join spill failed: cannot create " + paths.back());
+        }
+      }
+    }
+
+    ~SpillFiles() {
+      for (size_t p = 0; p < files.size(); ++p) {
+        if (files[p]) std::fclose(files[p]);
+        std::remove(paths[p].c_str());
+      }
+    }
+
+    SpillFiles(const SpillFiles&) = delete;
+    SpillFiles& operator=(const SpillFiles&) = delete;
+
+    void write(size_t p, const Entry* entries, size_t count) {
+      if (count && std::fwrite(entries, sizeof(Entry), count, files[p]) != count) {
+        throw std::runtime_error("Join spill failed: cannot write " + paths[p]);
+      }
+    }
+
+    // Rewinds partition p for reading.
+    void rewind(size_t p) {
+      if (std::fflush(files[p]) != 0 || std::fseek(files[p], 0, SEEK_SET) != 0) {
+        throw std::runtime_error("Join spill failed: cannot read " + paths[p]);
+      }
+    }
+
+    // Reads up to capacity entries of partition p; returns how many were read.
+    size_t read(size_t p, Entry* entries, size_t capacity) {
+      const size_t count = std::fread(entries, sizeof(Entry), capacity, files[p]);
+      if (count < capacity && std::ferror(files[p])) {
+        throw std::runtime_error("Join spill failed: cannot read " + paths[p]);
+      }
+      return count;
+    }
+  };
+
+  // Writes a side's entries to the partition files through one buffer per partition.
+  static void spill(const JoinSide& side, const JoinKeys& keys, size_t bits, size_t bufferEntries, SpillFiles& files) {
+    const size_t partitions = size_t(1) << bits;
+    std::vector<std::vector<Entry>> buffers(partitions);
+    uint64_t key;
+    for (size_t i = 0; i < side.size(); ++i) {
+      const size_t row = side.rowAt(i);
+      if (!keys.get(row, key)) continue;
+      const size_t p = partitionOf(key, bits);
+      std::vector<Entry>& buffer = buffers[p];
+      buffer.push_back(Entry{key, row});
+      if (buffer.size() == bufferEntries) {
+        files.write(p, buffer.data(), buffer.size());
+        buffer.clear();
+      }
+    }
+    for (size_t p = 0; p < partitions; ++p) {
+      files.write(p, buffers[p].data(), buffers[p].size());
+    }
+  }
+
+  static JoinPairs joinSpilled(const JoinSide& build, const JoinKeys& buildKeys, const JoinSide& probe,
+                               const JoinKeys& probeKeys, bool buildLeft, ThreadPool* pool, size_t memoryLimit,
+                               const std::string& spillDirectory, Stats& stats) {
+    // Each build partition, with its table, should take at most half the limit.
+    const size_t half = std::max<size_t>(1, memoryLimit / 2);
+    const size_t bits = std::max<size_t>(1, bitsFor((buildBytes(build.size()) + half - 1) / half));
+    const size_t partitions = size_t(1) << bits;
+    stats.partitions = partitions;
+    stats.spilled = true;
+
+    // Write buffers and the probe chunk share the other half.
+    const size_t bufferEntries = std::clamp<size_t>(half / 2 / partitions / sizeof(Entry), 64, 4096);
+    const size_t chunkEntries = std::clamp<size_t>(half / 2 / sizeof(Entry), 4096, 1 << 20);
+
+    SpillFiles buildFiles(spillDirectory, "b", partitions);
+    SpillFiles probeFiles(spillDirectory, "p", partitions);
+    spill(build, buildKeys, bits, bufferEntries, buildFiles);
+    spill(probe, probeKeys, bits, bufferEntries, probeFiles);
+
+    JoinPairs pairs;
+    std::vector<Entry> buildEntries;
+    std::vector<Entry> chunk(chunkEntries);
+    const size_t slices = threadsOf(pool) == 1 ? 1 : threadsOf(pool) * 4;
+    std::vector<JoinPairs> results(slices);
+    for (size_t p = 0; p < partitions; ++p) {
+      buildFiles.rewind(p);
+      buildEntries.clear();
+      for (size_t n; (n = buildFiles.read(p, chunk.data(), chunk.size())) > 0;) {
+        buildEntries.insert(buildEntries.end(), chunk.begin(), chunk.begin() + n);
+      }
+      if (buildEntries.empty()) continue;
+      const PartitionTable table(buildEntries.data(), buildEntries.size());
+
+      probeFiles.rewind(p);
+      for (size_t n; (n = probeFiles.read(p, chunk.data(), chunk.size())) > 0;) {
+        // Split the chunk into slices probed in parallel, appended in order.
+        runTasks(pool, slices, [&](size_t s) {
+          results[s].left.clear();
+          results[s].right.clear();
+          probeRange(table, chunk.data(), n * s / slices, n * (s + 1) / slices, buildLeft, results[s]);
+        });
+        for (const JoinPairs& result : results) append(pairs, result);
+      }
+    }
+    return pairs;
+  }
+
+  // Working memory of an in-memory build side: its partitioned entries, the
+  // tables' copy of them and up to two bucket bounds per entry.
+  static size_t buildBytes(size_t rows) { return rows * (2 * sizeof(Entry) + 2 * sizeof(uint32_t)); }
+
+public:
+  /**
+   * Joins two sides on equal keys.
+   *
+   * @param left The FROM table's side.
+   * @param right The joined table's side.
+   * @param pool Query pool for partitioning and probing; nullptr runs serially.
+   * @param memoryLimit Bytes of working memory before the join spills to disk.
+   * @param spillDirectory Directory for the spill files; created if needed.
+   * @param stats Optional; receives how the join ran.
+   * @return The matching (left row, right row) pairs, in probe side order or,
+   *         for large or spilled joins, grouped by hash partition.
+   * @throws std::invalid_argument if the join columns have different types.
+   * @throws std::runtime_error if spill files cannot be written or read.
+   *
+   * @example
+   * JoinPairs pairs = HashJoin::run(JoinSide{&orders, 1}, JoinSide{&customers, 0}, pool, 64 << 20, "/tmp");
+   */
+  static JoinPairs run(const JoinSide& left, const JoinSide& right, ThreadPool* pool, size_t memoryLimit,
+                       const std::string& spillDirectory, Stats* stats = nullptr) {
+    if (left.keyColumn().getType() != right.keyColumn().getType()) {
+      throw std::invalid_argument("Join columns " + left.keyColumn().getName() + " and " +
+                                  right.keyColumn().getName() + " have different types");
+    }
+    Stats local;
+    Stats& out = stats ? *stats : local;
+    out = Stats();
+    out.buildLeft = left.size() < right.size();
+    const JoinSide& build = out.buildLeft ? left : right;
+    const JoinSide& probe = out.buildLeft ? right : left;
+    // Probe keys are expressed in the build column's STRING codes.
+    const JoinKeys buildKeys(build, build.keyColumn());
+    const JoinKeys probeKeys(probe, build.keyColumn());
+
+    const size_t inMemoryBytes = buildBytes(build.size()) + probe.size() * sizeof(Entry);
+    if (inMemoryBytes > memoryLimit) {
+      return joinSpilled(build, buildKeys, probe, probeKeys, out.buildLeft, pool, memoryLimit, spillDirectory, out);
+    }
+    return joinInMemory(build, buildKeys, probe, probeKeys, out.buildLeft, pool, out);
+  }
+};
+
+#endif
@@ -0,0 +1,261 @@
+#ifndef INDEX_JOIN_H
+#define INDEX_JOIN_H
+
+#include "../table.h"
+#include "../value.h"
+#include "../concurrency/morsel_scan.h"
+#include "../indexing/bplustree.h"
+#include "../indexing/index_manager.h"
+#include "join_keys.h"
+#include "predicate.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+===========================================================================
+IndexJoin Class:
+Equi-joins that read one or both sides through an existing index on the
+join column instead of hashing them.
+
+nestedLoop (index nested-loop join) walks the outer side and looks its
+keys up in an index on the inner table's join column. Outer rows are
+taken in batches of PROBE_BATCH: a batch is sorted by key and its
+distinct keys are looked up together (Table::searchRowsByIndexBatch), so
+each key is looked up once, the index is resolved once per batch and
+successive B+tree lookups descend through the same nodes. The inner
+table's WHERE is tested once per batch on the rows the lookups returned. The inner table is never scanned,
+which is what makes a selective join against a large indexed table cheap.
+Morsels of the outer side run in parallel on the query pool.
+
+merge walks the B+tree indexes of both join columns in key order, side by
+side, and pairs the rows of equal keys. When one side has run ahead by
+more than SEEK_AFTER keys, the other seeks to its key through the tree
+instead of stepping leaf by leaf, so a sparse side skips the gaps of a
+dense one. The walk is serial and its result comes in key order.
+===========================================================================
+*/
+class IndexJoin {
+public:
+  static constexpr size_t PROBE_BATCH = 1024; // Outer rows sorted and probed together
+  static constexpr size_t SEEK_AFTER = 16;    // Unmatched keys stepped over before seeking instead
+
+private:
+  // The key of JoinKeys::get as a Value of the inner column, for an index lookup.
+  static Value keyValue(uint64_t key, const Column& inner) {
+    switch (inner.getType()) {
+      case Value::INT:
+        return Value(static_cast<int>(static_cast<int64_t>(key)));
+      case Value::BOOL:
+        return Value(key != 0);
+      default:
+        return Value(std::string_view(inner.getDictionary().decode(static_cast<uint32_t>(key))));
+    }
+  }
+
+  // Keeps the pairs whose inner row passes filter, in order.
+  static void filterInner(const Predicate& filter, std::vector<size_t>& outerRows, std::vector<size_t>& innerRows,
+                          std::vector<uint8_t>& mask) {
+    mask.resize(innerRows.size());
+    filter.evaluate(innerRows.data(), innerRows.size(), mask.data());
+    size_t kept = 0;
+    for (size_t i = 0; i < innerRows.size(); ++i) {
+      if (!mask[i]) continue;
+      outerRows[kept] = outerRows[i];
+      innerRows[kept++] = innerRows[i];
+    }
+    outerRows.resize(kept);
+    innerRows.resize(kept);
+  }
+
+  // One byte per table row, set for the rows a filtered side keeps; empty for an unfiltered side.
+  static std::vector<uint8_t> membership(const JoinSide& side) {
+    if (!side.rows) return {};
+    std::vector<uint8_t> mask(side.table->getRowCount(), 0);
+    for (size_t row : *side.rows) mask[row] = 1;
+    return mask;
+  }
+
+  // Sets out to the rows of a key that mask keeps (all of them if mask is null).
+  static void keptRows(const std::vector<size_t>& rows, const uint8_t* mask, std::vector<size_t>& out) {
+    out.clear();
+    for (size_t row : rows) {
+      if (!mask || mask[row]) out.push_back(row);
+    }
+  }
+
+  // Moves it to the first key >= target: a few steps along the leaves, then a seek from the root.
+  template<typename Tree, typename Iterator, typename Key>
+  static void advanceTo(const Tree& tree, Iterator& it, const Key& target) {
+    for (size_t step = 0; step < SEEK_AFTER; ++step) {
+      it.next();
+      if (!it.valid() || !(it.key() < target)) return;
+    }
+    it = tree.rangeSearch(KeyBound<Key>{target, true}, std::nullopt);
+  }
+
+  template<typename Tree>
+  static void mergeTrees(const Tree& leftTree, const uint8_t* leftMask, const Tree& rightTree,
+                         const uint8_t* rightMask, JoinPairs& out) {
+    auto l = leftTree.rangeSearch(std::nullopt, std::nullopt);
+    auto r = rightTree.rangeSearch(std::nullopt, std::nullopt);
+    if (!l.valid() || !r.valid()) return;
+    using Key = std::decay_t<decltype(l.key())>;
+    Key leftKey = l.key();
+    Key rightKey = r.key();
+    std::vector<size_t> leftRows, rightRows;
+    while (true) {
+      if (leftKey < rightKey) {
+        advanceTo(leftTree, l, rightKey);
+        if (!l.valid()) return;
+        leftKey = l.key();
+      } else if (rightKey < leftKey) {
+        advanceTo(rightTree, r, leftKey);
+        if (!r.valid()) return;
+        rightKey = r.key();
+      } else {
+        keptRows(l.rows(), leftMask, leftRows);
+        keptRows(r.rows(), rightMask, rightRows);
+        for (size_t leftRow : leftRows) {
+          for (size_t rightRow : rightRows) {
+            out.left.push_back(leftRow);
+            out.right.push_back(rightRow);
+          }
+        }
+        l.next();
+        r.next();
+        if (!l.valid() || !r.valid()) return;
+        leftKey = l.key();
+        rightKey = r.key();
+      }
+    }
+  }
+
+public:
+  /**
+   * Index nested-loop join: looks every outer row's key up in an index on
+   * the inner table's join column.
+   *
+   * @param outer Side whose rows drive the lookups.
+   * @param inner Table and join column of the other side; its rows field is ignored.
+   * @param index Index on inner's join column (any kind answers equality).
+   * @param innerFilter Optional; inner rows must also pass it (the inner table's WHERE).
+   * @param outerLeft Whether outer is the FROM table, so pairs come out as (outer, inner).
+   * @param pool Query pool for the outer morsels; nullptr runs serially.
+   * @return The matching pairs, in outer order by batch and key order within a batch.
+   * @throws std::invalid_argument if the join columns have different types.
+   *
+   * @example
+   * const IndexDefinition* byId = customers.findIndexForColumn("id");
+   * JoinPairs pairs = IndexJoin::nestedLoop(JoinSide{&orders, 1, &recent}, JoinSide{&customers, 0}, *byId,
+   *                                         nullptr, true, pool);
+   */
+  static JoinPairs nestedLoop(const JoinSide& outer, const JoinSide& inner, const IndexDefinition& index,
+                              const Predicate* innerFilter, bool outerLeft, ThreadPool* pool) {
+    const Column& innerColumn = inner.keyColumn();
+    // Outer STRING keys come out in the inner dictionary's codes; a string
+    // the inner column never held has no key and is not looked up at all.
+    const JoinKeys keys(outer, innerColumn);
+    const size_t rows = outer.size();
+    std::vector<JoinPairs> results(std::max<size_t>(1, MorselScan::morselCount(rows)));
+    MorselScan::forEachMorsel(pool, rows, [&](size_t begin, size_t end) {
+      JoinPairs& out = results[begin / MorselScan::MORSEL_ROWS];
+      std::vector<std::pair<uint64_t, size_t>> batch; // (key, outer row)
+      std::vector<Value> values;
+      std::vector<size_t> offsets, matches, outerRows, innerRows;
+      std::vector<uint8_t> mask;
+      batch.reserve(PROBE_BATCH);
+      for (size_t first = begin; first < end; first += PROBE_BATCH) {
+        batch.clear();
+        uint64_t key;
+        for (size_t i = first; i < std::min(end, first + PROBE_BATCH); ++i) {
+          const size_t row = outer.rowAt(i);
+          if (keys.get(row, key)) batch.emplace_back(key, row);
+        }
+        std::sort(batch.begin(), batch.end());
+
+        // One lookup per distinct key of the batch.
+        values.clear();
+        for (size_t i = 0; i < batch.size(); ++i) {
+          if (i == 0 || batch[i].first != batch[i - 1].first) values.push_back(keyValue(batch[i].first, innerColumn));
+        }
+        inner.table->searchRowsByIndexBatch(index, values, offsets, matches);
+
+        outerRows.clear();
+        innerRows.clear();
+        for (size_t i = 0, k = 0; i < batch.size(); ++i) {
+          if (i > 0 && batch[i].first != batch[i - 1].first) ++k;
+          for (size_t m = offsets[k]; m < offsets[k + 1]; ++m) {
+            outerRows.push_back(batch[i].second);
+            innerRows.push_back(matches[m]);
+          }
+        }
+        if (innerFilter && !innerRows.empty()) filterInner(*innerFilter, outerRows, innerRows, mask);
+        std::vector<size_t>& outerOut = outerLeft ? out.left : out.right;
+        std::vector<size_t>& innerOut = outerLeft ? out.right : out.left;
+        outerOut.insert(outerOut.end(), outerRows.begin(), outerRows.end());
+        innerOut.insert(innerOut.end(), innerRows.begin(), innerRows.end());
+      }
+    });
+
+    if (results.size() == 1) return std::move(results[0]);
+    JoinPairs pairs;
+    size_t total = 0;
+    for (const JoinPairs& result : results) total += result.size();
+    pairs.left.reserve(total);
+    pairs.right.reserve(total);
+    for (JoinPairs& result : results) {
+      pairs.left.insert(pairs.left.end(), result.left.begin(), result.left.end());
+      pairs.right.insert(pairs.right.end(), result.right.begin(), result.right.end());
+      result = JoinPairs();
+    }
+    return pairs;
+  }
+
+  /**
+   * Merge join over the B+tree indexes of both join columns. A side's rows
+   * field, when set, restricts the rows taking part.
+   *
+   * @param left The FROM table's side.
+   * @param leftIndex B+tree index on left's join column.
+   * @param right The joined table's side.
+   * @param rightIndex B+tree index on right's join column.
+   * @return The matching pairs, in ascending key order.
+   * @throws std::invalid_argument if the join columns have different types.
+   *
+   * @example
+   * JoinPairs pairs = IndexJoin::merge(JoinSide{&orders, 1}, *orders.findIndexForColumn("customer", true),
+   *                                    JoinSide{&customers, 0}, *customers.findIndexForColumn("id", true));
+   */
+  static JoinPairs merge(const JoinSide& left, const IndexDefinition& leftIndex, const JoinSide& right,
+                         const IndexDefinition& rightIndex) {
+    if (left.keyColumn().getType() != right.keyColumn().getType()) {
+      throw std::invalid_argument("Join columns " + left.keyColumn().getName() + " and " +
+                                  right.keyColumn().getName() + " have different types");
+    }
+    const std::vector<uint8_t> leftMask = membership(left);
+    const std::vector<uint8_t> rightMask = membership(right);
+    JoinPairs pairs;
+    left.table->visitIndexTree(leftIndex, [&](const auto& leftTree) {
+      right.table->visitIndexTree(rightIndex, [&](const auto& rightTree) {
+        using LeftTree = std::decay_t<decltype(leftTree)>;
+        if constexpr (std::is_same_v<LeftTree, std::decay_t<decltype(rightTree)>>) {
+          mergeTrees(leftTree, leftMask.empty() ? nullptr : leftMask.data(), rightTree,
+                     rightMask.empty() ? nullptr : rightMask.data(), pairs);
+        } else {
+          throw std::invalid_argument("Indexes " + leftIndex.name + " and " + rightIndex.name +
+                                      " have different key types");
+        }
+      });
+    });
+    return pairs;
+  }
+};
+
+#endif
@@ -15,7 +15,8 @@ public:
   InsertQuery(Storage& storage) : storage(storage) {}
   
   /**
-   * Inserts a new row into the specified table.
+   * Inserts a new row into the specified table and commits it to the
+   * write-ahead log.
    * 
    * @param tableName Name of the table to insert into.
    * @param values Vector of Value objects representing the row to insert.
@@ -25,8 +26,22 @@ public:
    * insertQuery.insertInto("users", {Value(1), Value("Alice"), Value(30)});
    */
   void insertInto(const std::string& tableName, const std::vector<Value>& values) {
-    Table& table = storage.getTable(tableName);
-    table.insertRow(values);
+    storage.insertRow(tableName, values);
+  }
+
+  /**
+   * Inserts several rows as one statement: all of them are inserted and
+   * committed together, or none is if any row is rejected.
+   * 
+   * @param tableName Name of the table to insert into.
+   * @param rows The rows to insert.
+   * 
+   * @example
+   * InsertQuery insertQuery(storage);
+   * insertQuery.insertRows("users", {{Value(1), Value("Alice")}, {Value(2), Value("Bob")}});
+   */
+  void insertRows(const std::string& tableName, const std::vector<std::vector<Value>>& rows) {
+    storage.insertRows(tableName, rows);
   }
 
 };
@@ -0,0 +1,125 @@
+#ifndef JOIN_KEYS_H
+#define JOIN_KEYS_H
+
+#include "../table.h"
+#include "../column.h"
+#include "../value.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+===========================================================================
+Join inputs:
+A JoinSide is one input of an equi-join: a table, the position of its join
+column and, when a WHERE narrowed it, the rows taking part (all rows
+otherwise). A join produces JoinPairs, the matching (left row, right row)
+pairs, which ResultCursor projects.
+===========================================================================
+*/
+struct JoinSide {
+  const Table* table = nullptr;
+  size_t column = 0;
+  const std::vector<size_t>* rows = nullptr; // nullptr = every row of the table
+
+  size_t size() const { return rows ? rows->size() : table->getRowCount(); }
+  size_t rowAt(size_t i) const { return rows ? (*rows)[i] : i; }
+  const Column& keyColumn() const { return table->getColumn(column); }
+};
+
+struct JoinPairs {
+  std::vector<size_t> left;  // Row of the FROM table
+  std::vector<size_t> right; // Row of the joined table, for the same match
+
+  size_t size() const { return left.size(); }
+};
+
+/*
+===========================================================================
+JoinKeys Class:
+Reads a side's join column as 64-bit integer keys, so join operators
+compare plain integers whatever the column type: INT values, BOOL 0/1 and,
+for STRING, dictionary codes. The two tables have separate dictionaries,
+so a STRING side is read in the codes of a reference column (the other
+side's): each of its own codes is translated once through a lookup table,
+and rows holding a string the reference never saw have no key and can
+match nothing.
+===========================================================================
+*/
+class JoinKeys {
+private:
+  static constexpr uint32_t NO_CODE = UINT32_MAX;
+
+  Value::Type type;
+  const int* ints = nullptr;
+  const uint8_t* bools = nullptr;
+  const uint32_t* codes = nullptr;
+  std::shared_ptr<const std::vector<uint32_t>> translation; // Owns toReference
+  const uint32_t* toReference = nullptr;                    // Own code -> reference code; null if shared
+
+public:
+  /**
+   * @param side Side whose keys are read.
+   * @param reference Column of the other side; STRING keys are expressed in its codes.
+   * @throws std::invalid_argument if the two join columns have different types.
+   */
+  JoinKeys(const JoinSide& side, const Column& reference) : type(side.keyColumn().getType()) {
+    const Column& column = side.keyColumn();
+    if (reference.getType() != type) {
+      throw std::invalid_argument("Join columns " + column.getName() + " and " + reference.getName() +
+                                  " have different types");
+    }
+    switch (type) {
+      case Value::INT:
+        ints = column.getIntValues().data();
+        break;
+      case Value::BOOL:
+        bools = column.getBoolValues().data();
+        break;
+      case Value::STRING: {
+        codes = column.getStringCodes().data();
+        const StringDictionary& own = column.getDictionary();
+        const StringDictionary& target = reference.getDictionary();
+        if (&own == &target) break;
+        auto map = std::make_shared<std::vector<uint32_t>>(own.size(), NO_CODE);
+        for (uint32_t code = 0; code < own.size(); ++code) {
+          if (std::optional<uint32_t> mapped = target.find(own.decode(code))) (*map)[code] = *mapped;
+        }
+        toReference = map->data();
+        translation = std::move(map);
+        break;
+      }
+      default:
+        throw std::invalid_argument("Unsupported join column type for " + column.getName());
+    }
+  }
+
+  /**
+   * Reads the key of one table row.
+   *
+   * @param row Table row.
+   * @param key Receives the key.
+   * @return false if the row has no key in the reference's domain (it matches nothing).
+   */
+  bool get(size_t row, uint64_t& key) const {
+    switch (type) {
+      case Value::INT:
+        key = static_cast<uint64_t>(static_cast<int64_t>(ints[row]));
+        return true;
+      case Value::BOOL:
+        key = bools[row];
+        return true;
+      default: {
+        const uint32_t code = toReference ? toReference[codes[row]] : codes[row];
+        key = code;
+        return code != NO_CODE;
+      }
+    }
+  }
+};
+
+#endif
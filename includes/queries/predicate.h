@@ -0,0 +1,327 @@
+#ifndef PREDICATE_H
+#define PREDICATE_H
+
+#include "../table.h"
+#include "../column.h"
+#include "../value.h"
+#include "statement_plan.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+/*
+===========================================================================
+Predicate Class:
+A WHERE expression compiled against one table for one set of parameter
+values. compile() resolves every leaf's column type and literal once and
+builds a closure around a tight loop over the column's typed array (int,
+uint8 bool or uint32 dictionary code), so rows are tested without a
+per-row type switch, Value construction or virtual call.
+
+Evaluation fills a byte mask, one byte per row (1 = match), for a slice of
+rows or for a list of rows; AND, OR and NOT combine child masks. STRING
+leaves other than = and <> are reduced to a lookup table over the
+dictionary codes, so each distinct string is compared once.
+===========================================================================
+*/
+class Predicate {
+public:
+  using RangeFn = std::function<void(size_t begin, size_t count, uint8_t* mask)>;
+  using RowsFn = std::function<void(const size_t* rows, size_t count, uint8_t* mask)>;
+
+private:
+  enum class Op { LEAF, AND, OR, NOT, CONSTANT };
+
+  static constexpr size_t SMALL_IN_LIST = 8; // IN lists up to this size are tested by linear comparison
+
+  Op op = Op::CONSTANT;
+  bool constant = true;              // Op::CONSTANT
+  RangeFn evalRange;                 // Op::LEAF
+  RowsFn evalRows;                   // Op::LEAF
+  std::vector<Predicate> children;   // AND, OR, NOT
+
+  static Predicate makeConstant(bool value) {
+    Predicate p;
+    p.op = Op::CONSTANT;
+    p.constant = value;
+    return p;
+  }
+
+  // A leaf testing test(data[row]) for each row.
+  template<typename T, typename Test>
+  static Predicate makeLeaf(const T* data, Test test) {
+    Predicate p;
+    p.op = Op::LEAF;
+    p.evalRange = [data, test](size_t begin, size_t count, uint8_t* mask) {
+      const T* values = data + begin;
+      for (size_t i = 0; i < count; ++i) {
+        mask[i] = test(values[i]) ? 1 : 0;
+      }
+    };
+    p.evalRows = [data, test](const size_t* rows, size_t count, uint8_t* mask) {
+      for (size_t i = 0; i < count; ++i) {
+        mask[i] = test(data[rows[i]]) ? 1 : 0;
+      }
+    };
+    return p;
+  }
+
+  template<typename T>
+  static Predicate makeComparison(const T* data, Expression::Comparison comparison, T c) {
+    switch (comparison) {
+      case Expression::Comparison::EQ: return makeLeaf(data, [c](T v) { return v == c; });
+      case Expression::Comparison::NE: return makeLeaf(data, [c](T v) { return v != c; });
+      case Expression::Comparison::LT: return makeLeaf(data, [c](T v) { return v < c; });
+      case Expression::Comparison::LE: return makeLeaf(data, [c](T v) { return v <= c; });
+      case Expression::Comparison::GT: return makeLeaf(data, [c](T v) { return v > c; });
+      default:                         return makeLeaf(data, [c](T v) { return v >= c; });
+    }
+  }
+
+  template<typename T>
+  static Predicate makeBetween(const T* data, T low, T high) {
+    if (high < low) return makeConstant(false);
+    return makeLeaf(data, [low, high](T v) { return low <= v && v <= high; });
+  }
+
+  template<typename T>
+  static Predicate makeIn(const T* data, std::vector<T> set) {
+    std::sort(set.begin(), set.end());
+    set.erase(std::unique(set.begin(), set.end()), set.end());
+    if (set.empty()) return makeConstant(false);
+    if (set.size() == 1) return makeComparison(data, Expression::Comparison::EQ, set[0]);
+    if (set.size() <= SMALL_IN_LIST) {
+      // Compare against every value without branching; a binary search
+      // mispredicts on most rows.
+      std::array<T, SMALL_IN_LIST> list{};
+      std::copy(set.begin(), set.end(), list.begin());
+      const size_t size = set.size();
+      return makeLeaf(data, [list, size](T v) {
+        bool hit = false;
+        for (size_t i = 0; i < size; ++i) hit |= v == list[i];
+        return hit;
+      });
+    }
+    auto shared = std::make_shared<const std::vector<T>>(std::move(set));
+    return makeLeaf(data, [shared](T v) { return std::binary_search(shared->begin(), shared->end(), v); });
+  }
+
+  // A leaf over dictionary codes that looks each code up in matches (1 per code).
+  static Predicate makeCodeLookup(const uint32_t* codes, std::vector<uint8_t> matches) {
+    if (std::find(matches.begin(), matches.end(), 1) == matches.end()) return makeConstant(false);
+    auto shared = std::make_shared<const std::vector<uint8_t>>(std::move(matches));
+    const uint8_t* table = shared->data();
+    return makeLeaf(codes, [shared, table](uint32_t code) { return table[code] != 0; });
+  }
+
+  static bool compareStrings(std::string_view v, Expression::Comparison comparison, std::string_view c) {
+    switch (comparison) {
+      case Expression::Comparison::EQ: return v == c;
+      case Expression::Comparison::NE: return v != c;
+      case Expression::Comparison::LT: return v < c;
+      case Expression::Comparison::LE: return v <= c;
+      case Expression::Comparison::GT: return v > c;
+      default:                         return v >= c;
+    }
+  }
+
+  static bool isOrdering(Expression::Comparison comparison) {
+    return comparison != Expression::Comparison::EQ && comparison != Expression::Comparison::NE;
+  }
+
+  static void checkType(const Value& value, Value::Type type, const std::string& column) {
+    if (value.getType() != type) {
+      throw std::invalid_argument("Type mismatch for column " + column);
+    }
+  }
+
+  static Predicate compileCompare(const Column& column, const Expression& expr, const Value& value) {
+    const Value::Type type = column.getType();
+    if (value.getType() != type) {
+      // Like WHERE col = value, a value of another type equals no row.
+      if (isOrdering(expr.comparison)) checkType(value, type, expr.column);
+      return makeConstant(expr.comparison == Expression::Comparison::NE);
+    }
+    switch (type) {
+      case Value::INT:
+        return makeComparison(column.getIntValues().data(), expr.comparison, value.getInt());
+      case Value::BOOL:
+        return makeComparison(column.getBoolValues().data(), expr.comparison,
+                              static_cast<uint8_t>(value.getBool() ? 1 : 0));
+      case Value::STRING: {
+        const StringDictionary& dictionary = column.getDictionary();
+        const uint32_t* codes = column.getStringCodes().data();
+        if (!isOrdering(expr.comparison)) {
+          const std::optional<uint32_t> code = dictionary.find(value.getStringView());
+          if (!code) return makeConstant(expr.comparison == Expression::Comparison::NE);
+          return makeComparison(codes, expr.comparison, *code);
+        }
+        std::vector<uint8_t> matches(dictionary.size());
+        for (uint32_t code = 0; code < matches.size(); ++code) {
+          matches[code] = compareStrings(dictionary.decode(code), expr.comparison, value.getStringView()) ? 1 : 0;
+        }
+        return makeCodeLookup(codes, std::move(matches));
+      }
+      default:
+        return makeConstant(false);
+    }
+  }
+
+  static Predicate compileBetween(const Column& column, const Expression& expr, const Value& low, const Value& high) {
+    const Value::Type type = column.getType();
+    checkType(low, type, expr.column);
+    checkType(high, type, expr.column);
+    switch (type) {
+      case Value::INT:
+        return makeBetween(column.getIntValues().data(), low.getInt(), high.getInt());
+      case Value::BOOL:
+        return makeBetween(column.getBoolValues().data(), static_cast<uint8_t>(low.getBool() ? 1 : 0),
+                           static_cast<uint8_t>(high.getBool() ? 1 : 0));
+      case Value::STRING: {
+        const StringDictionary& dictionary = column.getDictionary();
+        std::vector<uint8_t> matches(dictionary.size());
+        for (uint32_t code = 0; code < matches.size(); ++code) {
+          std::string_view v = dictionary.decode(code);
+          matches[code] = (low.getStringView() <= v && v <= high.getStringView()) ? 1 : 0;
+        }
+        return makeCodeLookup(column.getStringCodes().data(), std::move(matches));
+      }
+      default:
+        return makeConstant(false);
+    }
+  }
+
+  // Values of another type than the column are left out of the list.
+  static Predicate compileIn(const Column& column, const std::vector<Value>& values) {
+    const Value::Type type = column.getType();
+    switch (type) {
+      case Value::INT: {
+        std::vector<int> set;
+        for (const Value& v : values) {
+          if (v.getType() == type) set.push_back(v.getInt());
+        }
+        return makeIn(column.getIntValues().data(), std::move(set));
+      }
+      case Value::BOOL: {
+        std::vector<uint8_t> set;
+        for (const Value& v : values) {
+          if (v.getType() == type) set.push_back(v.getBool() ? 1 : 0);
+        }
+        return makeIn(column.getBoolValues().data(), std::move(set));
+      }
+      case Value::STRING: {
+        const StringDictionary& dictionary = column.getDictionary();
+        std::vector<uint32_t> set;
+        for (const Value& v : values) {
+          if (v.getType() != type) continue;
+          if (std::optional<uint32_t> code = dictionary.find(v.getStringView())) set.push_back(*code);
+        }
+        return makeIn(column.getStringCodes().data(), std::move(set));
+      }
+      default:
+        return makeConstant(false);
+    }
+  }
+
+  // Evaluates children into mask and combines them; eval(child, mask) evaluates one child.
+  template<typename Eval>
+  void combine(size_t count, uint8_t* mask, Eval eval) const {
+    switch (op) {
+      case Op::CONSTANT:
+        std::memset(mask, constant ? 1 : 0, count);
+        return;
+      case Op::NOT:
+        eval(children[0], mask);
+        for (size_t i = 0; i < count; ++i) mask[i] ^= 1;
+        return;
+      case Op::AND:
+      case Op::OR: {
+        eval(children[0], mask);
+        std::vector<uint8_t> scratch(count);
+        for (size_t c = 1; c < children.size(); ++c) {
+          eval(children[c], scratch.data());
+          if (op == Op::AND) {
+            for (size_t i = 0; i < count; ++i) mask[i] &= scratch[i];
+          } else {
+            for (size_t i = 0; i < count; ++i) mask[i] |= scratch[i];
+          }
+        }
+        return;
+      }
+      default:
+        return;
+    }
+  }
+
+public:
+  /**
+   * Compiles a WHERE expression for a table.
+   *
+   * @param table Table the expression's column indices refer to; its columns
+   *              must not change while the predicate is used.
+   * @param expr The expression.
+   * @param args Values for the expression's ? placeholders.
+   * @return The compiled predicate.
+   * @throws std::invalid_argument if an ordering comparison or BETWEEN bound does not match the column type.
+   *
+   * @example
+   * Predicate p = Predicate::compile(table, plan.where, {});
+   * std::vector<uint8_t> mask(table.getRowCount());
+   * p.evaluate(0, mask.size(), mask.data());
+   */
+  static Predicate compile(const Table& table, const Expression& expr, const std::vector<Value>& args) {
+    if (!expr.isLeaf()) {
+      Predicate p;
+      p.op = expr.kind == Expression::Kind::AND ? Op::AND : expr.kind == Expression::Kind::OR ? Op::OR : Op::NOT;
+      for (const Expression& child : expr.children) {
+        p.children.push_back(compile(table, child, args));
+      }
+      return p;
+    }
+
+    const Column& column = table.getColumn(expr.columnIndex);
+    switch (expr.kind) {
+      case Expression::Kind::COMPARE:
+        return compileCompare(column, expr, expr.operands[0].bind(args));
+      case Expression::Kind::BETWEEN:
+        return compileBetween(column, expr, expr.operands[0].bind(args), expr.operands[1].bind(args));
+      case Expression::Kind::IN: {
+        std::vector<Value> values;
+        values.reserve(expr.operands.size());
+        for (const Operand& operand : expr.operands) {
+          values.push_back(operand.bind(args));
+        }
+        return compileIn(column, values);
+      }
+      default:
+        // Columns have no NULLs: IS NULL matches nothing, IS NOT NULL everything.
+        return makeConstant(expr.negated);
+    }
+  }
+
+  // Sets mask[i] for row begin + i, for count rows.
+  void evaluate(size_t begin, size_t count, uint8_t* mask) const {
+    if (op == Op::LEAF) {
+      evalRange(begin, count, mask);
+      return;
+    }
+    combine(count, mask, [&](const Predicate& child, uint8_t* out) { child.evaluate(begin, count, out); });
+  }
+
+  // Sets mask[i] for row rows[i], for count rows.
+  void evaluate(const size_t* rows, size_t count, uint8_t* mask) const {
+    if (op == Op::LEAF) {
+      evalRows(rows, count, mask);
+      return;
+    }
+    combine(count, mask, [&](const Predicate& child, uint8_t* out) { child.evaluate(rows, count, out); });
+  }
+};
+
+#endif
@@ -0,0 +1,185 @@
+#ifndef RESULT_CURSOR_H
+#define RESULT_CURSOR_H
+
+#include "../table.h"
+#include "../value.h"
+#include "../column.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+===========================================================================
+RowBatch:
+One batch of query results in column slices: columns[c][i] is the value of
+the c-th projected column in table row rows[i].
+===========================================================================
+*/
+struct RowBatch {
+  std::vector<size_t> rows;                // Table row of each batch row (the FROM table's, for a join)
+  std::vector<std::vector<Value>> columns; // One slice per projected column
+
+  size_t size() const { return rows.size(); }
+
+  const Value& at(size_t row, size_t col) const { return columns[col][row]; }
+};
+
+/*
+===========================================================================
+ResultCursor Class:
+Pull-based result of a SELECT. The matching rows are fixed when the cursor
+is opened (every row of the table, or the row list produced by a WHERE),
+but values are only materialized BATCH_ROWS rows at a time as next() is
+called, so memory does not grow with the size of the result and the first
+batch is available before the rest has been read.
+
+A join cursor reads from two tables: each match is a row of the FROM table
+and a row of the joined table, and every projected column comes from one
+of them.
+
+A cursor can also return values computed by the query rather than read
+from a table, such as the groups of an aggregation; those are held whole.
+
+The cursor keeps a pointer to the table. It must not outlive it, and rows
+appended after the cursor was opened are not returned.
+===========================================================================
+*/
+class ResultCursor {
+public:
+  static constexpr size_t BATCH_ROWS = 1024;
+
+private:
+  const Table* table;
+  std::vector<std::string> columnNames;
+  std::vector<size_t> colIndices;
+  std::vector<size_t> rows; // Matching rows; unused when allRows
+  const Table* joinedTable = nullptr;   // Join cursors only
+  std::vector<size_t> joinedRows;       // Joined table row of each match
+  std::vector<uint8_t> columnSides;     // 1 for columns read from joinedTable
+  std::vector<std::vector<Value>> values; // Computed cursors only: one vector per column
+  bool allRows;
+  size_t total;
+  size_t position = 0;
+
+public:
+  /**
+   * Opens a cursor over every row of the table.
+   *
+   * @param table Table to read; must outlive the cursor.
+   * @param columnNames Names of the projected columns, in output order.
+   * @param colIndices Column index of each projected column.
+   *
+   * @example
+   * ResultCursor cursor(table, {"id", "name"}, {0, 1});
+   */
+  ResultCursor(const Table& table, std::vector<std::string> columnNames, std::vector<size_t> colIndices)
+      : table(&table), columnNames(std::move(columnNames)), colIndices(std::move(colIndices)),
+        allRows(true), total(table.getRowCount()) {}
+
+  /**
+   * Opens a cursor over the given rows of the table, returned in that order.
+   *
+   * @param table Table to read; must outlive the cursor.
+   * @param columnNames Names of the projected columns, in output order.
+   * @param colIndices Column index of each projected column.
+   * @param rows Table rows to return.
+   */
+  ResultCursor(const Table& table, std::vector<std::string> columnNames, std::vector<size_t> colIndices,
+               std::vector<size_t> rows)
+      : table(&table), columnNames(std::move(columnNames)), colIndices(std::move(colIndices)),
+        rows(std::move(rows)), allRows(false), total(this->rows.size()) {}
+
+  /**
+   * Opens a cursor over the matches of a join.
+   *
+   * @param table FROM table; must outlive the cursor.
+   * @param joinedTable Joined table; must outlive the cursor.
+   * @param columnNames Names of the projected columns, in output order.
+   * @param colIndices Column index of each projected column, in its own table.
+   * @param columnSides 0 for a column of table, 1 for a column of joinedTable.
+   * @param rows Row of table for each match.
+   * @param joinedRows Row of joinedTable for each match.
+   */
+  ResultCursor(const Table& table, const Table& joinedTable, std::vector<std::string> columnNames,
+               std::vector<size_t> colIndices, std::vector<uint8_t> columnSides, std::vector<size_t> rows,
+               std::vector<size_t> joinedRows)
+      : table(&table), columnNames(std::move(columnNames)), colIndices(std::move(colIndices)),
+        rows(std::move(rows)), joinedTable(&joinedTable), joinedRows(std::move(joinedRows)),
+        columnSides(std::move(columnSides)), allRows(false), total(this->rows.size()) {}
+
+  /**
+   * Opens a cursor over computed values rather than table rows.
+   *
+   * @param columnNames Names of the columns, in output order.
+   * @param values One vector per column, all of the same length.
+   *
+   * @example
+   * ResultCursor cursor({"COUNT(*)"}, {{Value(42)}});
+   */
+  ResultCursor(std::vector<std::string> columnNames, std::vector<std::vector<Value>> values)
+      : table(nullptr), columnNames(std::move(columnNames)), values(std::move(values)), allRows(true),
+        total(this->values.empty() ? 0 : this->values[0].size()) {}
+
+  const std::vector<std::string>& getColumnNames() const { return columnNames; }
+
+  // Total number of rows the cursor returns.
+  size_t rowCount() const { return total; }
+
+  bool hasNext() const { return position < total; }
+
+  /**
+   * Fills batch with the next rows of the result, up to BATCH_ROWS. The
+   * batch's buffers are reused, so passing the same batch every time avoids
+   * reallocating them.
+   *
+   * @param batch Receives the rows; its previous contents are replaced.
+   * @return false once every row has been returned (batch is then empty).
+   *
+   * @example
+   * RowBatch batch;
+   * while (cursor.next(batch)) {
+   *   for (size_t i = 0; i < batch.size(); ++i) print(batch.at(i, 0));
+   * }
+   */
+  bool next(RowBatch& batch) {
+    const size_t count = std::min(BATCH_ROWS, total - position);
+    const size_t first = position;
+    batch.rows.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+      batch.rows[i] = allRows ? first + i : rows[first + i];
+    }
+    position += count;
+
+    if (!table) {
+      batch.columns.resize(values.size());
+      for (size_t c = 0; c < values.size(); ++c) {
+        batch.columns[c].assign(values[c].begin() + first, values[c].begin() + first + count);
+      }
+      return count > 0;
+    }
+
+    // Column at a time, so each column's array is read sequentially.
+    batch.columns.resize(colIndices.size());
+    for (size_t c = 0; c < colIndices.size(); ++c) {
+      std::vector<Value>& slice = batch.columns[c];
+      slice.resize(count);
+      if (!columnSides.empty() && columnSides[c]) {
+        const Column& column = joinedTable->getColumn(colIndices[c]);
+        for (size_t i = 0; i < count; ++i) {
+          slice[i] = column.getValue(joinedRows[first + i]);
+        }
+        continue;
+      }
+      const Column& column = table->getColumn(colIndices[c]);
+      for (size_t i = 0; i < count; ++i) {
+        slice[i] = column.getValue(batch.rows[i]);
+      }
+    }
+    return count > 0;
+  }
+};
+
+#endif
@@ -4,10 +4,42 @@
 #include "../storage.h"
 #include "../table.h"
 #include "../value.h"
+#include "../column.h"
+#include "../concurrency/morsel_scan.h"
+#include "result_cursor.h"
+#include "predicate.h"
+#include "cost_model.h"
+#include "hash_aggregate.h"
+#include "hash_join.h"
+#include "index_join.h"
+#include "join_keys.h"
+#include "statement_plan.h"
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <memory>
 #include <vector>
 #include <stdexcept>
 #include <unordered_map>
 
+/*
+===========================================================================
+SelectQuery Class:
+Evaluates SELECT statements against a table.
+
+The open* methods return a ResultCursor that materializes the projected
+values batch by batch as it is read; this is what the REPL uses, so a large
+SELECT never holds more than one batch of values. openPlan also runs
+compound WHERE expressions (see expressionRows), joins (openJoin: hash,
+index nested-loop or merge join) and GROUP BY / aggregates (openAggregate,
+see HashAggregate). Once the table has been
+analyzed, each predicate is answered from an index or by a scan, whichever
+CostModel estimates to be cheaper. The select* methods build
+the whole result as a map from column name to values, projected in
+parallel on the query pool.
+===========================================================================
+*/
 class SelectQuery {
 private:
   Storage& storage;
@@ -19,14 +51,209 @@ public:
     return table;
   }
 
+  // Expands {"*"} to every column in place and returns each column's index.
+  static std::vector<size_t> resolveColumns(const Table& table, std::vector<std::string>& columnNames) {
+    if(columnNames.size() == 1 && columnNames[0] == "*") {
+      columnNames = table.getColumnNames();
+    }
+
+    const std::unordered_map<std::string, size_t>& colIndexMap = table.getColumnIndexMap();
+    std::vector<size_t> colIndices;
+    for (const std::string& colName : columnNames) {
+      auto it = colIndexMap.find(colName);
+      if (it == colIndexMap.end()) {
+        throw std::out_of_range("Column not found: " + colName);
+      }
+      colIndices.push_back(it->second);
+    }
+    return colIndices;
+  }
+
+  // Index of the WHERE column; throws std::out_of_range if there is none.
+  static size_t resolveConditionColumn(const Table& table, const std::string& conditionColumn) {
+    const std::unordered_map<std::string, size_t>& colIndexMap = table.getColumnIndexMap();
+    auto condIt = colIndexMap.find(conditionColumn);
+    if (condIt == colIndexMap.end()) {
+      throw std::out_of_range("Condition column not found: " + conditionColumn);
+    }
+    return condIt->second;
+  }
+
+  /**
+   * Opens a cursor over specific columns of every row of a table.
+   *
+   * @param tableName Name of the table to select from.
+   * @param columnNames Vector of column names to select; {"*"} selects all.
+   * @return A cursor returning the rows in table order.
+   * @throws std::out_of_range if any specified column does not exist.
+   *
+   * @example
+   * SelectQuery selectQuery(storage);
+   * ResultCursor cursor = selectQuery.openColumns("users", {"id", "name"});
+   */
+  ResultCursor openColumns(const std::string& tableName, std::vector<std::string> columnNames) {
+    const Table& table = storage.getTable(tableName);
+    std::vector<size_t> colIndices = resolveColumns(table, columnNames);
+    return ResultCursor(table, std::move(columnNames), std::move(colIndices));
+  }
+
+  /**
+   * Opens a cursor over specific columns of the rows where a condition is met.
+   * The matching rows are found when the cursor is opened (see selectWhere);
+   * their values are read as the cursor advances.
+   *
+   * @param tableName Name of the table to select from.
+   * @param columnNames Vector of column names to select; {"*"} selects all.
+   * @param conditionValue Value to match in the condition column.
+   * @param conditionColumn Name of the column to apply the condition on.
+   * @return A cursor returning the matching rows.
+   * @throws std::out_of_range if any specified column does not exist.
+   *
+   * @example
+   * SelectQuery selectQuery(storage);
+   * ResultCursor cursor = selectQuery.openWhere("users", {"*"}, Value(30), "age");
+   */
+  ResultCursor openWhere(const std::string& tableName, std::vector<std::string> columnNames, const Value& conditionValue, const std::string& conditionColumn) {
+    const Table& table = storage.getTable(tableName);
+    std::vector<size_t> colIndices = resolveColumns(table, columnNames);
+    std::vector<size_t> rows = whereRows(table, conditionValue, resolveConditionColumn(table, conditionColumn), storage.getQueryPool().get());
+    return ResultCursor(table, std::move(columnNames), std::move(colIndices), std::move(rows));
+  }
+
+  /**
+   * Opens a cursor over specific columns of the rows where the condition
+   * column lies in a range (see selectWhereRange).
+   *
+   * @param tableName Name of the table to select from.
+   * @param columnNames Vector of column names to select; {"*"} selects all.
+   * @param range Bounds on the condition column; a missing bound is open.
+   * @param conditionColumn Name of the column to apply the condition on.
+   * @return A cursor returning the matching rows.
+   * @throws std::out_of_range if any specified column does not exist.
+   * @throws std::invalid_argument if a bound does not match the condition column type.
+   *
+   * @example
+   * SelectQuery selectQuery(storage);
+   * ValueRange adults{Value(18), true, std::nullopt, true};
+   * ResultCursor cursor = selectQuery.openWhereRange("users", {"name"}, adults, "age");
+   */
+  ResultCursor openWhereRange(const std::string& tableName, std::vector<std::string> columnNames, const ValueRange& range, const std::string& conditionColumn) {
+    const Table& table = storage.getTable(tableName);
+    std::vector<size_t> colIndices = resolveColumns(table, columnNames);
+    std::vector<size_t> rows = rangeRows(table, range, conditionColumn, resolveConditionColumn(table, conditionColumn), storage.getQueryPool().get());
+    return ResultCursor(table, std::move(columnNames), std::move(colIndices), std::move(rows));
+  }
+
+  /**
+   * Opens a cursor for a parsed SELECT. Column names were resolved when the
+   * plan was built, so only the table itself is looked up here.
+   *
+   * @param plan Plan built by SelectProcessor::parse.
+   * @param args One value per ? placeholder of the plan.
+   * @return A cursor returning the matching rows.
+   * @throws std::out_of_range if the table does not exist.
+   * @throws std::invalid_argument if a range bound does not match the condition column type.
+   *
+   * @example
+   * ResultCursor cursor = selectQuery.openPlan(plan, {Value(30)});
+   */
+  ResultCursor openPlan(const SelectPlan& plan, const std::vector<Value>& args) {
+    if (plan.aggregated) {
+      return openAggregate(plan, args);
+    }
+    if (plan.join) {
+      return openJoin(plan, args);
+    }
+    const Table& table = storage.getTable(plan.tableName);
+    std::optional<std::vector<size_t>> rows = filterRows(table, plan, args, storage.getQueryPool().get());
+    if (!rows) {
+      return ResultCursor(table, plan.columnNames, plan.colIndices);
+    }
+    return ResultCursor(table, plan.columnNames, plan.colIndices, std::move(*rows));
+  }
+
+  // How openJoin ran a join.
+  struct JoinStats {
+    enum class Method { HASH, INDEX_NESTED_LOOP, MERGE };
+    Method method = Method::HASH;
+    bool outerLeft = false;   // INDEX_NESTED_LOOP: the FROM table drove the lookups
+    HashJoin::Stats hash;     // HASH
+  };
+
+  /**
+   * Opens a cursor over the matches of a planned join. The FROM table is
+   * narrowed by its WHERE conjuncts first. If the joined table has an index
+   * on its join column and looking the FROM rows up in it is estimated to
+   * beat a hash join, the joined table is never scanned: its conjuncts are
+   * tested on the rows the index returns (an index nested-loop join).
+   * Otherwise it is filtered as well, and the cheapest of a hash join, an
+   * index nested-loop join into the FROM table's index, and a merge join
+   * over B+tree indexes on both join columns is run (see CostModel). The
+   * hash join spills to disk past the session's join memory limit.
+   *
+   * @param plan Plan built by SelectProcessor::parse, with a join.
+   * @param args One value per ? placeholder of the plan.
+   * @param stats Optional; receives how the join ran.
+   * @return A cursor returning one row per matching pair.
+   * @throws std::invalid_argument if the join columns have different types.
+   * @throws std::runtime_error if the join cannot write its spill files.
+   *
+   * @example
+   * ResultCursor cursor = selectQuery.openJoin(selectProcessor.parse(
+   *     "SELECT o.id, c.name FROM orders o JOIN customers c ON o.customer = c.id").select, {});
+   */
+  ResultCursor openJoin(const SelectPlan& plan, const std::vector<Value>& args, JoinStats* stats = nullptr) {
+    JoinPairs pairs = joinPairs(plan, args, stats);
+    return ResultCursor(storage.getTable(plan.tableName), storage.getTable(plan.join->tableName), plan.columnNames,
+                        plan.colIndices, plan.columnSides, std::move(pairs.left), std::move(pairs.right));
+  }
+
+  /**
+   * Opens a cursor over the groups of an aggregated SELECT (GROUP BY and/or
+   * aggregates; see HashAggregate), each group's values computed up front.
+   * Without WHERE, JOIN and GROUP BY, COUNT is the table's row count and
+   * MIN and MAX of a column with a B+tree index are its first and last
+   * keys; when every aggregate can be answered that way no row is read.
+   *
+   * @param plan Plan built by SelectProcessor::parse, with aggregated set.
+   * @param args One value per ? placeholder of the plan.
+   * @return A cursor returning one row per group.
+   * @throws std::invalid_argument if SUM or AVG is applied to a column that is not INT.
+   * @throws std::overflow_error if a COUNT or SUM does not fit an INT.
+   *
+   * @example
+   * ResultCursor cursor = selectQuery.openAggregate(selectProcessor.parse(
+   *     "SELECT city, COUNT(*), AVG(age) FROM users GROUP BY city").select, {});
+   */
+  ResultCursor openAggregate(const SelectPlan& plan, const std::vector<Value>& args) {
+    const Table& table = storage.getTable(plan.tableName);
+    const std::shared_ptr<ThreadPool> pool = storage.getQueryPool();
+    if (plan.join) {
+      const JoinPairs pairs = joinPairs(plan, args, nullptr);
+      const AggregateSource sources[2] = {{&table, &pairs.left}, {&storage.getTable(plan.join->tableName), &pairs.right}};
+      return ResultCursor(plan.columnNames, HashAggregate::run(plan, sources, pairs.size(), pool.get()));
+    }
+    if (plan.filter == SelectPlan::Filter::NONE && plan.groupIndices.empty()) {
+      if (std::optional<std::vector<Value>> row = tableAggregates(table, plan)) {
+        std::vector<std::vector<Value>> columns;
+        for (Value& value : *row) columns.push_back({std::move(value)});
+        return ResultCursor(plan.columnNames, std::move(columns));
+      }
+    }
+    const std::optional<std::vector<size_t>> rows = filterRows(table, plan, args, pool.get());
+    const AggregateSource sources[2] = {{&table, rows ? &*rows : nullptr}, {}};
+    return ResultCursor(plan.columnNames,
+                        HashAggregate::run(plan, sources, rows ? rows->size() : table.getRowCount(), pool.get()));
+  }
+
   /**
    * Selects specific columns from a table.
-   * 
+   *
    * @param tableName Name of the table to select from.
    * @param columnNames Vector of column names to select.
    * @return A map where keys are column names and values are vectors of Values for that column.
    * @throws std::out_of_range if any specified column does not exist.
-   * 
+   *
    * @example
    * SelectQuery selectQuery(storage);
    * auto result = selectQuery.selectColumns("users", {"id", "name"});
@@ -45,83 +272,506 @@ public:
       colIndices.push_back(it->second);
       result[colName] = std::vector<Value>();
     }
-    
-    for (size_t i = 0; i < table.getRowCount(); ++i) {
-      const std::vector<Value>& row = table.getRow(i);
-      for (size_t j = 0; j < colIndices.size(); ++j) {
-        result[columnNames[j]].push_back(row[colIndices[j]]);
-      }
+
+    // Column-at-a-time; each column is filled in morsels on the query pool.
+    const std::shared_ptr<ThreadPool> pool = storage.getQueryPool();
+    const size_t rowCount = table.getRowCount();
+    for (size_t j = 0; j < colIndices.size(); ++j) {
+      const Column& column = table.getColumn(colIndices[j]);
+      std::vector<Value>& out = result[columnNames[j]];
+      out.resize(rowCount);
+      MorselScan::forEachMorsel(pool.get(), rowCount, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          out[i] = column.getValue(i);
+        }
+      });
     }
     return result;
   }
 
   /**
    * Selects specific columns from a table where a condition is met.
-   * 
+   *
    * @param tableName Name of the table to select from.
    * @param columnNames Vector of column names to select.
    * @param conditionValue Value to match in the condition column.
    * @param conditionColumn Name of the column to apply the condition on.
    * @return A map where keys are column names and values are vectors of Values for that column.
    * @throws std::out_of_range if any specified column does not exist.
-   * 
+   *
    * @example
    * SelectQuery selectQuery(storage);
    * auto result = selectQuery.selectWhere("users", {"id", "name"}, Value(30), "age");
    */
   std::unordered_map<std::string, std::vector<Value>> selectWhere(std::string& tableName,  std::vector<std::string>& columnNames, const Value& conditionValue, const std::string& conditionColumn) {
     Table& table = storage.getTable(tableName);
-    std::unordered_map<std::string, std::vector<Value>> result;
+    std::vector<size_t> colIndices = resolveColumns(table, columnNames);
+    const std::shared_ptr<ThreadPool> pool = storage.getQueryPool();
+    std::vector<size_t> matchingRows = whereRows(table, conditionValue, resolveConditionColumn(table, conditionColumn), pool.get());
+    return projectRows(pool.get(), table, columnNames, colIndices, matchingRows);
+  }
 
-    if(columnNames.size() == 1 && columnNames[0] == "*") {
-      columnNames = table.getColumnNames();
+  /**
+   * Selects specific columns from a table where the condition column lies
+   * in a range (WHERE col < x, col >= x, col BETWEEN x AND y, ...).
+   * Uses a B+tree index on the column when there is one, otherwise scans the
+   * condition column. Index results come back in key order.
+   *
+   * @param tableName Name of the table to select from.
+   * @param columnNames Vector of column names to select; {"*"} selects all.
+   * @param range Bounds on the condition column; a missing bound is open.
+   * @param conditionColumn Name of the column to apply the condition on.
+   * @return A map where keys are column names and values are vectors of Values for that column.
+   * @throws std::out_of_range if any specified column does not exist.
+   * @throws std::invalid_argument if a bound does not match the condition column type.
+   *
+   * @example
+   * SelectQuery selectQuery(storage);
+   * ValueRange adults{Value(18), true, std::nullopt, true};
+   * auto result = selectQuery.selectWhereRange("users", {"id", "name"}, adults, "age");
+   */
+  std::unordered_map<std::string, std::vector<Value>> selectWhereRange(std::string& tableName, std::vector<std::string>& columnNames, const ValueRange& range, const std::string& conditionColumn) {
+    Table& table = storage.getTable(tableName);
+    std::vector<size_t> colIndices = resolveColumns(table, columnNames);
+    const std::shared_ptr<ThreadPool> pool = storage.getQueryPool();
+    std::vector<size_t> matchingRows = rangeRows(table, range, conditionColumn, resolveConditionColumn(table, conditionColumn), pool.get());
+    return projectRows(pool.get(), table, columnNames, colIndices, matchingRows);
+  }
+
+private:
+  // The matching pairs of a planned join (see openJoin).
+  JoinPairs joinPairs(const SelectPlan& plan, const std::vector<Value>& args, JoinStats* stats) {
+    const Table& left = storage.getTable(plan.tableName);
+    const Table& right = storage.getTable(plan.join->tableName);
+    const std::shared_ptr<ThreadPool> pool = storage.getQueryPool();
+    const JoinPlan& join = *plan.join;
+    JoinStats local;
+    JoinStats& out = stats ? *stats : local;
+    out = JoinStats();
+    if (left.getColumnTypes()[join.leftKey] != right.getColumnTypes()[join.rightKey]) {
+      throw std::invalid_argument("Join columns " + left.getColumn(join.leftKey).getName() + " and " +
+                                  right.getColumn(join.rightKey).getName() + " have different types");
     }
 
-    const std::unordered_map<std::string, size_t>& colIndexMap = table.getColumnIndexMap();
-    size_t conditionColIndex;
-    try {
-      conditionColIndex = colIndexMap.at(conditionColumn);  // Throws if not found
-    } catch (const std::out_of_range&) {
-      throw std::out_of_range("Condition column not found: " + conditionColumn);
+    std::optional<std::vector<size_t>> leftRows = filterRows(left, plan, args, pool.get());
+    const JoinSide leftSide{&left, join.leftKey, leftRows ? &*leftRows : nullptr};
+    JoinSide rightSide{&right, join.rightKey, nullptr};
+
+    // Every lookup into the joined table's index against a hash join that
+    // has to filter that whole table first.
+    const IndexDefinition* rightIndex = joinIndex(right, join.rightKey, leftSide.size());
+    if (rightIndex) {
+      double hashCost = CostModel::hashJoinCost(std::min(leftSide.size(), right.getRowCount()),
+                                                std::max(leftSide.size(), right.getRowCount()), pool.get());
+      if (join.where) {
+        hashCost += CostModel::expressionScanCost(right.getRowCount(), leafCount(*join.where), 0, pool.get());
+      }
+      if (lookupCost(right, join.rightKey, *rightIndex, leftSide.size(), pool.get()) < hashCost) {
+        out.method = JoinStats::Method::INDEX_NESTED_LOOP;
+        out.outerLeft = true;
+        std::optional<Predicate> filter;
+        if (join.where) filter = Predicate::compile(right, *join.where, args);
+        return IndexJoin::nestedLoop(leftSide, rightSide, *rightIndex, filter ? &*filter : nullptr, true, pool.get());
+      }
     }
 
-    /**
-     * Get indices for requested columns
-     * 
-     * @throws std::out_of_range if any specified column does not exist.
-     * 
-     * @example
-     * SelectQuery selectQuery(storage);
-     * auto result = selectQuery.selectWhere("users", {"id", "name"}, Value(30), "age");
-     */
-    std::vector<size_t> colIndices;
-    for (const std::string& colName : columnNames) {
-      auto it = colIndexMap.find(colName);
-      if (it == colIndexMap.end()) {
-        throw std::out_of_range("Column not found: " + colName);
+    std::optional<std::vector<size_t>> rightRows;
+    if (join.where) {
+      rightRows = expressionRows(right, *join.where, args, pool.get());
+      rightSide.rows = &*rightRows;
+    }
+    double bestCost = CostModel::hashJoinCost(std::min(leftSide.size(), rightSide.size()),
+                                              std::max(leftSide.size(), rightSide.size()), pool.get());
+    const IndexDefinition* leftIndex = joinIndex(left, join.leftKey, rightSide.size());
+    if (leftIndex) {
+      const double cost = lookupCost(left, join.leftKey, *leftIndex, rightSide.size(), pool.get());
+      if (cost < bestCost) {
+        bestCost = cost;
+        out.method = JoinStats::Method::INDEX_NESTED_LOOP;
       }
-      colIndices.push_back(it->second);
-      result[colName] = std::vector<Value>();
+    }
+    const IndexDefinition* leftTree = left.findIndexForColumn(left.getColumn(join.leftKey).getName(), /*ordered=*/true);
+    const IndexDefinition* rightTree = right.findIndexForColumn(right.getColumn(join.rightKey).getName(), /*ordered=*/true);
+    if (leftTree && rightTree && CostModel::mergeJoinCost(left.getRowCount(), right.getRowCount()) < bestCost) {
+      out.method = JoinStats::Method::MERGE;
     }
 
-    std::vector<size_t> candidateRows;
-    if (table.hasIndexForColumn(conditionColumn)) {
-      candidateRows = table.searchRowsByIndexedValue(conditionColumn, conditionValue);
-    } else {
-      candidateRows.reserve(table.getRowCount());
-      for (size_t i = 0; i < table.getRowCount(); ++i) {
-        candidateRows.push_back(i);
+    switch (out.method) {
+      case JoinStats::Method::INDEX_NESTED_LOOP: {
+        // The FROM table's filter is tested on the rows its index returns.
+        std::optional<Predicate> filter;
+        if (std::optional<Expression> where = filterExpression(plan)) filter = Predicate::compile(left, *where, args);
+        return IndexJoin::nestedLoop(rightSide, JoinSide{&left, join.leftKey, nullptr}, *leftIndex,
+                                     filter ? &*filter : nullptr, false, pool.get());
+      }
+      case JoinStats::Method::MERGE:
+        return IndexJoin::merge(leftSide, *leftTree, rightSide, *rightTree);
+      default:
+        return HashJoin::run(leftSide, rightSide, pool.get(), storage.getJoinMemoryLimit(),
+                             storage.getSpillDirectory(), &out.hash);
+    }
+  }
+
+  // The one row of an aggregated SELECT without WHERE, JOIN or GROUP BY when
+  // no row has to be read for it: every aggregate is a COUNT (the table's
+  // row count) or a MIN/MAX of a column with a B+tree index (the first or
+  // last key of the tree). nullopt otherwise.
+  static std::optional<std::vector<Value>> tableAggregates(const Table& table, const SelectPlan& plan) {
+    std::vector<Value> row;
+    for (size_t output : plan.outputs) {
+      const Aggregate& agg = plan.aggregates[output];
+      if (agg.function == Aggregate::Function::COUNT && !agg.distinct &&
+          table.getRowCount() <= static_cast<size_t>(std::numeric_limits<int>::max())) {
+        row.push_back(Value(static_cast<int>(table.getRowCount())));
+        continue;
       }
+      const bool max = agg.function == Aggregate::Function::MAX;
+      if (!max && agg.function != Aggregate::Function::MIN) return std::nullopt;
+      const IndexDefinition* index = table.findIndexForColumn(table.getColumn(agg.columnIndex).getName(), /*ordered=*/true);
+      if (!index) return std::nullopt;
+      Value end; // NULL for an empty table
+      table.visitIndexTree(*index, [&](const auto& tree) {
+        if (auto key = max ? tree.maxKey() : tree.minKey()) end = Value(*key);
+      });
+      row.push_back(std::move(end));
     }
+    return row;
+  }
+
+  // Rows of table passing the plan's WHERE filter, or nullopt if it has none.
+  static std::optional<std::vector<size_t>> filterRows(const Table& table, const SelectPlan& plan, const std::vector<Value>& args, ThreadPool* pool) {
+    switch (plan.filter) {
+      case SelectPlan::Filter::EQUALS:
+        return whereRows(table, plan.value.bind(args), plan.conditionIndex, pool);
+      case SelectPlan::Filter::RANGE: {
+        ValueRange range;
+        if (plan.lower) range.lower = plan.lower->bind(args);
+        if (plan.upper) range.upper = plan.upper->bind(args);
+        range.lowerInclusive = plan.lowerInclusive;
+        range.upperInclusive = plan.upperInclusive;
+        return rangeRows(table, range, plan.conditionColumn, plan.conditionIndex, pool);
+      }
+      case SelectPlan::Filter::EXPRESSION:
+        return expressionRows(table, plan.where, args, pool);
+      default:
+        return std::nullopt;
+    }
+  }
 
-    for (size_t rowIndex : candidateRows) {
-      const std::vector<Value>& row = table.getRow(rowIndex);
-      // Keep this safety check for fallback scans and defensive correctness.
-      if (row[conditionColIndex] == conditionValue) {
-        for (size_t j = 0; j < colIndices.size(); ++j) {
-          result[columnNames[j]].push_back(row[colIndices[j]]);
+  // The plan's WHERE on the FROM table as an expression, or nullopt if it has none.
+  static std::optional<Expression> filterExpression(const SelectPlan& plan) {
+    auto compare = [&](Expression::Comparison comparison, const Operand& operand) {
+      Expression leaf;
+      leaf.column = plan.conditionColumn;
+      leaf.columnIndex = plan.conditionIndex;
+      leaf.comparison = comparison;
+      leaf.operands.push_back(operand);
+      return leaf;
+    };
+    switch (plan.filter) {
+      case SelectPlan::Filter::EQUALS:
+        return compare(Expression::Comparison::EQ, plan.value);
+      case SelectPlan::Filter::RANGE: {
+        Expression range;
+        range.kind = Expression::Kind::AND;
+        if (plan.lower) {
+          range.children.push_back(compare(plan.lowerInclusive ? Expression::Comparison::GE : Expression::Comparison::GT, *plan.lower));
         }
+        if (plan.upper) {
+          range.children.push_back(compare(plan.upperInclusive ? Expression::Comparison::LE : Expression::Comparison::LT, *plan.upper));
+        }
+        if (range.children.size() == 1) return std::move(range.children[0]);
+        return range;
+      }
+      case SelectPlan::Filter::EXPRESSION:
+        return plan.where;
+      default:
+        return std::nullopt;
+    }
+  }
+
+  // The index an index nested-loop join would probe `lookups` times on a join column, or nullptr.
+  static const IndexDefinition* joinIndex(const Table& table, size_t column, size_t lookups) {
+    const std::optional<double> matches = table.getStatistics()
+        ? std::optional<double>(CostModel::estimateJoinMatches(table, column, lookups)) : std::nullopt;
+    return CostModel::chooseEqualityIndex(table, column, matches, lookups, std::numeric_limits<double>::infinity());
+  }
+
+  // Cost of an index nested-loop join probing index `lookups` times.
+  static double lookupCost(const Table& table, size_t column, const IndexDefinition& index, size_t lookups, ThreadPool* pool) {
+    return CostModel::indexJoinCost(index.kind, lookups, CostModel::estimateJoinMatches(table, column, lookups), pool);
+  }
+
+  // Rows whose condition column equals conditionValue, from the cheapest index
+  // or, when the statistics say that is cheaper, by a scan.
+  static std::vector<size_t> whereRows(const Table& table, const Value& conditionValue, size_t conditionIndex, ThreadPool* pool) {
+    const Column& conditionCol = table.getColumn(conditionIndex);
+    const std::optional<double> matches = CostModel::estimateEquals(table, conditionIndex, conditionValue);
+    const IndexDefinition* index = CostModel::chooseEqualityIndex(table, conditionIndex, matches, 1,
+        CostModel::scanCost(table.getRowCount(), matches.value_or(0), pool));
+    std::vector<size_t> matchingRows;
+    if (index) {
+      // Keep this safety check on index results for defensive correctness.
+      for (size_t rowIndex : table.searchRowsByIndex(*index, conditionValue)) {
+        if (conditionCol.equals(rowIndex, conditionValue)) {
+          matchingRows.push_back(rowIndex);
+        }
+      }
+    } else {
+      // Fallback scan touches only the condition column, one morsel per task.
+      matchingRows = MorselScan::collectRows(pool, conditionCol.size(),
+          [&](size_t begin, size_t end, std::vector<size_t>& out) {
+            conditionCol.scanEquals(conditionValue, begin, end, out);
+          });
+    }
+    return matchingRows;
+  }
+
+  // Rows whose condition column lies in range, from a B+tree index unless the
+  // statistics say a scan is cheaper.
+  static std::vector<size_t> rangeRows(const Table& table, const ValueRange& range, const std::string& conditionColumn, size_t conditionIndex, ThreadPool* pool) {
+    const Value::Type conditionType = table.getColumnTypes()[conditionIndex];
+    if ((range.lower && range.lower->getType() != conditionType) ||
+        (range.upper && range.upper->getType() != conditionType)) {
+      throw std::invalid_argument("Type mismatch for column " + conditionColumn);
+    }
+
+    const std::optional<double> matches = CostModel::estimateRange(table, conditionIndex, range);
+    if (CostModel::chooseRangeIndex(table, conditionIndex, matches,
+                                    CostModel::scanCost(table.getRowCount(), matches.value_or(0), pool))) {
+      return table.searchRowsByIndexedRange(conditionColumn, range);
+    }
+    const Column& conditionCol = table.getColumn(conditionIndex);
+    return MorselScan::collectRows(pool, conditionCol.size(),
+        [&](size_t begin, size_t end, std::vector<size_t>& out) {
+          conditionCol.scanRange(range, begin, end, out);
+        });
+  }
+
+  // The conjuncts of where: its children if it is an AND, otherwise where itself.
+  static std::vector<const Expression*> conjunctsOf(const Expression& where) {
+    std::vector<const Expression*> conjuncts;
+    if (where.kind == Expression::Kind::AND) {
+      for (const Expression& child : where.children) conjuncts.push_back(&child);
+    } else {
+      conjuncts.push_back(&where);
+    }
+    return conjuncts;
+  }
+
+  static size_t leafCount(const Expression& expr) {
+    if (expr.isLeaf()) return 1;
+    size_t leaves = 0;
+    for (const Expression& child : expr.children) leaves += leafCount(child);
+    return leaves;
+  }
+
+  // The range a <, <=, >, >= or BETWEEN conjunct selects.
+  static ValueRange rangeOf(const Expression& conjunct, const std::vector<Value>& args) {
+    ValueRange range;
+    if (conjunct.kind == Expression::Kind::BETWEEN) {
+      range.lower = conjunct.operands[0].bind(args);
+      range.upper = conjunct.operands[1].bind(args);
+      return range;
+    }
+    const Value& value = conjunct.operands[0].bind(args);
+    switch (conjunct.comparison) {
+      case Expression::Comparison::LT: range.upper = value; range.upperInclusive = false; break;
+      case Expression::Comparison::LE: range.upper = value; break;
+      case Expression::Comparison::GT: range.lower = value; range.lowerInclusive = false; break;
+      default:                         range.lower = value; break;
+    }
+    return range;
+  }
+
+  // Whether an index could answer conjunct: a =, IN, <, <=, >, >= or BETWEEN
+  // leaf whose values all have the column's type.
+  static bool isIndexable(const Table& table, const Expression& conjunct, const std::vector<Value>& args) {
+    if (!conjunct.isLeaf() || conjunct.kind == Expression::Kind::IS_NULL) return false;
+    if (conjunct.kind == Expression::Kind::COMPARE && conjunct.comparison == Expression::Comparison::NE) return false;
+    const Value::Type type = table.getColumnTypes()[conjunct.columnIndex];
+    for (const Operand& operand : conjunct.operands) {
+      // Mismatched values are left to Predicate, which rejects or ignores them.
+      if (operand.bind(args).getType() != type) return false;
+    }
+    return true;
+  }
+
+  // Estimated rows matching an indexable conjunct, or nullopt without statistics.
+  static std::optional<double> estimateRows(const Table& table, const Expression& conjunct, const std::vector<Value>& args) {
+    if (conjunct.kind == Expression::Kind::IN) {
+      std::optional<double> total;
+      for (const Operand& operand : conjunct.operands) {
+        const std::optional<double> rows = CostModel::estimateEquals(table, conjunct.columnIndex, operand.bind(args));
+        if (!rows) return std::nullopt;
+        total = total.value_or(0) + *rows;
       }
+      return total;
+    }
+    if (conjunct.comparison == Expression::Comparison::EQ && conjunct.kind == Expression::Kind::COMPARE) {
+      return CostModel::estimateEquals(table, conjunct.columnIndex, conjunct.operands[0].bind(args));
+    }
+    return CostModel::estimateRange(table, conjunct.columnIndex, rangeOf(conjunct, args));
+  }
+
+  /**
+   * Answers one indexable conjunct from an index: = and IN from any index
+   * on the column, <, <=, >, >= and BETWEEN from a B+tree. Equality on a
+   * bitmap index is returned as a bitmap in bitmap so several of them can be
+   * ANDed before rows are materialized.
+   *
+   * @param matches Estimated matching rows, or nullopt without statistics.
+   * @param budget Cost of doing without an index; with statistics, no index
+   *               estimated to cost more is used.
+   * @return false if the conjunct has to be evaluated against the column.
+   */
+  static bool indexRows(const Table& table, const Expression& conjunct, const std::vector<Value>& args,
+                        std::optional<double> matches, double budget,
+                        std::vector<size_t>& rows, const RoaringBitmap*& bitmap) {
+    const std::string& column = conjunct.column;
+    if (conjunct.kind == Expression::Kind::COMPARE && conjunct.comparison == Expression::Comparison::EQ) {
+      const Value& value = conjunct.operands[0].bind(args);
+      const IndexDefinition* index = CostModel::chooseEqualityIndex(table, conjunct.columnIndex, matches, 1, budget);
+      if (!index) return false;
+      if (!matches || index->kind == IndexKind::BITMAP) {
+        if ((bitmap = table.searchBitmapByIndexedValue(column, value))) return true;
+      }
+      rows = table.searchRowsByIndex(*index, value);
+    } else if (conjunct.kind == Expression::Kind::IN) {
+      const IndexDefinition* index = CostModel::chooseEqualityIndex(table, conjunct.columnIndex, matches,
+                                                                    conjunct.operands.size(), budget);
+      if (!index) return false;
+      for (const Operand& operand : conjunct.operands) {
+        std::vector<size_t> found = table.searchRowsByIndex(*index, operand.bind(args));
+        rows.insert(rows.end(), found.begin(), found.end());
+      }
+    } else {
+      if (!CostModel::chooseRangeIndex(table, conjunct.columnIndex, matches, budget)) return false;
+      rows = table.searchRowsByIndexedRange(column, rangeOf(conjunct, args));
+    }
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    return true;
+  }
+
+  /**
+   * Rows matching a compound WHERE, in row order.
+   *
+   * Conjuncts that an index can answer produce candidate row sets (bitmap
+   * index results are ANDed as bitmaps first) which are intersected,
+   * smallest first; the remaining conjuncts are compiled into a Predicate
+   * and tested on the candidates only. Without a usable index the whole
+   * expression is compiled and run over the table in morsels.
+   *
+   * On an analyzed table the indexable conjuncts are taken most selective
+   * first. The first is looked up only if that, plus testing the rest of
+   * the expression on its rows, is estimated to beat the compiled scan;
+   * each later one only if the lookup beats testing it on the candidates
+   * found so far. The others join the residual predicate.
+   */
+  static std::vector<size_t> expressionRows(const Table& table, const Expression& where, const std::vector<Value>& args, ThreadPool* pool) {
+    std::vector<std::pair<const Expression*, std::optional<double>>> indexable;
+    Expression residual;
+    residual.kind = Expression::Kind::AND;
+    for (const Expression* conjunct : conjunctsOf(where)) {
+      if (isIndexable(table, *conjunct, args)) {
+        indexable.emplace_back(conjunct, estimateRows(table, *conjunct, args));
+      } else {
+        residual.children.push_back(*conjunct);
+      }
+    }
+    std::stable_sort(indexable.begin(), indexable.end(), [](const auto& a, const auto& b) {
+      return a.second && (!b.second || *a.second < *b.second);
+    });
+
+    // Rows the whole WHERE should return, taking the conjuncts as independent.
+    const double rowCount = static_cast<double>(table.getRowCount());
+    double estimatedResult = rowCount;
+    for (const auto& entry : indexable) {
+      if (entry.second && rowCount > 0) estimatedResult *= *entry.second / rowCount;
+    }
+    const size_t leaves = leafCount(where);
+
+    std::vector<std::vector<size_t>> rowSets;
+    std::optional<RoaringBitmap> bitmapRows;
+    double estimatedCandidates = rowCount;
+    bool narrowed = false;
+    for (const auto& [conjunct, matches] : indexable) {
+      double budget = std::numeric_limits<double>::infinity();
+      if (matches && narrowed) {
+        budget = estimatedCandidates * CostModel::RESIDUAL_ROW_COST;
+      } else if (matches) {
+        // The scan, less testing the other leaves on the rows this lookup returns.
+        budget = CostModel::expressionScanCost(table.getRowCount(), leaves, estimatedResult, pool) -
+                 *matches * static_cast<double>(leaves - 1) * CostModel::RESIDUAL_ROW_COST;
+      }
+      std::vector<size_t> rows;
+      const RoaringBitmap* bitmap = nullptr;
+      if (!indexRows(table, *conjunct, args, matches, budget, rows, bitmap)) {
+        residual.children.push_back(*conjunct);
+        continue;
+      }
+      narrowed = true;
+      if (matches) estimatedCandidates = std::min(estimatedCandidates, *matches);
+      if (bitmap) {
+        bitmapRows = bitmapRows ? (*bitmapRows & *bitmap) : *bitmap;
+      } else {
+        rowSets.push_back(std::move(rows));
+      }
+    }
+    if (bitmapRows) {
+      rowSets.push_back(bitmapRows->toRows());
+    }
+
+    if (rowSets.empty()) {
+      const Predicate predicate = Predicate::compile(table, where, args);
+      return MorselScan::collectRows(pool, table.getRowCount(),
+          [&](size_t begin, size_t end, std::vector<size_t>& out) {
+            std::vector<uint8_t> mask(end - begin);
+            predicate.evaluate(begin, end - begin, mask.data());
+            for (size_t i = 0; i < mask.size(); ++i) {
+              if (mask[i]) out.push_back(begin + i);
+            }
+          });
+    }
+
+    std::sort(rowSets.begin(), rowSets.end(),
+              [](const std::vector<size_t>& a, const std::vector<size_t>& b) { return a.size() < b.size(); });
+    std::vector<size_t> candidates = std::move(rowSets[0]);
+    for (size_t i = 1; i < rowSets.size() && !candidates.empty(); ++i) {
+      std::vector<size_t> both;
+      std::set_intersection(candidates.begin(), candidates.end(), rowSets[i].begin(), rowSets[i].end(),
+                            std::back_inserter(both));
+      candidates = std::move(both);
+    }
+    if (residual.children.empty() || candidates.empty()) {
+      return candidates;
+    }
+
+    const Predicate predicate = Predicate::compile(table, residual.children.size() == 1 ? residual.children[0] : residual, args);
+    return MorselScan::collectRows(pool, candidates.size(),
+        [&](size_t begin, size_t end, std::vector<size_t>& out) {
+          std::vector<uint8_t> mask(end - begin);
+          predicate.evaluate(candidates.data() + begin, end - begin, mask.data());
+          for (size_t i = 0; i < mask.size(); ++i) {
+            if (mask[i]) out.push_back(candidates[begin + i]);
+          }
+        });
+  }
+
+  // Materializes the projected columns for the given rows, one column at a time,
+  // each column filled in morsels of rows on pool.
+  static std::unordered_map<std::string, std::vector<Value>> projectRows(ThreadPool* pool, const Table& table, const std::vector<std::string>& columnNames, const std::vector<size_t>& colIndices, const std::vector<size_t>& rows) {
+    std::unordered_map<std::string, std::vector<Value>> result;
+    for (size_t j = 0; j < colIndices.size(); ++j) {
+      const Column& column = table.getColumn(colIndices[j]);
+      std::vector<Value>& out = result[columnNames[j]];
+      out.resize(rows.size());
+      MorselScan::forEachMorsel(pool, rows.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          out[i] = column.getValue(rows[i]);
+        }
+      });
     }
     return result;
   }
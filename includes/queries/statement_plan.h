@@ -0,0 +1,137 @@
+#ifndef STATEMENT_PLAN_H
+#define STATEMENT_PLAN_H
+
+#include "../value.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+/*
+===========================================================================
+Statement plans:
+Parsed forms of SELECT and INSERT. The processors build them once from the
+statement text (SelectProcessor::parse, InsertProcessor::parse) and
+QueryProcessor caches them, so running the same text again, or EXECUTE on
+a prepared statement, skips tokenizing, literal parsing and, for SELECT,
+column name resolution.
+
+A literal written as ? is a placeholder. Placeholders are numbered from 0
+in order of appearance and filled from the EXECUTE arguments by
+Operand::bind.
+===========================================================================
+*/
+
+struct Operand {
+  Value literal;
+  int parameter = -1; // Placeholder number, or -1 for a literal
+
+  static Operand placeholder(size_t number) {
+    Operand operand;
+    operand.parameter = static_cast<int>(number);
+    return operand;
+  }
+
+  const Value& bind(const std::vector<Value>& args) const {
+    return parameter < 0 ? literal : args[static_cast<size_t>(parameter)];
+  }
+};
+
+/*
+WHERE expression tree. Leaves test one column (COMPARE, BETWEEN, IN,
+IS_NULL); AND/OR combine two or more children and NOT negates one.
+columnIndex is resolved against the table when the plan is built.
+*/
+struct Expression {
+  enum class Kind { COMPARE, BETWEEN, IN, IS_NULL, AND, OR, NOT };
+  enum class Comparison { EQ, NE, LT, LE, GT, GE };
+
+  Kind kind = Kind::COMPARE;
+  std::string column;                // Leaves
+  size_t columnIndex = 0;
+  Comparison comparison = Comparison::EQ; // COMPARE
+  std::vector<Operand> operands;     // COMPARE: 1, BETWEEN: low and high, IN: the list
+  bool negated = false;              // IS NOT NULL
+  std::vector<Expression> children;  // AND, OR, NOT
+
+  bool isLeaf() const { return kind != Kind::AND && kind != Kind::OR && kind != Kind::NOT; }
+};
+
+/*
+FROM a JOIN b ON a.x = b.y. The FROM table's WHERE conjuncts stay in the
+SelectPlan's filter; those on the joined table are kept here, so each side
+is filtered before the join.
+*/
+struct JoinPlan {
+  std::string tableName;                // The joined table
+  size_t schemaColumns = 0;             // Its column count when resolved
+  size_t leftKey = 0;                   // Join column of the FROM table
+  size_t rightKey = 0;                  // Join column of the joined table
+  std::optional<Expression> where;      // Conjuncts on the joined table
+};
+
+/*
+Aggregate call in a SELECT list: COUNT(*), COUNT([DISTINCT] column),
+SUM, MIN, MAX or AVG of a column. columnIndex (and side, for a join) is
+resolved when the plan is built.
+*/
+struct Aggregate {
+  enum class Function { COUNT, SUM, MIN, MAX, AVG };
+
+  Function function = Function::COUNT;
+  bool star = false;     // COUNT(*)
+  bool distinct = false; // COUNT(DISTINCT column)
+  std::string column;
+  size_t columnIndex = 0;
+  uint8_t side = 0;      // JOIN: 1 if the column is the joined table's
+};
+
+struct SelectPlan {
+  // EQUALS and RANGE are a single "col = v" or range predicate; anything
+  // else in WHERE is an EXPRESSION.
+  enum class Filter { NONE, EQUALS, RANGE, EXPRESSION };
+
+  std::string tableName;
+  std::vector<std::string> columnNames; // Output columns, * already expanded
+  std::vector<size_t> colIndices;       // Resolved position of each output column
+  size_t schemaColumns = 0;             // Column count of the table when resolved
+
+  Filter filter = Filter::NONE;
+  std::string conditionColumn;
+  size_t conditionIndex = 0;
+  Operand value;                        // EQUALS
+  std::optional<Operand> lower, upper;  // RANGE; a missing bound is open
+  bool lowerInclusive = true;
+  bool upperInclusive = true;
+  Expression where;                     // EXPRESSION
+  std::optional<JoinPlan> join;
+  std::vector<uint8_t> columnSides;     // JOIN: 0 if an output column is the FROM table's, 1 if the joined table's
+
+  // Set when the SELECT list has aggregates or there is a GROUP BY. Output
+  // column i is then GROUP BY column outputs[i] if that is below
+  // groupIndices.size(), and otherwise aggregate outputs[i] - groupIndices.size();
+  // colIndices and columnSides are unused.
+  bool aggregated = false;
+  std::vector<size_t> groupIndices;     // Resolved position of each GROUP BY column
+  std::vector<uint8_t> groupSides;      // JOIN: table of each GROUP BY column
+  std::vector<Aggregate> aggregates;
+  std::vector<size_t> outputs;
+};
+
+struct InsertPlan {
+  std::string tableName;
+  std::vector<std::vector<Operand>> rows;
+};
+
+struct StatementPlan {
+  enum class Kind { SELECT, INSERT };
+
+  Kind kind = Kind::SELECT;
+  std::string text; // Normalized statement text the plan was built from
+  size_t parameterCount = 0;
+  SelectPlan select; // Kind::SELECT
+  InsertPlan insert; // Kind::INSERT
+};
+
+#endif
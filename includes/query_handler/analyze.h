@@ -0,0 +1,84 @@
+#ifndef ANALYZE_PROCESSOR_H
+#define ANALYZE_PROCESSOR_H
+
+#include "../storage.h"
+#include "../table.h"
+#include "../table_statistics.h"
+#include "../value.h"
+#include "lexer.h"
+#include <iostream>
+#include <string>
+
+class AnalyzeProcessor {
+private:
+  Storage& storage;
+
+  static void printValue(const Value& val) {
+    switch(val.getType()) {
+      case Value::INT:
+        std::cout << val.getInt();
+        break;
+      case Value::STRING:
+        std::cout << val.getStringView();
+        break;
+      case Value::BOOL:
+        std::cout << (val.getBool() ? "true" : "false");
+        break;
+      default:
+        std::cout << "NULL";
+        break;
+    }
+  }
+
+public:
+  AnalyzeProcessor(Storage& store) : storage(store) {}
+
+  /**
+   * Executes ANALYZE table: collects row counts, distinct counts, null
+   * counts and equi-depth histograms for every column, stores them in the
+   * table file and prints a summary. SELECT uses them to choose between
+   * index lookups and scans.
+   *
+   * @param query The ANALYZE statement.
+   * @example
+   * AnalyzeProcessor analyzeProcessor(storage);
+   * analyzeProcessor.execute("ANALYZE users");
+   */
+  void execute(const std::string& query) {
+    const char* usage = "Invalid ANALYZE syntax. Use: ANALYZE tablename";
+    std::string tableName;
+    try {
+      Lexer lexer(query);
+      lexer.expectKeyword("ANALYZE", usage);
+      tableName = lexer.expectName(usage);
+      lexer.expectEnd(usage);
+    } catch(const SyntaxError& e) {
+      std::cerr << e.what() << std::endl;
+      return;
+    }
+
+    try {
+      storage.analyzeTable(tableName);
+      const Table& table = storage.getTableConst(tableName);
+      const TableStatistics* stats = table.getStatistics();
+      const std::vector<std::string> columnNames = table.getColumnNames();
+      std::cout << "Analyzed " << tableName << ": " << stats->rowCount << " rows" << std::endl;
+      for(size_t i = 0; i < columnNames.size(); i++) {
+        const ColumnStatistics& column = stats->columns[i];
+        std::cout << "  " << columnNames[i] << ": " << column.distinctCount << " distinct, "
+                  << column.nullCount << " null";
+        if(!column.bounds.empty()) {
+          std::cout << ", min ";
+          printValue(column.bounds.front());
+          std::cout << ", max ";
+          printValue(column.bounds.back());
+        }
+        std::cout << std::endl;
+      }
+    } catch(const std::exception& e) {
+      std::cerr << "ANALYZE failed: " << e.what() << std::endl;
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef COPY_PROCESSOR_H
+#define COPY_PROCESSOR_H
+
+#include "../storage.h"
+#include "../table.h"
+#include "../value.h"
+#include "../persistence/csv_reader.h"
+#include "../persistence/mapped_file.h"
+#include "lexer.h"
+#include <cctype>
+#include <charconv>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class CopyProcessor {
+private:
+  Storage& storage;
+
+  static constexpr size_t BATCH_ROWS = 64 * 1024;
+
+  static bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+      if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) return false;
+    }
+    return true;
+  }
+
+  // Converts a CSV field to the column's type. Fields are never guessed: the schema decides.
+  static Value parseField(std::string_view text, Value::Type type, size_t line, size_t column) {
+    switch (type) {
+      case Value::INT: {
+        std::string_view digits = text;
+        if (!digits.empty() && digits.front() == '+') digits.remove_prefix(1);
+        int value = 0;
+        auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+        if (error == std::errc() && end == digits.data() + digits.size() && !digits.empty()) {
+          return Value(value);
+        }
+        break;
+      }
+      case Value::BOOL:
+        if (equalsIgnoreCase(text, "true") || text == "1") return Value(true);
+        if (equalsIgnoreCase(text, "false") || text == "0") return Value(false);
+        break;
+      case Value::STRING:
+        return Value(text);
+      default:
+        break;
+    }
+    throw std::invalid_argument("CSV line " + std::to_string(line) + ", field " + std::to_string(column + 1) +
+                                ": invalid " + Value::typeToString(type) + " '" + std::string(text) + "'");
+  }
+
+public:
+  CopyProcessor(Storage& store) : storage(store) {}
+
+  /**
+   * Executes COPY table FROM 'file.csv' [HEADER], bulk loading a CSV file.
+   * Each record must have one field per column, in column order; fields are
+   * converted according to the column types (BOOL accepts true/false/1/0).
+   * HEADER skips the first record. The load is all or nothing: on the first
+   * bad record nothing is added and the error names its line.
+   *
+   * @param query The COPY statement.
+   * @example
+   * CopyProcessor copyProcessor(storage);
+   * copyProcessor.execute("COPY users FROM '/data/users.csv' HEADER");
+   */
+  void execute(const std::string& query) {
+    const char* usage = "Invalid COPY syntax. Use: COPY tablename FROM 'file.csv' [HEADER]";
+    std::string tableName, path;
+    bool header = false;
+    try {
+      Lexer lexer(query);
+      lexer.expectKeyword("COPY", usage);
+      tableName = lexer.expectName(usage);
+      lexer.expectKeyword("FROM", usage);
+      if(lexer.peek().kind != Token::Kind::STRING || lexer.peek().text.empty()) throw SyntaxError(usage);
+      path = lexer.next().text;
+      header = lexer.acceptKeyword("HEADER");
+      lexer.expectEnd(usage);
+    } catch(const SyntaxError& e) {
+      std::cerr << e.what() << std::endl;
+      return;
+    }
+
+    try {
+      const std::vector<Value::Type> types = storage.getTableConst(tableName).getColumnTypes();
+      MappedFile file(path);
+      CsvReader reader(reinterpret_cast<const char*>(file.data()), file.size());
+      std::vector<std::string_view> fields;
+      if(header) {
+        reader.nextRecord(fields);
+      }
+
+      size_t loaded = storage.copyRows(tableName, [&](std::vector<std::vector<Value>>& batch) {
+        batch.resize(BATCH_ROWS);
+        size_t count = 0;
+        while(count < BATCH_ROWS && reader.nextRecord(fields)) {
+          const size_t line = reader.recordLineNumber();
+          if(fields.size() != types.size()) {
+            throw std::invalid_argument("CSV line " + std::to_string(line) + ": expected " +
+                                        std::to_string(types.size()) + " fields, found " + std::to_string(fields.size()));
+          }
+          std::vector<Value>& row = batch[count++];
+          row.resize(types.size());
+          for(size_t i = 0; i < types.size(); ++i) {
+            row[i] = parseField(fields[i], types[i], line, i);
+          }
+        }
+        batch.resize(count);
+        return count > 0;
+      });
+      std::cout << "Copied " << loaded << " rows into " << tableName << std::endl;
+    } catch(const std::exception& e) {
+      std::cerr << "COPY failed: " << e.what() << std::endl;
+    }
+  }
+};
+
+#endif
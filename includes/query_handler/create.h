@@ -4,44 +4,55 @@
 #include "../storage.h"
 #include "../table.h"
 #include "../value.h"
+#include "lexer.h"
 #include <iostream>
 #include <vector>
 #include <string>
-#include <sstream>
 
 class CreateProcessor {
 private:
   Storage& storage;
-  std::stringstream ss;
 public:
     CreateProcessor(Storage& store) : storage(store) {}
     
     /**
-     * Executes a simple SQL-like query.
-     * Supports CREATE TABLE, INSERT INTO, SELECT, and WHERE statements.
+     * Executes CREATE TABLE name col1 TYPE, col2 TYPE, ...
+     * Commas between column definitions are optional.
      * 
-     * @param query The SQL-like query string to execute.
+     * @param query The CREATE TABLE statement.
      * @example
-     * QueryProcessor qp(storage);
-     * qp.execute("CREATE TABLE users id INT,name STRING,age INT");
-     * qp.execute("INSERT INTO users VALUES 1,\"Alice\",30");
-     * qp.execute("SELECT * FROM users");
+     * CreateProcessor createProcessor(storage);
+     * createProcessor.execute("CREATE TABLE users id INT, name STRING, age INT");
      */
     void execute(const std::string query){
-      ss.str(query);
-      std::string tableToken, tableName;
-      ss >> tableToken >> tableName;
+      const char* usage = "Invalid CREATE syntax. Use: CREATE TABLE tablename col1 TYPE, col2 TYPE, ...";
+      std::string tableName;
       std::vector<std::string> columns;
       std::vector<Value::Type> columnTypes;
-      std::string col, type;
-      while(ss >> col >> type) {
-        if(type.back() == ',') {
-          type.pop_back();
+      try {
+        Lexer lexer(query);
+        lexer.expectKeyword("CREATE", usage);
+        lexer.expectKeyword("TABLE", usage);
+        tableName = lexer.expectName(usage);
+        while(!lexer.atEnd()) {
+          columns.emplace_back(lexer.expectName(usage));
+          columnTypes.push_back(Value::stringToType(std::string(lexer.expectName(usage))));
+          lexer.acceptSymbol(",");
         }
-        columns.push_back(col);
-        columnTypes.push_back(Value::stringToType(type));
+      } catch(const SyntaxError& e) {
+        std::cerr << e.what() << std::endl;
+        return;
+      } catch(const std::exception& e) {
+        std::cerr << "Create failed: " << e.what() << std::endl;
+        return;
+      }
+
+      try {
+        storage.createTable(tableName, columns, columnTypes);
+      } catch(const std::exception& e) {
+        std::cerr << "Create failed: " << e.what() << std::endl;
+        return;
       }
-      storage.createTable(tableName, columns, columnTypes);
       std::cout << "Table " << tableName << " created with columns: ";
       for(const auto& column : columns) {
         std::cout << column << " ";
@@ -52,4 +63,4 @@ public:
 };
 
 
-#endif
\ No newline at end of file
+#endif
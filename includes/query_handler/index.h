@@ -0,0 +1,106 @@
+#ifndef INDEX_PROCESSOR_H
+#define INDEX_PROCESSOR_H
+
+#include "../storage.h"
+#include "../indexing/index_manager.h"
+#include "lexer.h"
+#include <iostream>
+#include <string>
+
+class IndexProcessor {
+private:
+  Storage& storage;
+
+  bool isBoolColumn(const std::string& tableName, const std::string& column) {
+    const Table& table = storage.getTableConst(tableName);
+    auto it = table.getColumnIndexMap().find(column);
+    return it != table.getColumnIndexMap().end() && table.getColumnTypes()[it->second] == Value::BOOL;
+  }
+
+public:
+  IndexProcessor(Storage& store) : storage(store) {}
+
+  /**
+   * Executes CREATE INDEX name ON table(column) [USING btree|hash|bitmap].
+   * Without USING, BOOL columns get a bitmap index and other columns a B+tree.
+   *
+   * @param query The CREATE INDEX statement.
+   * @example
+   * IndexProcessor ip(storage);
+   * ip.executeCreate("CREATE INDEX users_age ON users(age) USING btree");
+   */
+  void executeCreate(const std::string& query) {
+    const char* usage = "Invalid CREATE INDEX syntax. Use: CREATE INDEX name ON table(column) [USING btree|hash|bitmap]";
+    IndexDefinition definition;
+    std::string tableName, method;
+    try {
+      Lexer lexer(query);
+      lexer.expectKeyword("CREATE", usage);
+      lexer.expectKeyword("INDEX", usage);
+      definition.name = lexer.expectName(usage);
+      lexer.expectKeyword("ON", usage);
+      tableName = lexer.expectName(usage);
+      lexer.expectSymbol("(", usage);
+      definition.column = lexer.expectName(usage);
+      lexer.expectSymbol(")", usage);
+      if(lexer.acceptKeyword("USING")) {
+        method = lexer.expectName(usage);
+      }
+      lexer.expectEnd(usage);
+    } catch(const SyntaxError& e) {
+      std::cerr << e.what() << std::endl;
+      return;
+    }
+    const std::string& indexName = definition.name;
+
+    try {
+      if(!method.empty()) {
+        definition.kind = IndexDefinition::stringToKind(method);
+      } else if(isBoolColumn(tableName, definition.column)) {
+        // A B+tree over two keys is all duplicates; a bitmap per value is smaller and faster.
+        definition.kind = IndexKind::BITMAP;
+      }
+      storage.createIndex(tableName, definition);
+    } catch(const std::exception& e) {
+      std::cerr << "CREATE INDEX failed: " << e.what() << std::endl;
+      return;
+    }
+    std::cout << "Index " << indexName << " created on " << tableName << "(" << definition.column << ")"
+              << " using " << IndexDefinition::kindToString(definition.kind) << std::endl;
+  }
+
+  /**
+   * Executes DROP INDEX name ON table.
+   *
+   * @param query The DROP INDEX statement.
+   * @example
+   * IndexProcessor ip(storage);
+   * ip.executeDrop("DROP INDEX users_age ON users");
+   */
+  void executeDrop(const std::string& query) {
+    const char* usage = "Invalid DROP INDEX syntax. Use: DROP INDEX name ON table";
+    std::string indexName, tableName;
+    try {
+      Lexer lexer(query);
+      lexer.expectKeyword("DROP", usage);
+      lexer.expectKeyword("INDEX", usage);
+      indexName = lexer.expectName(usage);
+      lexer.expectKeyword("ON", usage);
+      tableName = lexer.expectName(usage);
+      lexer.expectEnd(usage);
+    } catch(const SyntaxError& e) {
+      std::cerr << e.what() << std::endl;
+      return;
+    }
+
+    try {
+      storage.dropIndex(tableName, indexName);
+    } catch(const std::exception& e) {
+      std::cerr << "DROP INDEX failed: " << e.what() << std::endl;
+      return;
+    }
+    std::cout << "Index " << indexName << " dropped from " << tableName << std::endl;
+  }
+};
+
+#endif
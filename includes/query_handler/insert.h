@@ -7,62 +7,115 @@
 #include "../indexing/index_manager.h"
 #include "../indexing/btree.h"
 #include "../queries/insert.h"
+#include "../queries/statement_plan.h"
+#include "lexer.h"
+#include "literal_parser.h"
 #include <iostream>
 #include <vector>
 #include <string>
-#include <sstream>
+#include <string_view>
 
 class InsertProcessor {
 private:
   Storage& storage;
+
 public:
   InsertProcessor(Storage& storage) : storage(storage) {}
 
-  void execute(const std::string& query){
-      std::stringstream ss(query);
-      std::string intoToken, tableName, valuesToken;
-      ss >> intoToken >> tableName >> valuesToken;
-      
-      if(intoToken != "INTO" || valuesToken != "VALUES") {
-        std::cerr << "Invalid INSERT syntax. Use: INSERT INTO tablename VALUES val1, val2, ..." << std::endl;
-        return;
+  /**
+   * Parses an INSERT statement into a plan. Two forms are accepted:
+   *   INSERT INTO t VALUES v1, v2, ...                  (one row)
+   *   INSERT INTO t VALUES (v1, v2, ...), (v1, ...), ... (any number of rows)
+   * Any value may be a ? placeholder.
+   *
+   * @param query The INSERT statement.
+   * @return The parsed statement.
+   * @throws SyntaxError if the statement is malformed.
+   *
+   * @example
+   * StatementPlan plan = insertProcessor.parse("INSERT INTO users VALUES (?, ?)");
+   */
+  StatementPlan parse(const std::string& query) const {
+    const char* usage = "Invalid INSERT syntax. Use: INSERT INTO tablename VALUES val1, val2, ..."
+                        " or INSERT INTO tablename VALUES (val1, ...), (val1, ...)";
+    const char* tupleUsage = "Invalid VALUES list. Use: VALUES (val1, val2, ...), (val1, val2, ...)";
+    Lexer lexer(query);
+    lexer.expectKeyword("INSERT", usage);
+    lexer.expectKeyword("INTO", usage);
+    std::string_view tableName = lexer.expectName(usage);
+    lexer.expectKeyword("VALUES", usage);
+
+    StatementPlan plan;
+    plan.kind = StatementPlan::Kind::INSERT;
+    plan.text = query;
+    plan.insert.tableName = tableName;
+    std::vector<std::vector<Operand>>& rows = plan.insert.rows;
+    if(lexer.peek().isSymbol("(")) {
+      LiteralParser::parseTuples(lexer, rows, plan.parameterCount, tupleUsage);
+      lexer.expectEnd(tupleUsage);
+    } else {
+      // Single-row form: values separated by commas or whitespace.
+      std::vector<Operand>& values = rows.emplace_back();
+      while(!lexer.atEnd()) {
+        values.push_back(LiteralParser::parseOperand(lexer, plan.parameterCount));
+        lexer.acceptSymbol(",");
       }
-      
-      std::vector<Value> values;
-      std::string val;
-      while(ss >> val) {
-        if(val.back() == ',') {
-          val.pop_back();
-        }
+    }
+    return plan;
+  }
 
-        if(val == "true" || val == "false") {
-          values.emplace_back(val == "true");
-        } else if(val.size() >= 2 && val.front() == '"' && val.back() == '"') {
-          // Handle quoted strings
-          std::string str_content = val.substr(1, val.size() - 2);
-          values.emplace_back(str_content);
-        } else {
-          try {
-            int intValue = std::stoi(val);
-            values.emplace_back(intValue);
-          } catch(...) {
-            values.emplace_back(val);
-          }
+  /**
+   * Runs a parsed INSERT with the given placeholder values. A multi-row
+   * INSERT is a single statement: if any row is rejected, none is inserted.
+   *
+   * @param plan Plan from parse.
+   * @param args One value per placeholder.
+   */
+  void execute(const StatementPlan& plan, const std::vector<Value>& args) {
+    const InsertPlan& insert = plan.insert;
+    if(args.size() != plan.parameterCount) {
+      std::cerr << "Insert failed: expected " << plan.parameterCount << " parameter value(s), got " << args.size() << std::endl;
+      return;
+    }
+    try {
+      std::vector<std::vector<Value>> rows(insert.rows.size());
+      for(size_t r = 0; r < rows.size(); ++r) {
+        rows[r].reserve(insert.rows[r].size());
+        for(const Operand& operand : insert.rows[r]) {
+          rows[r].push_back(operand.bind(args));
         }
       }
-      
-      try {
-        InsertQuery insertQuery(storage);
-        insertQuery.insertInto(tableName, values);
-        // Also persist the table after insertion
-        storage.persistTable(tableName);
-        std::cout << "Inserted values into " << tableName << std::endl;
-      } catch(const std::exception& e) {
-        std::cerr << "Insert failed: " << e.what() << std::endl;
-      } catch(const char* msg) {
-        std::cerr << "Insert failed: " << msg << std::endl;
+
+      InsertQuery insertQuery(storage);
+      if(rows.size() == 1) {
+        insertQuery.insertInto(insert.tableName, rows[0]);
+        std::cout << "Inserted values into " << insert.tableName << std::endl;
+      } else {
+        insertQuery.insertRows(insert.tableName, rows);
+        std::cout << "Inserted " << rows.size() << " rows into " << insert.tableName << std::endl;
       }
+    } catch(const std::exception& e) {
+      std::cerr << "Insert failed: " << e.what() << std::endl;
+    } catch(const char* msg) {
+      std::cerr << "Insert failed: " << msg << std::endl;
+    }
+  }
+
+  /**
+   * Parses and runs an INSERT statement without placeholders.
+   *
+   * @param query The INSERT statement.
+   * @example
+   * InsertProcessor insertProcessor(storage);
+   * insertProcessor.execute("INSERT INTO users VALUES (1, \"Alice\", true), (2, \"Bob\", false)");
+   */
+  void execute(const std::string& query) {
+    try {
+      execute(parse(query), {});
+    } catch(const SyntaxError& e) {
+      std::cerr << e.what() << std::endl;
     }
+  }
 
 };
 
@@ -0,0 +1,192 @@
+#ifndef LEXER_H
+#define LEXER_H
+
+#include <cctype>
+#include <charconv>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Raised for malformed statement text, as opposed to errors during execution.
+class SyntaxError : public std::invalid_argument {
+public:
+  using std::invalid_argument::invalid_argument;
+};
+
+/*
+===========================================================================
+Token:
+One lexical unit of a statement. text is a view into the statement text,
+so a token is only valid while the statement is.
+
+  WORD      keyword, name or unquoted value (FROM, users, hello, 12abc)
+  NUMBER    whole token is a decimal int, optionally negative (42, -7);
+            its value is in number
+  STRING    "double" or 'single' quoted text; text excludes the quotes
+  SYMBOL    ( ) , ; * = < <= > >= <> !=
+  PARAMETER ?
+  END       end of the statement
+===========================================================================
+*/
+struct Token {
+  enum class Kind { END, WORD, NUMBER, STRING, SYMBOL, PARAMETER };
+
+  Kind kind = Kind::END;
+  std::string_view text;
+  size_t offset = 0; // Position in the statement text
+  int number = 0;    // Kind::NUMBER
+
+  bool isSymbol(std::string_view symbol) const {
+    return kind == Kind::SYMBOL && text == symbol;
+  }
+
+  // Keywords are matched case-insensitively.
+  bool isKeyword(std::string_view keyword) const {
+    if(kind != Kind::WORD || text.size() != keyword.size()) return false;
+    for(size_t i = 0; i < text.size(); ++i) {
+      if(std::toupper(static_cast<unsigned char>(text[i])) != keyword[i]) return false;
+    }
+    return true;
+  }
+
+  // A literal value or a ? placeholder.
+  bool isValue() const {
+    return kind == Kind::WORD || kind == Kind::NUMBER || kind == Kind::STRING || kind == Kind::PARAMETER;
+  }
+};
+
+/*
+===========================================================================
+Lexer Class:
+Hand-written lexer shared by the query processors. It scans the statement
+text once, left to right, keeping one token of lookahead; tokens are views
+into the text, so lexing never allocates, and numbers are converted with
+std::from_chars rather than by trying std::stoi and catching the failure.
+
+An unquoted value runs until whitespace or one of ( ) , ; * = < > ! ? " '
+so "id,name" is three tokens. A quoted string may contain anything except
+its own quote character.
+===========================================================================
+*/
+class Lexer {
+private:
+  std::string_view input;
+  size_t pos = 0;
+  Token current;
+
+  static bool isDelimiter(char c) {
+    switch(c) {
+      case '(': case ')': case ',': case ';': case '*': case '=':
+      case '<': case '>': case '!': case '?': case '"': case '\'':
+        return true;
+      default:
+        return std::isspace(static_cast<unsigned char>(c)) != 0;
+    }
+  }
+
+  // Lexes the token starting at pos into current.
+  void advance() {
+    while(pos < input.size() && std::isspace(static_cast<unsigned char>(input[pos]))) ++pos;
+    current = Token();
+    current.offset = pos;
+    if(pos >= input.size()) return;
+
+    const char c = input[pos];
+    if(c == '"' || c == '\'') {
+      const size_t close = input.find(c, pos + 1);
+      if(close == std::string_view::npos) {
+        throw SyntaxError("Unterminated string starting at position " + std::to_string(pos + 1));
+      }
+      current.kind = Token::Kind::STRING;
+      current.text = input.substr(pos + 1, close - pos - 1);
+      pos = close + 1;
+      return;
+    }
+    if(c == '?') {
+      current.kind = Token::Kind::PARAMETER;
+      current.text = input.substr(pos++, 1);
+      return;
+    }
+    if(isDelimiter(c)) {
+      // Two-character comparisons first, then single characters.
+      size_t length = 1;
+      if(pos + 1 < input.size()) {
+        const char d = input[pos + 1];
+        if((c == '<' && (d == '=' || d == '>')) || (c == '>' && d == '=') || (c == '!' && d == '=')) length = 2;
+      }
+      current.kind = Token::Kind::SYMBOL;
+      current.text = input.substr(pos, length);
+      pos += length;
+      return;
+    }
+
+    const size_t start = pos;
+    while(pos < input.size() && !isDelimiter(input[pos])) ++pos;
+    current.text = input.substr(start, pos - start);
+    const char* first = current.text.data();
+    const char* last = first + current.text.size();
+    auto [end, error] = std::from_chars(first, last, current.number);
+    current.kind = (error == std::errc() && end == last) ? Token::Kind::NUMBER : Token::Kind::WORD;
+  }
+
+public:
+  /**
+   * @param input Statement text; must outlive the lexer and its tokens.
+   * @throws SyntaxError if the first token is an unterminated string.
+   */
+  explicit Lexer(std::string_view input) : input(input) { advance(); }
+
+  // The next token, without consuming it.
+  const Token& peek() const { return current; }
+
+  // Consumes and returns the next token.
+  Token next() {
+    Token token = current;
+    advance();
+    return token;
+  }
+
+  // Consumes the next token if it is keyword.
+  bool acceptKeyword(std::string_view keyword) {
+    if(!current.isKeyword(keyword)) return false;
+    advance();
+    return true;
+  }
+
+  // Consumes the next token if it is symbol.
+  bool acceptSymbol(std::string_view symbol) {
+    if(!current.isSymbol(symbol)) return false;
+    advance();
+    return true;
+  }
+
+  void expectKeyword(std::string_view keyword, const char* message) {
+    if(!acceptKeyword(keyword)) throw SyntaxError(message);
+  }
+
+  void expectSymbol(std::string_view symbol, const char* message) {
+    if(!acceptSymbol(symbol)) throw SyntaxError(message);
+  }
+
+  // Consumes a name (table, column, index, setting); quoted names are allowed.
+  std::string_view expectName(const char* message) {
+    if(current.kind != Token::Kind::WORD && current.kind != Token::Kind::STRING) throw SyntaxError(message);
+    return next().text;
+  }
+
+  // True at the end of the statement or at a trailing ';'.
+  bool atEnd() {
+    if(current.isSymbol(";")) advance();
+    return current.kind == Token::Kind::END;
+  }
+
+  void expectEnd(const char* message) {
+    if(!atEnd()) throw SyntaxError(message);
+  }
+
+  // Statement text from the next token on.
+  std::string_view rest() const { return input.substr(current.offset); }
+};
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef LITERAL_PARSER_H
+#define LITERAL_PARSER_H
+
+#include "../value.h"
+#include "../queries/statement_plan.h"
+#include "lexer.h"
+#include <string>
+#include <vector>
+
+/*
+===========================================================================
+LiteralParser:
+Parses the literal values of INSERT statements, WHERE clauses and EXECUTE
+argument lists from a Lexer. A literal's type is inferred from its token:
+true/false, quoted string, integer, otherwise an unquoted string. A ? is a
+placeholder.
+===========================================================================
+*/
+class LiteralParser {
+public:
+  static Value toValue(const Token& token) {
+    switch(token.kind) {
+      case Token::Kind::NUMBER:
+        return Value(token.number);
+      case Token::Kind::STRING:
+        return Value(token.text);
+      default:
+        if(token.text == "true" || token.text == "false") {
+          return Value(token.text == "true");
+        }
+        return Value(token.text);
+    }
+  }
+
+  /**
+   * Consumes one literal or, for ?, the next placeholder.
+   *
+   * @param lexer Positioned at the value.
+   * @param parameterCount Number of placeholders seen so far; incremented per ?.
+   * @return The operand.
+   * @throws SyntaxError if the next token is not a value.
+   */
+  static Operand parseOperand(Lexer& lexer, size_t& parameterCount) {
+    const Token& token = lexer.peek();
+    if(!token.isValue()) {
+      throw SyntaxError("Expected a value at position " + std::to_string(token.offset + 1));
+    }
+    if(token.kind == Token::Kind::PARAMETER) {
+      lexer.next();
+      return Operand::placeholder(parameterCount++);
+    }
+    Operand operand;
+    operand.literal = toValue(lexer.next());
+    return operand;
+  }
+
+  /**
+   * Parses one "(v1, v2, ...)" into row.
+   *
+   * @param lexer Positioned at the '('.
+   * @param row Receives one operand per value.
+   * @param parameterCount Number of placeholders seen so far; incremented per ?.
+   * @param allowEmpty Whether "()" is accepted.
+   * @param message Error message for a malformed list.
+   * @throws SyntaxError on a malformed list.
+   */
+  static void parseTuple(Lexer& lexer, std::vector<Operand>& row, size_t& parameterCount, bool allowEmpty,
+                         const char* message) {
+    lexer.expectSymbol("(", message);
+    if(allowEmpty && lexer.acceptSymbol(")")) return;
+    do {
+      row.push_back(parseOperand(lexer, parameterCount));
+    } while(lexer.acceptSymbol(","));
+    lexer.expectSymbol(")", message);
+  }
+
+  /**
+   * Parses "(v1, v2, ...), (v1, v2, ...)". Quoted strings may contain
+   * commas, parentheses and spaces.
+   *
+   * @example
+   * Lexer lexer("(1, \"a\"), (?, b)");
+   * std::vector<std::vector<Operand>> rows;
+   * size_t parameters = 0;
+   * LiteralParser::parseTuples(lexer, rows, parameters, "Invalid VALUES list");
+   */
+  static void parseTuples(Lexer& lexer, std::vector<std::vector<Operand>>& rows, size_t& parameterCount,
+                          const char* message) {
+    do {
+      parseTuple(lexer, rows.emplace_back(), parameterCount, false, message);
+    } while(lexer.acceptSymbol(","));
+  }
+};
+
+#endif
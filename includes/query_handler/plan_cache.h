@@ -0,0 +1,122 @@
+#ifndef PLAN_CACHE_H
+#define PLAN_CACHE_H
+
+#include "../queries/statement_plan.h"
+#include <cctype>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+/*
+===========================================================================
+PlanCache Class:
+Least-recently-used cache of statement plans keyed by normalized statement
+text (see normalize), so the same statement typed with different spacing
+shares one entry. Plans are handed out as shared_ptr<const>, so a plan
+evicted while it is being executed stays valid for that execution.
+===========================================================================
+*/
+class PlanCache {
+public:
+  static constexpr size_t DEFAULT_CAPACITY = 256;
+
+private:
+  using Entry = std::pair<std::string, std::shared_ptr<const StatementPlan>>;
+
+  size_t capacity;
+  std::list<Entry> entries; // Most recently used first
+  std::unordered_map<std::string, std::list<Entry>::iterator> lookup;
+  size_t hitCount = 0;
+  size_t missCount = 0;
+
+public:
+  explicit PlanCache(size_t capacity = DEFAULT_CAPACITY) : capacity(capacity) {}
+
+  /**
+   * Collapses every run of whitespace outside quoted strings into a single
+   * space and trims both ends.
+   *
+   * @param text Statement text.
+   * @return The cache key for text.
+   *
+   * @example
+   * PlanCache::normalize("SELECT  *   FROM t "); // "SELECT * FROM t"
+   */
+  static std::string normalize(const std::string& text) {
+    std::string key;
+    key.reserve(text.size());
+    char quote = 0; // Quote character of the string being copied, if any
+    bool pendingSpace = false;
+    for (char c : text) {
+      if (!quote && std::isspace(static_cast<unsigned char>(c))) {
+        pendingSpace = !key.empty();
+        continue;
+      }
+      if (pendingSpace) {
+        key += ' ';
+        pendingSpace = false;
+      }
+      if (c == quote) {
+        quote = 0;
+      } else if (!quote && (c == '"' || c == '\'')) {
+        quote = c;
+      }
+      key += c;
+    }
+    return key;
+  }
+
+  /**
+   * Returns the plan cached under key and marks it most recently used.
+   *
+   * @param key Normalized statement text.
+   * @return The plan, or nullptr on a miss.
+   */
+  std::shared_ptr<const StatementPlan> find(const std::string& key) {
+    auto it = lookup.find(key);
+    if (it == lookup.end()) {
+      ++missCount;
+      return nullptr;
+    }
+    ++hitCount;
+    entries.splice(entries.begin(), entries, it->second);
+    return it->second->second;
+  }
+
+  /**
+   * Caches plan under key, replacing any plan already there, and evicts the
+   * least recently used plan when the cache is full.
+   *
+   * @param key Normalized statement text.
+   * @param plan Plan to cache.
+   */
+  void insert(const std::string& key, std::shared_ptr<const StatementPlan> plan) {
+    if (capacity == 0) return;
+    auto it = lookup.find(key);
+    if (it != lookup.end()) {
+      it->second->second = std::move(plan);
+      entries.splice(entries.begin(), entries, it->second);
+      return;
+    }
+    if (entries.size() >= capacity) {
+      lookup.erase(entries.back().first);
+      entries.pop_back();
+    }
+    entries.emplace_front(key, std::move(plan));
+    lookup.emplace(key, entries.begin());
+  }
+
+  void clear() {
+    entries.clear();
+    lookup.clear();
+  }
+
+  size_t size() const { return entries.size(); }
+  size_t hits() const { return hitCount; }
+  size_t misses() const { return missCount; }
+};
+
+#endif
@@ -5,10 +5,16 @@
 #include "../table.h"
 #include "../value.h"
 #include "../queries/select.h"
+#include "../queries/result_cursor.h"
+#include "../queries/statement_plan.h"
+#include "lexer.h"
+#include "literal_parser.h"
+#include "where_parser.h"
+#include <cstdint>
 #include <iostream>
+#include <optional>
 #include <vector>
 #include <string>
-#include <sstream>
 #include <unordered_map>
 
 class SelectProcessor {
@@ -21,107 +27,465 @@ private:
         std::cout << val.getInt() << " ";
         break;
       case Value::STRING:
-        std::cout << val.getString() << " ";
+        std::cout << val.getStringView() << " ";
         break;
       case Value::BOOL:
         std::cout << (val.getBool() ? "true" : "false") << " ";
         break;
       default:
+        std::cout << "NULL ";
         break;
     }
   }
 
-  void printTableRows(const Table& table, const std::vector<std::string>& columns) const {
-    std::vector<size_t> colIndices;
-    const auto& colIndexMap = table.getColumnIndexMap();
-    
-    for (const auto& col : columns) colIndices.push_back(colIndexMap.at(col));
-    
-    for(size_t i = 0; i < table.getRowCount(); i++) {
-      const auto& row = table.getRow(i);
-      for (size_t idx : colIndices) {
-        printValue(row[idx]);
+  // Prints the cursor's rows batch by batch as they are read.
+  void printCursor(ResultCursor& cursor) const {
+    RowBatch batch;
+    const size_t columnCount = cursor.getColumnNames().size();
+    while(cursor.next(batch)) {
+      for(size_t i = 0; i < batch.size(); i++) {
+        for(size_t c = 0; c < columnCount; c++) {
+          printValue(batch.at(i, c));
+        }
+        std::cout << "\n";
       }
-      std::cout << "\n";
     }
   }
 
-  void printResultMap(const std::unordered_map<std::string, std::vector<Value>>& result, 
-                      const std::vector<std::string>& columns) const {
-    if (result.empty()) return;
-    size_t rowCount = result.at(columns[0]).size();
-    for(size_t i = 0; i < rowCount; i++) {
-      for(const auto& col : columns) {
-        printValue(result.at(col)[i]);
+  /**
+   * Stores a parsed WHERE condition in the plan. A single "col = v" or
+   * range predicate keeps the EQUALS/RANGE filters, which can answer from
+   * one index in index order; any other condition is an EXPRESSION.
+   */
+  static void setFilter(SelectPlan& select, Expression where) {
+    if(where.kind == Expression::Kind::COMPARE && where.comparison != Expression::Comparison::NE) {
+      select.conditionColumn = where.column;
+      switch(where.comparison) {
+        case Expression::Comparison::EQ:
+          select.filter = SelectPlan::Filter::EQUALS;
+          select.value = where.operands[0];
+          return;
+        case Expression::Comparison::LT:
+        case Expression::Comparison::LE:
+          select.filter = SelectPlan::Filter::RANGE;
+          select.upper = where.operands[0];
+          select.upperInclusive = where.comparison == Expression::Comparison::LE;
+          return;
+        default:
+          select.filter = SelectPlan::Filter::RANGE;
+          select.lower = where.operands[0];
+          select.lowerInclusive = where.comparison == Expression::Comparison::GE;
+          return;
       }
-      std::cout << "\n";
     }
+    if(where.kind == Expression::Kind::BETWEEN) {
+      select.conditionColumn = where.column;
+      select.filter = SelectPlan::Filter::RANGE;
+      select.lower = where.operands[0];
+      select.upper = where.operands[1];
+      return;
+    }
+    select.filter = SelectPlan::Filter::EXPRESSION;
+    select.where = std::move(where);
   }
 
-  Value parseValue(const std::string& valStr) const {
-    if(valStr.front() == '"' && valStr.back() == '"') {
-      return Value(valStr.substr(1, valStr.size() - 2));
-    } else if(valStr == "true" || valStr == "false") {
-      return Value(valStr == "true");
+  // Resolves the column of every leaf of expr.
+  static void resolveExpression(const Table& table, Expression& expr) {
+    if(expr.isLeaf()) {
+      expr.columnIndex = SelectQuery::resolveConditionColumn(table, expr.column);
+      return;
     }
-    try {
-      return Value(std::stoi(valStr));
-    } catch(...) {
-      return Value(valStr);
+    for(Expression& child : expr.children) {
+      resolveExpression(table, child);
+    }
+  }
+
+  /**
+   * Parses the argument list of an aggregate call whose name and "(" have
+   * been read: * (COUNT only), [DISTINCT] column (DISTINCT with COUNT only).
+   *
+   * @param function Token of the function name.
+   * @return The aggregate, with its column still unresolved.
+   * @throws SyntaxError if function is not an aggregate or the arguments are malformed.
+   */
+  static Aggregate parseAggregate(Lexer& lexer, const Token& function, const char* usage) {
+    static const std::pair<const char*, Aggregate::Function> functions[] = {
+        {"COUNT", Aggregate::Function::COUNT}, {"SUM", Aggregate::Function::SUM}, {"MIN", Aggregate::Function::MIN},
+        {"MAX", Aggregate::Function::MAX},     {"AVG", Aggregate::Function::AVG}};
+    Aggregate aggregate;
+    bool known = false;
+    for(const auto& [name, kind] : functions) {
+      if(function.isKeyword(name)) {
+        aggregate.function = kind;
+        known = true;
+      }
+    }
+    if(!known) {
+      throw SyntaxError(usage);
+    }
+    const bool count = aggregate.function == Aggregate::Function::COUNT;
+    if(count && lexer.acceptSymbol("*")) {
+      aggregate.star = true;
+    } else {
+      aggregate.distinct = count && lexer.acceptKeyword("DISTINCT");
+      aggregate.column = lexer.expectName(usage);
+    }
+    lexer.expectSymbol(")", usage);
+    return aggregate;
+  }
+
+  // The output column name of an aggregate, e.g. COUNT(DISTINCT city).
+  static std::string aggregateName(const Aggregate& aggregate) {
+    static const char* names[] = {"COUNT", "SUM", "MIN", "MAX", "AVG"};
+    std::string name = names[static_cast<size_t>(aggregate.function)];
+    name += "(";
+    if(aggregate.distinct) name += "DISTINCT ";
+    name += aggregate.star ? "*" : aggregate.column;
+    return name + ")";
+  }
+
+  /**
+   * Resolves an aggregated SELECT: the GROUP BY columns, the column of each
+   * aggregate and the plain output columns, each of which must be one of
+   * the GROUP BY columns.
+   *
+   * @param items One entry per output column: its aggregate, or nullopt for a plain column.
+   * @param resolve Callable (name, size_t& index) returning the table side of a column.
+   * @throws std::invalid_argument if a plain output column is not grouped by.
+   */
+  template<typename Resolve>
+  static void resolveAggregates(SelectPlan& select, std::vector<std::optional<Aggregate>> items,
+                                const std::vector<std::string>& groupBy, Resolve resolve) {
+    for(const std::string& name : groupBy) {
+      size_t index = 0;
+      select.groupSides.push_back(resolve(name, index));
+      select.groupIndices.push_back(index);
+    }
+    for(size_t i = 0; i < items.size(); i++) {
+      if(items[i]) {
+        Aggregate& aggregate = *items[i];
+        if(!aggregate.star) {
+          aggregate.side = resolve(aggregate.column, aggregate.columnIndex);
+        }
+        select.outputs.push_back(select.groupIndices.size() + select.aggregates.size());
+        select.aggregates.push_back(std::move(aggregate));
+        continue;
+      }
+      size_t index = 0;
+      const uint8_t side = resolve(select.columnNames[i], index);
+      size_t group = 0;
+      while(group < groupBy.size() && (select.groupIndices[group] != index || select.groupSides[group] != side)) {
+        group++;
+      }
+      if(group == groupBy.size()) {
+        throw std::invalid_argument("Column " + select.columnNames[i] + " must be in GROUP BY or in an aggregate");
+      }
+      select.outputs.push_back(group);
+    }
+  }
+
+  // A name after a table in FROM/JOIN, optionally preceded by AS; the table name itself if there is none.
+  static std::string parseAlias(Lexer& lexer, const std::string& tableName, const char* usage) {
+    if(lexer.acceptKeyword("AS")) {
+      return std::string(lexer.expectName(usage));
+    }
+    const Token& token = lexer.peek();
+    if(token.kind != Token::Kind::WORD || token.isKeyword("JOIN") || token.isKeyword("INNER") ||
+       token.isKeyword("ON") || token.isKeyword("WHERE") || token.isKeyword("GROUP")) {
+      return tableName;
+    }
+    return std::string(lexer.next().text);
+  }
+
+  /**
+   * Resolves a column of a join. A qualified name (alias.column) names its
+   * table; an unqualified one must exist in exactly one of the two tables.
+   *
+   * @return 0 for the FROM table, 1 for the joined table; index receives the column position.
+   * @throws std::out_of_range if the column does not exist or is ambiguous.
+   */
+  static uint8_t resolveJoinColumn(const std::string& name, const Table* tables[2], const std::string aliases[2],
+                                   size_t& index) {
+    const size_t dot = name.find('.');
+    for(uint8_t side = 0; side < 2 && dot != std::string::npos; side++) {
+      if(name.compare(0, dot, aliases[side]) != 0) continue;
+      const auto& columns = tables[side]->getColumnIndexMap();
+      auto it = columns.find(name.substr(dot + 1));
+      if(it == columns.end()) break;
+      index = it->second;
+      return side;
+    }
+    if(dot != std::string::npos) {
+      throw std::out_of_range("Column not found: " + name);
+    }
+    const auto& leftColumns = tables[0]->getColumnIndexMap();
+    const auto& rightColumns = tables[1]->getColumnIndexMap();
+    auto inLeft = leftColumns.find(name);
+    auto inRight = rightColumns.find(name);
+    if(inLeft != leftColumns.end() && inRight != rightColumns.end()) {
+      throw std::out_of_range("Ambiguous column: " + name);
+    }
+    if(inLeft == leftColumns.end() && inRight == rightColumns.end()) {
+      throw std::out_of_range("Column not found: " + name);
     }
+    index = inLeft != leftColumns.end() ? inLeft->second : inRight->second;
+    return inLeft != leftColumns.end() ? 0 : 1;
+  }
+
+  // Resolves the leaves of a WHERE conjunct of a join and returns the one table they all refer to.
+  static uint8_t resolveJoinConjunct(Expression& expr, const Table* tables[2], const std::string aliases[2]) {
+    if(expr.isLeaf()) {
+      const uint8_t side = resolveJoinColumn(expr.column, tables, aliases, expr.columnIndex);
+      expr.column = tables[side]->getColumn(expr.columnIndex).getName();
+      return side;
+    }
+    const uint8_t side = resolveJoinConjunct(expr.children[0], tables, aliases);
+    for(size_t i = 1; i < expr.children.size(); i++) {
+      if(resolveJoinConjunct(expr.children[i], tables, aliases) != side) {
+        throw std::invalid_argument("Each WHERE condition of a join must refer to one table");
+      }
+    }
+    return side;
+  }
+
+  static std::optional<Expression> conjunction(std::vector<Expression> conjuncts) {
+    if(conjuncts.empty()) return std::nullopt;
+    if(conjuncts.size() == 1) return std::move(conjuncts[0]);
+    Expression expr;
+    expr.kind = Expression::Kind::AND;
+    expr.children = std::move(conjuncts);
+    return expr;
+  }
+
+  /**
+   * Resolves the names of a join: output columns (unless the plan is
+   * aggregated; see resolveAggregates), join key and WHERE conjuncts, which
+   * are split by table. The FROM table's conjuncts become the plan's filter.
+   */
+  static void resolveJoin(SelectPlan& select, const Table& left, const Table& right, const std::string aliases[2],
+                          const std::string& leftKey, const std::string& rightKey, std::optional<Expression> where) {
+    const Table* tables[2] = {&left, &right};
+    if(select.aggregated) {
+      // Output columns are resolved with the GROUP BY.
+    } else if(select.columnNames.size() == 1 && select.columnNames[0] == "*") {
+      select.columnNames.clear();
+      for(uint8_t side = 0; side < 2; side++) {
+        for(const std::string& column : tables[side]->getColumnNames()) {
+          select.columnNames.push_back(aliases[side] + "." + column);
+          select.colIndices.push_back(tables[side]->getColumnIndexMap().at(column));
+          select.columnSides.push_back(side);
+        }
+      }
+    } else {
+      for(const std::string& name : select.columnNames) {
+        size_t index = 0;
+        select.columnSides.push_back(resolveJoinColumn(name, tables, aliases, index));
+        select.colIndices.push_back(index);
+      }
+    }
+
+    JoinPlan& join = *select.join;
+    size_t keys[2] = {0, 0};
+    const uint8_t first = resolveJoinColumn(leftKey, tables, aliases, keys[0]);
+    const uint8_t second = resolveJoinColumn(rightKey, tables, aliases, keys[1]);
+    if(first == second) {
+      throw std::invalid_argument("JOIN ... ON must compare a column of each table");
+    }
+    join.leftKey = keys[first == 0 ? 0 : 1];
+    join.rightKey = keys[first == 0 ? 1 : 0];
+    join.schemaColumns = right.getColumnTypes().size();
+
+    if(!where) return;
+    std::vector<Expression> conjuncts[2];
+    std::vector<Expression> all;
+    if(where->kind == Expression::Kind::AND) {
+      all = std::move(where->children);
+    } else {
+      all.push_back(std::move(*where));
+    }
+    for(Expression& conjunct : all) {
+      const uint8_t side = resolveJoinConjunct(conjunct, tables, aliases);
+      conjuncts[side].push_back(std::move(conjunct));
+    }
+    if(std::optional<Expression> leftWhere = conjunction(std::move(conjuncts[0]))) {
+      setFilter(select, std::move(*leftWhere));
+      if(select.filter != SelectPlan::Filter::EXPRESSION) {
+        select.conditionIndex = left.getColumnIndexMap().at(select.conditionColumn);
+      }
+    }
+    join.where = conjunction(std::move(conjuncts[1]));
   }
 
 public:
   SelectProcessor(Storage& store) : storage(store) {}
 
-  void execute(const std::string& query) {
-    std::stringstream ss(query);
-    std::string selectCmd;
-    ss >> selectCmd;  // consume "SELECT"
-    
-    // Parse column names
-    std::vector<std::string> columns;
-    std::string col;
-    while(ss >> col && col != "FROM") {
-      if(col.back() == ',') col.pop_back();
-      columns.push_back(col);
-    }
-    
-    std::string tableName, whereToken;
-    ss >> tableName >> whereToken;
-    
-    SelectQuery selectQuery(storage);
-    
-    try {
-      // Handle SELECT * FROM table
-      if(columns.size() == 1 && columns[0] == "*") {
-        const Table& table = selectQuery.selectAll(tableName);
-        std::vector<std::string> allColumns = table.getColumnNames();
-        printTableRows(table, allColumns);
-        return;
-      }
-      
-      // Handle WHERE clause
-      if(whereToken == "WHERE") {
-        std::string conditionColumn, equalsToken, conditionValueStr;
-        ss >> conditionColumn >> equalsToken >> conditionValueStr;
-        
-        if(equalsToken != "=") {
-          std::cerr << "Invalid WHERE clause syntax. Use: WHERE column = value\n";
-          return;
+  /**
+   * Parses a SELECT statement into a plan and resolves its column names
+   * against the table. A WHERE value may be a ? placeholder. With JOIN,
+   * columns may be qualified by table name or alias, and each WHERE
+   * conjunct must refer to one of the two tables. The SELECT list may hold
+   * aggregates (COUNT(*), COUNT([DISTINCT] col), SUM, MIN, MAX, AVG), and
+   * GROUP BY follows WHERE; plain columns must then be grouped by.
+   *
+   * @param query The SELECT statement.
+   * @return The parsed statement.
+   * @throws SyntaxError if the statement is malformed.
+   * @throws std::out_of_range if a table or a column does not exist, or a join column is ambiguous.
+   * @throws std::invalid_argument if a join condition or WHERE conjunct mixes up the tables, or a plain
+   *         column of an aggregated SELECT is not in GROUP BY.
+   *
+   * @example
+   * StatementPlan plan = selectProcessor.parse("SELECT name FROM users WHERE age >= ?");
+   * StatementPlan join = selectProcessor.parse("SELECT u.name, o.total FROM users u JOIN orders o ON u.id = o.user_id");
+   * StatementPlan groups = selectProcessor.parse("SELECT city, COUNT(*), MAX(age) FROM users GROUP BY city");
+   */
+  StatementPlan parse(const std::string& query) const {
+    const char* usage = "Invalid SELECT syntax. Use: SELECT * | col1, col2, ... FROM tablename [JOIN ...] [WHERE ...]"
+                        " [GROUP BY col1, ...], where a column may be COUNT(*), COUNT([DISTINCT] col), SUM(col),"
+                        " MIN(col), MAX(col) or AVG(col)";
+    const char* joinUsage = "Invalid JOIN syntax. Use: FROM table1 [alias1] JOIN table2 [alias2] ON alias1.col = alias2.col";
+    const char* whereUsage = "Invalid WHERE clause syntax. Use: WHERE column (= | <> | < | <= | > | >=) value,"
+                             " column [NOT] BETWEEN low AND high, column [NOT] IN (v1, v2, ...) or column IS [NOT] NULL,"
+                             " combined with AND, OR, NOT and parentheses";
+    Lexer lexer(query);
+    lexer.expectKeyword("SELECT", usage);
+
+    StatementPlan plan;
+    plan.kind = StatementPlan::Kind::SELECT;
+    plan.text = query;
+    SelectPlan& select = plan.select;
+
+    // Column list; commas between items are optional. A name followed by
+    // "(" is an aggregate call.
+    std::vector<std::optional<Aggregate>> items;
+    if(lexer.acceptSymbol("*")) {
+      select.columnNames.push_back("*");
+      items.emplace_back();
+    } else {
+      while(lexer.peek().kind != Token::Kind::END && !lexer.peek().isKeyword("FROM")) {
+        const Token name = lexer.peek();
+        select.columnNames.emplace_back(lexer.expectName(usage));
+        items.emplace_back();
+        if(lexer.acceptSymbol("(")) {
+          items.back() = parseAggregate(lexer, name, usage);
+          select.columnNames.back() = aggregateName(*items.back());
+          select.aggregated = true;
         }
-        
-        auto result = selectQuery.selectWhere(tableName, columns, parseValue(conditionValueStr), conditionColumn);
-        printResultMap(result, columns);
-        return;
+        lexer.acceptSymbol(",");
       }
-      
-      // Handle SELECT columns FROM table (no WHERE)
-      auto result = selectQuery.selectColumns(tableName, columns);
-      printResultMap(result, columns);
+    }
+    lexer.expectKeyword("FROM", usage);
+    select.tableName = lexer.expectName(usage);
+    std::string aliases[2];
+    aliases[0] = parseAlias(lexer, select.tableName, usage);
+
+    std::string leftKey, rightKey;
+    if(lexer.acceptKeyword("INNER")) {
+      lexer.expectKeyword("JOIN", joinUsage);
+      select.join.emplace();
+    } else if(lexer.acceptKeyword("JOIN")) {
+      select.join.emplace();
+    }
+    if(select.join) {
+      select.join->tableName = lexer.expectName(joinUsage);
+      aliases[1] = parseAlias(lexer, select.join->tableName, joinUsage);
+      lexer.expectKeyword("ON", joinUsage);
+      leftKey = lexer.expectName(joinUsage);
+      lexer.expectSymbol("=", joinUsage);
+      rightKey = lexer.expectName(joinUsage);
+    }
+
+    std::optional<Expression> where;
+    if(lexer.acceptKeyword("WHERE")) {
+      where = WhereParser::parse(lexer, plan.parameterCount, whereUsage);
+    }
+    std::vector<std::string> groupBy;
+    if(lexer.acceptKeyword("GROUP")) {
+      lexer.expectKeyword("BY", usage);
+      do {
+        groupBy.emplace_back(lexer.expectName(usage));
+      } while(lexer.acceptSymbol(","));
+      select.aggregated = true;
+    }
+    lexer.expectEnd(usage);
+    if(select.aggregated && select.columnNames.size() == 1 && select.columnNames[0] == "*") {
+      throw std::invalid_argument("SELECT * cannot be grouped; list the GROUP BY columns instead");
+    }
+
+    // Resolve names once; executing the plan only looks up the tables.
+    const Table& table = storage.getTableConst(select.tableName);
+    select.schemaColumns = table.getColumnTypes().size();
+    if(select.join) {
+      const Table& joined = storage.getTableConst(select.join->tableName);
+      resolveJoin(select, table, joined, aliases, leftKey, rightKey, std::move(where));
+      if(select.aggregated) {
+        const Table* tables[2] = {&table, &joined};
+        resolveAggregates(select, std::move(items), groupBy, [&](const std::string& name, size_t& index) {
+          return resolveJoinColumn(name, tables, aliases, index);
+        });
+      }
+      return plan;
+    }
+    if(where) {
+      setFilter(select, std::move(*where));
+    }
+    if(select.aggregated) {
+      resolveAggregates(select, std::move(items), groupBy, [&](const std::string& name, size_t& index) {
+        std::vector<std::string> names{name};
+        index = SelectQuery::resolveColumns(table, names)[0];
+        return uint8_t(0);
+      });
+    } else {
+      select.colIndices = SelectQuery::resolveColumns(table, select.columnNames);
+    }
+    if(select.filter == SelectPlan::Filter::EXPRESSION) {
+      resolveExpression(table, select.where);
+    } else if(select.filter != SelectPlan::Filter::NONE) {
+      select.conditionIndex = SelectQuery::resolveConditionColumn(table, select.conditionColumn);
+    }
+    return plan;
+  }
+
+  /**
+   * Runs a parsed SELECT with the given placeholder values and prints the rows.
+   *
+   * @param plan Plan from parse.
+   * @param args One value per placeholder.
+   */
+  void execute(const StatementPlan& plan, const std::vector<Value>& args) {
+    if(args.size() != plan.parameterCount) {
+      std::cerr << "SELECT failed: expected " << plan.parameterCount << " parameter value(s), got " << args.size() << std::endl;
+      return;
+    }
+    try {
+      SelectQuery selectQuery(storage);
+      ResultCursor cursor = selectQuery.openPlan(plan.select, args);
+      printCursor(cursor);
+    } catch(const std::exception& e) {
+      std::cerr << "SELECT failed: " << e.what() << std::endl;
+    }
+  }
+
+  /**
+   * Parses and runs a SELECT statement without placeholders.
+   *
+   * @param query The SELECT statement.
+   * @example
+   * SelectProcessor selectProcessor(storage);
+   * selectProcessor.execute("SELECT name FROM users WHERE age BETWEEN 18 AND 30");
+   */
+  void execute(const std::string& query) {
+    StatementPlan plan;
+    try {
+      plan = parse(query);
+    } catch(const SyntaxError& e) {
+      std::cerr << e.what() << "\n";
+      return;
     } catch(const std::exception& e) {
       std::cerr << "SELECT failed: " << e.what() << std::endl;
+      return;
     }
+    execute(plan, {});
   }
 };
 
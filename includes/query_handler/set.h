@@ -0,0 +1,85 @@
+#ifndef SET_PROCESSOR_H
+#define SET_PROCESSOR_H
+
+#include "../storage.h"
+#include "../persistence/wal.h"
+#include "lexer.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+class SetProcessor {
+private:
+  Storage& storage;
+public:
+  SetProcessor(Storage& store) : storage(store) {}
+
+  /**
+   * Executes a SET statement changing a session setting.
+   * Supported settings:
+   *   sync          - off | batch | full, how INSERTs are made durable
+   *   commit_window - microseconds a batch commit waits for other commits
+   *   parallelism   - threads a SELECT may use for full scans (1 = serial, at most
+   *                   four per hardware thread)
+   *   join_memory_kb - KiB of working memory a hash join may use before spilling
+   * 
+   * @param query The SET statement.
+   * @example
+   * SetProcessor setProcessor(storage);
+   * setProcessor.execute("SET sync = batch");
+   * setProcessor.execute("SET commit_window = 500");
+   * setProcessor.execute("SET parallelism = 4");
+   * setProcessor.execute("SET join_memory_kb = 65536");
+   */
+  void execute(const std::string& query) {
+    const char* usage = "Invalid SET syntax. Use: SET name = value";
+    std::string_view name;
+    Token value;
+    try {
+      Lexer lexer(query);
+      lexer.expectKeyword("SET", usage);
+      name = lexer.expectName(usage);
+      lexer.expectSymbol("=", usage);
+      value = lexer.next();
+      if(!value.isValue() || value.kind == Token::Kind::PARAMETER) throw SyntaxError(usage);
+      lexer.expectEnd(usage);
+    } catch(const SyntaxError& e) {
+      std::cerr << e.what() << std::endl;
+      return;
+    }
+
+    try {
+      if(name == "sync") {
+        storage.setSyncMode(WriteAheadLog::stringToSyncMode(std::string(value.text)));
+        std::cout << "sync = " << WriteAheadLog::syncModeToString(storage.getSyncMode()) << std::endl;
+      } else if(name == "commit_window") {
+        if(value.kind != Token::Kind::NUMBER || value.number < 0) {
+          throw std::invalid_argument("commit_window must be a non-negative number of microseconds");
+        }
+        storage.setCommitWindow(std::chrono::microseconds(value.number));
+        std::cout << "commit_window = " << storage.getCommitWindow().count() << std::endl;
+      } else if(name == "parallelism") {
+        if(value.kind != Token::Kind::NUMBER || value.number < 1) {
+          throw std::invalid_argument("parallelism must be at least 1");
+        }
+        storage.setParallelism(static_cast<size_t>(value.number));
+        std::cout << "parallelism = " << storage.getParallelism() << std::endl;
+      } else if(name == "join_memory_kb") {
+        if(value.kind != Token::Kind::NUMBER || value.number < 1) {
+          throw std::invalid_argument("join_memory_kb must be at least 1");
+        }
+        storage.setJoinMemoryLimit(static_cast<size_t>(value.number) * 1024);
+        std::cout << "join_memory_kb = " << storage.getJoinMemoryLimit() / 1024 << std::endl;
+      } else {
+        std::cerr << "Unknown setting: " << name << std::endl;
+      }
+    } catch(const std::exception& e) {
+      std::cerr << "SET failed: " << e.what() << std::endl;
+    }
+  }
+
+};
+
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef WHERE_PARSER_H
+#define WHERE_PARSER_H
+
+#include "../queries/statement_plan.h"
+#include "lexer.h"
+#include "literal_parser.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+===========================================================================
+WhereParser:
+Recursive-descent parser for WHERE conditions:
+
+  condition := conjunct { OR conjunct }
+  conjunct  := factor { AND factor }
+  factor    := NOT factor | '(' condition ')' | predicate
+  predicate := column ( = | <> | != | < | <= | > | >= ) value
+             | column [NOT] BETWEEN value AND value
+             | column [NOT] IN ( value, ... )
+             | column IS [NOT] NULL
+
+AND binds tighter than OR. Chains of the same operator are flattened into
+one node, so "a AND b AND c" is a single AND with three children. Any
+value may be a ? placeholder. Column names are resolved later, against
+the table.
+===========================================================================
+*/
+class WhereParser {
+private:
+  Lexer& lexer;
+  size_t& parameterCount;
+  const char* usage;
+
+  WhereParser(Lexer& lexer, size_t& parameterCount, const char* usage)
+      : lexer(lexer), parameterCount(parameterCount), usage(usage) {}
+
+  Operand parseValue() {
+    if (!lexer.peek().isValue()) throw SyntaxError(usage);
+    return LiteralParser::parseOperand(lexer, parameterCount);
+  }
+
+  static Expression combine(Expression::Kind kind, std::vector<Expression> children) {
+    if (children.size() == 1) return std::move(children[0]);
+    Expression expr;
+    expr.kind = kind;
+    for (Expression& child : children) {
+      if (child.kind == kind) {
+        for (Expression& grandchild : child.children) expr.children.push_back(std::move(grandchild));
+      } else {
+        expr.children.push_back(std::move(child));
+      }
+    }
+    return expr;
+  }
+
+  static Expression negate(Expression expr) {
+    Expression negation;
+    negation.kind = Expression::Kind::NOT;
+    negation.children.push_back(std::move(expr));
+    return negation;
+  }
+
+  Expression parseCondition() {
+    std::vector<Expression> terms;
+    terms.push_back(parseConjunct());
+    while (lexer.acceptKeyword("OR")) {
+      terms.push_back(parseConjunct());
+    }
+    return combine(Expression::Kind::OR, std::move(terms));
+  }
+
+  Expression parseConjunct() {
+    std::vector<Expression> factors;
+    factors.push_back(parseFactor());
+    while (lexer.acceptKeyword("AND")) {
+      factors.push_back(parseFactor());
+    }
+    return combine(Expression::Kind::AND, std::move(factors));
+  }
+
+  Expression parseFactor() {
+    if (lexer.acceptKeyword("NOT")) {
+      return negate(parseFactor());
+    }
+    if (lexer.acceptSymbol("(")) {
+      Expression inner = parseCondition();
+      lexer.expectSymbol(")", usage);
+      return inner;
+    }
+    return parsePredicate();
+  }
+
+  Expression parsePredicate() {
+    Expression leaf;
+    leaf.column = lexer.expectName(usage);
+
+    const Token& op = lexer.peek();
+    static const std::pair<const char*, Expression::Comparison> comparisons[] = {
+        {"=", Expression::Comparison::EQ},  {"<>", Expression::Comparison::NE}, {"!=", Expression::Comparison::NE},
+        {"<", Expression::Comparison::LT},  {"<=", Expression::Comparison::LE}, {">", Expression::Comparison::GT},
+        {">=", Expression::Comparison::GE}};
+    for (const auto& [symbol, comparison] : comparisons) {
+      if (op.isSymbol(symbol)) {
+        lexer.next();
+        leaf.kind = Expression::Kind::COMPARE;
+        leaf.comparison = comparison;
+        leaf.operands.push_back(parseValue());
+        return leaf;
+      }
+    }
+
+    if (lexer.acceptKeyword("IS")) {
+      leaf.kind = Expression::Kind::IS_NULL;
+      leaf.negated = lexer.acceptKeyword("NOT");
+      lexer.expectKeyword("NULL", usage);
+      return leaf;
+    }
+
+    const bool negated = lexer.acceptKeyword("NOT");
+    if (lexer.acceptKeyword("BETWEEN")) {
+      leaf.kind = Expression::Kind::BETWEEN;
+      leaf.operands.push_back(parseValue());
+      lexer.expectKeyword("AND", usage);
+      leaf.operands.push_back(parseValue());
+    } else if (lexer.acceptKeyword("IN")) {
+      leaf.kind = Expression::Kind::IN;
+      lexer.expectSymbol("(", usage);
+      do {
+        leaf.operands.push_back(parseValue());
+      } while (lexer.acceptSymbol(","));
+      lexer.expectSymbol(")", usage);
+    } else {
+      throw SyntaxError(usage);
+    }
+    return negated ? negate(std::move(leaf)) : leaf;
+  }
+
+public:
+  /**
+   * Parses a WHERE condition, leaving the lexer after it.
+   *
+   * @param lexer Positioned after WHERE.
+   * @param parameterCount Number of placeholders seen so far; incremented per ?.
+   * @param usage Error message for malformed conditions.
+   * @return The expression tree.
+   * @throws SyntaxError if the condition is malformed.
+   *
+   * @example
+   * Lexer lexer("age >= 18 AND (city = Berlin OR city IN (Paris, Rome))");
+   * size_t parameters = 0;
+   * Expression where = WhereParser::parse(lexer, parameters, "Invalid WHERE clause");
+   */
+  static Expression parse(Lexer& lexer, size_t& parameterCount, const char* usage) {
+    WhereParser parser(lexer, parameterCount, usage);
+    return parser.parseCondition();
+  }
+};
+
+#endif
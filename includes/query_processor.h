@@ -4,23 +4,149 @@
 #include "storage.h"
 #include "table.h"
 #include "value.h"
+#include "query_handler/analyze.h"
+#include "query_handler/copy.h"
 #include "query_handler/create.h"
+#include "query_handler/index.h"
 #include "query_handler/insert.h"
+#include "query_handler/lexer.h"
+#include "query_handler/literal_parser.h"
+#include "query_handler/plan_cache.h"
 #include "query_handler/select.h"
+#include "query_handler/set.h"
 #include <iostream>
+#include <memory>
 #include <string>
-#include <sstream>
+#include <unordered_map>
+#include <vector>
 
 class QueryProcessor {
 private:
   Storage& storage;
+  SelectProcessor selectProcessor;
+  InsertProcessor insertProcessor;
+  PlanCache planCache;
+  std::unordered_map<std::string, std::shared_ptr<const StatementPlan>> prepared; // By PREPARE name
+
+  // A SELECT plan is stale once columns were added to one of its tables, since * was expanded at parse time.
+  bool isCurrent(const StatementPlan& plan) const {
+    if(plan.kind != StatementPlan::Kind::SELECT) return true;
+    try {
+      const SelectPlan& select = plan.select;
+      if(select.join && storage.getTableConst(select.join->tableName).getColumnTypes().size() != select.join->schemaColumns) {
+        return false;
+      }
+      return storage.getTableConst(select.tableName).getColumnTypes().size() == select.schemaColumns;
+    } catch(const std::exception&) {
+      return false;
+    }
+  }
+
+  /**
+   * Returns the plan for a SELECT or INSERT, from the plan cache when the
+   * same normalized text was planned before. Parse errors are printed.
+   *
+   * @return The plan, or nullptr if the statement could not be planned.
+   */
+  std::shared_ptr<const StatementPlan> planFor(const std::string& text) {
+    const std::string key = PlanCache::normalize(text);
+    std::shared_ptr<const StatementPlan> plan = planCache.find(key);
+    if(plan && isCurrent(*plan)) {
+      return plan;
+    }
+
+    bool isSelect = false;
+    try {
+      isSelect = Lexer(key).peek().isKeyword("SELECT");
+      plan = std::make_shared<const StatementPlan>(isSelect ? selectProcessor.parse(key) : insertProcessor.parse(key));
+    } catch(const SyntaxError& e) {
+      std::cerr << e.what() << std::endl;
+      return nullptr;
+    } catch(const std::exception& e) {
+      std::cerr << (isSelect ? "SELECT failed: " : "Insert failed: ") << e.what() << std::endl;
+      return nullptr;
+    }
+    planCache.insert(key, plan);
+    return plan;
+  }
+
+  void run(const StatementPlan& plan, const std::vector<Value>& args) {
+    if(plan.kind == StatementPlan::Kind::SELECT) {
+      selectProcessor.execute(plan, args);
+    } else {
+      insertProcessor.execute(plan, args);
+    }
+  }
+
+  // PREPARE name AS statement
+  void executePrepare(Lexer& lexer) {
+    const char* usage = "Invalid PREPARE syntax. Use: PREPARE name AS SELECT ... | INSERT ...";
+    const std::string name(lexer.expectName(usage));
+    lexer.expectKeyword("AS", usage);
+    if(!lexer.peek().isKeyword("SELECT") && !lexer.peek().isKeyword("INSERT")) {
+      throw SyntaxError(usage);
+    }
+    std::shared_ptr<const StatementPlan> plan = planFor(std::string(lexer.rest()));
+    if(!plan) return;
+    prepared[name] = plan;
+    std::cout << "Prepared " << name << " with " << plan->parameterCount << " parameter(s)" << std::endl;
+  }
+
+  // EXECUTE name[(arg1, arg2, ...)]
+  void executeExecute(Lexer& lexer) {
+    const char* usage = "Invalid EXECUTE syntax. Use: EXECUTE name(value1, value2, ...)";
+    const std::string name(lexer.expectName(usage));
+    std::vector<Operand> operands;
+    size_t placeholders = 0;
+    if(lexer.peek().isSymbol("(")) {
+      LiteralParser::parseTuple(lexer, operands, placeholders, true, usage);
+    }
+    lexer.expectEnd(usage);
+    if(placeholders > 0) {
+      throw SyntaxError("EXECUTE arguments must be values, not ?");
+    }
+    std::vector<Value> args;
+    args.reserve(operands.size());
+    for(const Operand& operand : operands) {
+      args.push_back(operand.literal);
+    }
+
+    auto it = prepared.find(name);
+    if(it == prepared.end()) {
+      std::cerr << "Unknown prepared statement: " << name << std::endl;
+      return;
+    }
+    if(!isCurrent(*it->second)) {
+      std::shared_ptr<const StatementPlan> plan = planFor(it->second->text);
+      if(!plan) return;
+      it->second = plan;
+    }
+    run(*it->second, args);
+  }
+
+  // DEALLOCATE name
+  void executeDeallocate(Lexer& lexer) {
+    const char* usage = "Invalid DEALLOCATE syntax. Use: DEALLOCATE name";
+    const std::string name(lexer.expectName(usage));
+    lexer.expectEnd(usage);
+    if(prepared.erase(name) == 0) {
+      std::cerr << "Unknown prepared statement: " << name << std::endl;
+      return;
+    }
+    std::cout << "Deallocated " << name << std::endl;
+  }
 
 public:
-  QueryProcessor(Storage& store) : storage(store){}
+  QueryProcessor(Storage& store) : storage(store), selectProcessor(store), insertProcessor(store) {}
   
   /**
    * Executes a simple SQL-like query.
-   * Supports CREATE TABLE, INSERT INTO, SELECT, and WHERE statements.
+   * Supports CREATE TABLE, CREATE/DROP INDEX, INSERT INTO, COPY FROM, SELECT, WHERE, ANALYZE, SET
+   * and PREPARE/EXECUTE/DEALLOCATE statements.
+   * SELECT and INSERT are planned once per distinct (whitespace-normalized)
+   * text; repeating a statement reuses the cached plan. PREPARE name AS ...
+   * plans a statement whose values may be ? placeholders, and
+   * EXECUTE name(v1, v2, ...) runs it with those values.
    * 
    * @param query The SQL-like query string to execute.
    * @example
@@ -28,27 +154,55 @@ public:
    * qp.execute("CREATE TABLE users id INT,name STRING,age INT");
    * qp.execute("INSERT INTO users VALUES 1,\"Alice\",30");
    * qp.execute("SELECT * FROM users");
+   * qp.execute("PREPARE by_age AS SELECT name FROM users WHERE age = ?");
+   * qp.execute("EXECUTE by_age(30)");
    */
   void execute(const std::string query){
-    std::stringstream ss(query);
-    std::string command;
-
-    ss >> command;
-    
-    if(command == "CREATE") {
-      CreateProcessor createProcessor(storage);
-      createProcessor.execute(query);
-    } else if(command == "INSERT") {
-      InsertProcessor insertProcessor(storage);
-      insertProcessor.execute(query);
-    } else if(command == "SELECT") {
-      SelectProcessor selectProcessor(storage);
-      selectProcessor.execute(query);
+    try {
+      Lexer lexer(query);
+      const Token command = lexer.next();
 
-    } else {
-      std::cerr << "Unknown command: " << command << std::endl;
+      if(command.isKeyword("SELECT") || command.isKeyword("INSERT")) {
+        std::shared_ptr<const StatementPlan> plan = planFor(query);
+        if(plan) {
+          run(*plan, {});
+        }
+      } else if(command.isKeyword("PREPARE")) {
+        executePrepare(lexer);
+      } else if(command.isKeyword("EXECUTE")) {
+        executeExecute(lexer);
+      } else if(command.isKeyword("DEALLOCATE")) {
+        executeDeallocate(lexer);
+      } else if(command.isKeyword("CREATE")) {
+        if(lexer.peek().isKeyword("INDEX")) {
+          IndexProcessor indexProcessor(storage);
+          indexProcessor.executeCreate(query);
+        } else {
+          CreateProcessor createProcessor(storage);
+          createProcessor.execute(query);
+        }
+      } else if(command.isKeyword("DROP")) {
+        IndexProcessor indexProcessor(storage);
+        indexProcessor.executeDrop(query);
+      } else if(command.isKeyword("COPY")) {
+        CopyProcessor copyProcessor(storage);
+        copyProcessor.execute(query);
+      } else if(command.isKeyword("ANALYZE")) {
+        AnalyzeProcessor analyzeProcessor(storage);
+        analyzeProcessor.execute(query);
+      } else if(command.isKeyword("SET")) {
+        SetProcessor setProcessor(storage);
+        setProcessor.execute(query);
+      } else {
+        std::cerr << "Unknown command: " << command.text << std::endl;
+      }
+    } catch(const SyntaxError& e) {
+      std::cerr << e.what() << std::endl;
     }
   } 
+
+  // Plans cached for repeated SELECT/INSERT text.
+  const PlanCache& getPlanCache() const { return planCache; }
   
 };
 
@@ -0,0 +1,234 @@
+#ifndef SCAN_KERNELS_H
+#define SCAN_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SIMPLEDB_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+/*
+===========================================================================
+ScanKernels:
+Predicate kernels for full scans over a contiguous column array. Each
+kernel appends base + i for every matching element i to a position list,
+so a caller can scan a slice of a column and still get table row numbers.
+
+The instruction set is picked once at runtime: AVX2 when the CPU has it,
+otherwise SSE2 (always present on x86-64); other targets use plain scalar
+loops. Vector loops compare a whole block, turn the lanes into a bit mask and
+only touch the output for set bits, so blocks without a match cost a few
+instructions and the scan runs at close to memory bandwidth.
+===========================================================================
+*/
+class ScanKernels {
+public:
+  enum class Level { SCALAR, SSE2, AVX2 };
+
+  // Instruction set used by the kernels on this machine.
+  static Level level() {
+    static const Level detected = detect();
+    return detected;
+  }
+
+  static const char* levelName(Level l) {
+    switch (l) {
+      case Level::AVX2: return "avx2";
+      case Level::SSE2: return "sse2";
+      default: return "scalar";
+    }
+  }
+
+  /**
+   * Appends base + i for every i in [0, n) with data[i] == target.
+   *
+   * @param data Column values.
+   * @param n Number of values.
+   * @param target Value to match.
+   * @param base Row number of data[0].
+   * @param out Receives the matching row numbers in ascending order.
+   *
+   * @example
+   * std::vector<size_t> rows;
+   * ScanKernels::equalsInt32(ages.data(), ages.size(), 30, 0, rows);
+   */
+  static void equalsInt32(const int32_t* data, size_t n, int32_t target, size_t base, std::vector<size_t>& out) {
+#ifdef SIMPLEDB_X86_KERNELS
+    if (level() == Level::AVX2) return equalsInt32Avx2(data, n, target, base, out);
+    return equalsInt32Sse2(data, n, target, base, out);
+#else
+    return equalsInt32Scalar(data, n, target, base, out);
+#endif
+  }
+
+  // Same as equalsInt32 for unsigned codes (e.g. dictionary-encoded strings).
+  static void equalsUInt32(const uint32_t* data, size_t n, uint32_t target, size_t base, std::vector<size_t>& out) {
+    // Equality does not depend on signedness, and int32_t may alias uint32_t.
+    equalsInt32(reinterpret_cast<const int32_t*>(data), n, static_cast<int32_t>(target), base, out);
+  }
+
+  /**
+   * Appends base + i for every i in [0, n) with lo <= data[i] <= hi.
+   *
+   * @param data Column values.
+   * @param n Number of values.
+   * @param lo Inclusive lower bound.
+   * @param hi Inclusive upper bound.
+   * @param base Row number of data[0].
+   * @param out Receives the matching row numbers in ascending order.
+   */
+  static void betweenInt32(const int32_t* data, size_t n, int32_t lo, int32_t hi, size_t base, std::vector<size_t>& out) {
+#ifdef SIMPLEDB_X86_KERNELS
+    if (level() == Level::AVX2) return betweenInt32Avx2(data, n, lo, hi, base, out);
+    return betweenInt32Sse2(data, n, lo, hi, base, out);
+#else
+    return betweenInt32Scalar(data, n, lo, hi, base, out);
+#endif
+  }
+
+  /**
+   * Appends base + i for every i in [0, n) with data[i] == target (BOOL
+   * columns are stored one byte per row).
+   *
+   * @param data Column bytes.
+   * @param n Number of bytes.
+   * @param target Byte to match.
+   * @param base Row number of data[0].
+   * @param out Receives the matching row numbers in ascending order.
+   */
+  static void equalsUInt8(const uint8_t* data, size_t n, uint8_t target, size_t base, std::vector<size_t>& out) {
+#ifdef SIMPLEDB_X86_KERNELS
+    if (level() == Level::AVX2) return equalsUInt8Avx2(data, n, target, base, out);
+    return equalsUInt8Sse2(data, n, target, base, out);
+#else
+    return equalsUInt8Scalar(data, n, target, base, out);
+#endif
+  }
+
+private:
+  static Level detect() {
+#ifdef SIMPLEDB_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return Level::AVX2;
+    return Level::SSE2;
+#else
+    return Level::SCALAR;
+#endif
+  }
+
+  // Appends base + bit position for every set bit of mask.
+  static void emitMask(uint32_t mask, size_t base, std::vector<size_t>& out) {
+    while (mask) {
+      out.push_back(base + static_cast<size_t>(__builtin_ctz(mask)));
+      mask &= mask - 1;
+    }
+  }
+
+  static void equalsInt32Scalar(const int32_t* data, size_t n, int32_t target, size_t base, std::vector<size_t>& out) {
+    for (size_t i = 0; i < n; ++i) {
+      if (data[i] == target) out.push_back(base + i);
+    }
+  }
+
+  static void betweenInt32Scalar(const int32_t* data, size_t n, int32_t lo, int32_t hi, size_t base, std::vector<size_t>& out) {
+    for (size_t i = 0; i < n; ++i) {
+      if (data[i] >= lo && data[i] <= hi) out.push_back(base + i);
+    }
+  }
+
+  static void equalsUInt8Scalar(const uint8_t* data, size_t n, uint8_t target, size_t base, std::vector<size_t>& out) {
+    for (size_t i = 0; i < n; ++i) {
+      if (data[i] == target) out.push_back(base + i);
+    }
+  }
+
+#ifdef SIMPLEDB_X86_KERNELS
+  __attribute__((target("avx2")))
+  static void equalsInt32Avx2(const int32_t* data, size_t n, int32_t target, size_t base, std::vector<size_t>& out) {
+    const __m256i t = _mm256_set1_epi32(target);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+      const __m256i* p = reinterpret_cast<const __m256i*>(data + i);
+      const uint32_t m0 = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_loadu_si256(p), t)));
+      const uint32_t m1 = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_loadu_si256(p + 1), t)));
+      const uint32_t m2 = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_loadu_si256(p + 2), t)));
+      const uint32_t m3 = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_loadu_si256(p + 3), t)));
+      emitMask(m0 | (m1 << 8) | (m2 << 16) | (m3 << 24), base + i, out);
+    }
+    equalsInt32Scalar(data + i, n - i, target, base + i, out);
+  }
+
+  __attribute__((target("avx2")))
+  static void betweenInt32Avx2(const int32_t* data, size_t n, int32_t lo, int32_t hi, size_t base, std::vector<size_t>& out) {
+    const __m256i l = _mm256_set1_epi32(lo);
+    const __m256i h = _mm256_set1_epi32(hi);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+      uint32_t outside = 0;
+      for (int k = 0; k < 4; ++k) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i) + k);
+        const __m256i miss = _mm256_or_si256(_mm256_cmpgt_epi32(l, v), _mm256_cmpgt_epi32(v, h));
+        outside |= static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(miss))) << (8 * k);
+      }
+      emitMask(~outside, base + i, out);
+    }
+    betweenInt32Scalar(data + i, n - i, lo, hi, base + i, out);
+  }
+
+  __attribute__((target("avx2")))
+  static void equalsUInt8Avx2(const uint8_t* data, size_t n, uint8_t target, size_t base, std::vector<size_t>& out) {
+    const __m256i t = _mm256_set1_epi8(static_cast<char>(target));
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+      const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+      emitMask(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, t))), base + i, out);
+    }
+    equalsUInt8Scalar(data + i, n - i, target, base + i, out);
+  }
+
+  static void equalsInt32Sse2(const int32_t* data, size_t n, int32_t target, size_t base, std::vector<size_t>& out) {
+    const __m128i t = _mm_set1_epi32(target);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+      uint32_t mask = 0;
+      for (int k = 0; k < 4; ++k) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i) + k);
+        mask |= static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, t)))) << (4 * k);
+      }
+      emitMask(mask, base + i, out);
+    }
+    equalsInt32Scalar(data + i, n - i, target, base + i, out);
+  }
+
+  static void betweenInt32Sse2(const int32_t* data, size_t n, int32_t lo, int32_t hi, size_t base, std::vector<size_t>& out) {
+    const __m128i l = _mm_set1_epi32(lo);
+    const __m128i h = _mm_set1_epi32(hi);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+      uint32_t outside = 0;
+      for (int k = 0; k < 4; ++k) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i) + k);
+        const __m128i miss = _mm_or_si128(_mm_cmpgt_epi32(l, v), _mm_cmpgt_epi32(v, h));
+        outside |= static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(miss))) << (4 * k);
+      }
+      emitMask(~outside & 0xFFFFu, base + i, out);
+    }
+    betweenInt32Scalar(data + i, n - i, lo, hi, base + i, out);
+  }
+
+  static void equalsUInt8Sse2(const uint8_t* data, size_t n, uint8_t target, size_t base, std::vector<size_t>& out) {
+    const __m128i t = _mm_set1_epi8(static_cast<char>(target));
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+      const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+      emitMask(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, t))), base + i, out);
+    }
+    equalsUInt8Scalar(data + i, n - i, target, base + i, out);
+  }
+#endif
+};
+
+#endif
@@ -3,10 +3,22 @@
 
 #include "table.h"
 #include "value.h"
+#include "persistence/mapped_file.h"
+#include "persistence/table_file.h"
+#include "persistence/wal.h"
+#include "concurrency/thread_pool.h"
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <fstream>
+#include <functional>
+#include <mutex>
+#include <iostream>
+#include <iterator>
+#include <sstream>
 #include <vector>
 #include <stdexcept>
 #include <cstring>
@@ -21,14 +33,50 @@ to create, load, and retrieve tables.
 Storage class acts as an in memory/temporary database management system (DBMS) that allows
 creating, storing, retrieving, and persisting tables. It uses the filesystem to
 save and load table data, ensuring data durability across program executions.
+
+Tables are opened lazily: at startup only the catalog of table names is
+built from the .tbl files in the database directory. A table file is
+memory-mapped and decoded the first time getTable/getTableConst asks for
+it, so startup cost does not depend on the size of the data and tables a
+session never touches take no memory.
+
+Changes are made durable by appending them to a write-ahead log; tables
+touched since the last checkpoint are "dirty" and get written out (and the
+log reset) once the log grows past WAL_CHECKPOINT_BYTES or on checkpoint().
+
+Loading runs on a thread pool sized at construction: loadAllTables decodes
+independent tables concurrently, and every table load (eager or lazy)
+builds its indexes in parallel. Queries scan on a separate pool whose size
+is the session's parallelism (setParallelism, SET parallelism = N).
+Hash joins that outgrow setJoinMemoryLimit spill to getSpillDirectory().
+
+Indexes are opt-in (createIndex/dropIndex). Their definitions are part of
+the table file, so index DDL rewrites that file immediately instead of
+going through the write-ahead log.
+How commits reach the disk is controlled by setSyncMode/setCommitWindow,
+see WriteAheadLog for the group commit protocol.
 ===========================================================================
 */
 class Storage {
+public:
+  static constexpr size_t WAL_CHECKPOINT_BYTES = 8 * 1024 * 1024;
+  static constexpr size_t DEFAULT_JOIN_MEMORY = 256 * 1024 * 1024;
+
 private:
   std::string dbName;
-  std::unordered_map<std::string, Table> tables;
+  std::unordered_set<std::string> catalog;             // Every known table, loaded or not
+  mutable std::unordered_map<std::string, Table> tables; // Tables materialized so far
+  WriteAheadLog wal;
+  mutable std::unordered_map<std::string, uint64_t> checkpointLsns; // Last WAL record contained in each table file
+  std::unordered_set<std::string> dirtyTables;
+  std::mutex writeMutex;           // Serializes table mutation, WAL appends and checkpoints
+  mutable std::mutex catalogMutex; // Guards catalog, tables and checkpointLsns
+  std::unique_ptr<ThreadPool> loadPool; // Decodes tables and builds their indexes
+  std::shared_ptr<ThreadPool> queryPool; // Runs morsel-parallel scans; replaced by setParallelism
+  mutable std::mutex queryPoolMutex;     // Guards queryPool
+  std::atomic<size_t> joinMemoryLimit{DEFAULT_JOIN_MEMORY};
   
-  std::string get_base_path() {
+  std::string get_base_path() const {
     const char* home = getenv("HOME");
     if (home) {
       return std::string(home) + "/simpledb/" + dbName;
@@ -36,26 +84,170 @@ private:
     return "./simpledb/" + dbName;
   }
   
-  std::string get_table_path(const std::string& table_name) {
+  std::string get_table_path(const std::string& table_name) const {
     return get_base_path() + "/" + table_name + ".tbl";
   }
+
+  /**
+   * Registers every .tbl file in the database directory in the catalog
+   * without opening it.
+   */
+  void registerTables() {
+    for (const auto& entry : std::filesystem::directory_iterator(get_base_path())) {
+      if (entry.is_regular_file() && entry.path().extension() == ".tbl") {
+        catalog.insert(entry.path().stem().string());
+      }
+    }
+  }
+
+  /**
+   * Maps a table file and decodes it. Legacy text files are converted to
+   * the binary format in place.
+   */
+  Table decodeTableFile(const std::string& tableName, uint64_t& checkpointLsn) const {
+    const std::string path = get_table_path(tableName);
+    MappedFile file(path);
+    if (TableFile::isBinary(file.data(), file.size())) {
+      return TableFile::read(tableName, file.data(), file.size(), &checkpointLsn, loadPool.get());
+    }
+
+    std::istringstream legacy(std::string(reinterpret_cast<const char*>(file.data()), file.size()));
+    Table table = TableFile::readLegacyText(tableName, legacy);
+    TableFile::write(table, path);
+    checkpointLsn = 0;
+    std::cout << "Converted table " << tableName << " to binary format" << std::endl;
+    return table;
+  }
+
+  // Returns the in-memory table, loading it on first access. Caller holds catalogMutex.
+  Table& materializeLocked(const std::string& tableName) const {
+    auto it = tables.find(tableName);
+    if (it != tables.end()) {
+      return it->second;
+    }
+    if (catalog.find(tableName) == catalog.end()) {
+      throw std::out_of_range("Table not found");
+    }
+    uint64_t checkpointLsn = 0;
+    Table table = decodeTableFile(tableName, checkpointLsn);
+    checkpointLsns[tableName] = checkpointLsn;
+    return tables.emplace(tableName, std::move(table)).first->second;
+  }
+
+  Table& materialize(const std::string& tableName) const {
+    std::lock_guard<std::mutex> lock(catalogMutex);
+    return materializeLocked(tableName);
+  }
+
+  // Writes a loaded table to its file. Caller holds writeMutex and catalogMutex.
+  void persistTableLocked(const std::string& tableName) {
+    auto it = tables.find(tableName);
+    if (it == tables.end()) {
+      throw std::invalid_argument("Table not found");
+    }
+    TableFile::write(it->second, get_table_path(tableName), wal.lastLsn(),
+                     wal.getSyncMode() != WriteAheadLog::SyncMode::OFF);
+    checkpointLsns[tableName] = wal.lastLsn();
+    dirtyTables.erase(tableName);
+  }
+
+  // Highest checkpoint LSN of any table file, read from the file headers only.
+  uint64_t maxCheckpointLsnOnDisk() const {
+    uint64_t maxLsn = 0;
+    for (const std::string& tableName : catalog) {
+      try {
+        MappedFile file(get_table_path(tableName));
+        if (TableFile::isBinary(file.data(), file.size())) {
+          maxLsn = std::max(maxLsn, TableFile::readHeader(file.data(), file.size()).checkpointLsn);
+        }
+      } catch (const std::exception& e) {
+        std::cerr << "Failed to read header of table " << tableName << ": " << e.what() << std::endl;
+      }
+    }
+    return maxLsn;
+  }
+
+  void applyWalRecord(const WriteAheadLog::Record& record) {
+    switch (record.type) {
+      case WriteAheadLog::CREATE_TABLE:
+        if (catalog.find(record.tableName) == catalog.end()) {
+          catalog.insert(record.tableName);
+          tables[record.tableName] = Table(record.tableName, record.columnNames, record.columnTypes);
+          dirtyTables.insert(record.tableName);
+        }
+        break;
+      case WriteAheadLog::INSERT: {
+        Table& table = materialize(record.tableName);
+        auto lsnIt = checkpointLsns.find(record.tableName);
+        if (lsnIt != checkpointLsns.end() && record.lsn <= lsnIt->second) {
+          return; // Already folded into the table file
+        }
+        table.insertRow(record.values);
+        dirtyTables.insert(record.tableName);
+        break;
+      }
+      case WriteAheadLog::INSERT_ROWS: {
+        Table& table = materialize(record.tableName);
+        auto lsnIt = checkpointLsns.find(record.tableName);
+        if (lsnIt != checkpointLsns.end() && record.lsn <= lsnIt->second) {
+          return; // Already folded into the table file
+        }
+        table.insertRows(record.rows, loadPool.get());
+        dirtyTables.insert(record.tableName);
+        break;
+      }
+    }
+  }
+
+  /**
+   * Replays the write-ahead log on top of the tables loaded from disk,
+   * then folds the recovered changes into the table files.
+   */
+  void recoverFromWal() {
+    // A missing log must restart numbering above what the table files already contain.
+    uint64_t maxCheckpointLsn = 0;
+    if (!std::filesystem::exists(get_base_path() + "/wal.log")) {
+      maxCheckpointLsn = maxCheckpointLsnOnDisk();
+    }
+
+    size_t recovered = wal.replay([this](const WriteAheadLog::Record& record) {
+      try {
+        applyWalRecord(record);
+      } catch (const std::exception& e) {
+        std::cerr << "Skipping write-ahead log record " << record.lsn << ": " << e.what() << std::endl;
+      }
+    }, maxCheckpointLsn + 1);
+
+    if (recovered > 0) {
+      std::cout << "Recovered " << recovered << " record(s) from write-ahead log" << std::endl;
+      checkpoint();
+    }
+  }
   
 public:
   /**
    * Constructor that initializes the Storage with a database name.
-   * Creates the necessary directory structure and loads existing tables from disk.
+   * Creates the necessary directory structure, registers the tables found
+   * on disk in the catalog and replays the write-ahead log. Table data is
+   * only read when a table is first accessed.
    * 
    * @param name Name of the database.
+   * @param loadThreads Threads used to load tables and build indexes; 0 means one per hardware thread.
    * @example
    * Storage storage("myDatabase");
+   * Storage serial("myDatabase", 1);
    */
-  Storage(const std::string& name) : dbName(name) {
+  Storage(const std::string& name, size_t loadThreads = 0)
+      : dbName(name), wal(get_base_path() + "/wal.log"), loadPool(std::make_unique<ThreadPool>(loadThreads)),
+        queryPool(std::make_shared<ThreadPool>()) {
     std::filesystem::create_directories(get_base_path());
-    loadAllTables();
+    registerTables();
+    recoverFromWal();
   }
 
   /**
-   * Loads all tables from disk into memory.
+   * Loads every table in the catalog that is not in memory yet.
+   * Tables are decoded concurrently on the load pool.
    * Skips files that cannot be loaded and logs errors.
    * 
    * 
@@ -64,24 +256,52 @@ public:
    * storage.loadAllTables();
    */
   void loadAllTables() {
-    std::string basePath = get_base_path();
-    if (!std::filesystem::exists(basePath)) {
-      return; 
-    }
-    
-    for (const auto& entry : std::filesystem::directory_iterator(basePath)) {
-      if (entry.is_regular_file() && entry.path().extension() == ".tbl") {
-        std::string tableName = entry.path().stem().string();
-        try {
-          loadTable(tableName);
-          std::cout << "Loaded table: " << tableName << std::endl;
-        } catch (const std::exception& e) {
-          std::cerr << "Failed to load table " << tableName << ": " << e.what() << std::endl;
-        } catch (const char* msg) {
-          std::cerr << "Failed to load table " << tableName << ": " << msg << std::endl;
+    std::vector<std::string> pending;
+    {
+      std::lock_guard<std::mutex> lock(catalogMutex);
+      for (const std::string& tableName : catalog) {
+        if (tables.find(tableName) == tables.end()) {
+          pending.push_back(tableName);
         }
       }
     }
+
+    loadPool->parallelFor(pending.size(), [this, &pending](size_t i) {
+      const std::string& tableName = pending[i];
+      try {
+        uint64_t checkpointLsn = 0;
+        Table table = decodeTableFile(tableName, checkpointLsn);
+        std::lock_guard<std::mutex> lock(catalogMutex);
+        // Keep the copy another thread may have loaded (and modified) meanwhile
+        if (tables.find(tableName) == tables.end()) {
+          tables.emplace(tableName, std::move(table));
+          checkpointLsns[tableName] = checkpointLsn;
+        }
+        std::cout << "Loaded table: " << tableName << std::endl;
+      } catch (const std::exception& e) {
+        std::lock_guard<std::mutex> lock(catalogMutex);
+        std::cerr << "Failed to load table " << tableName << ": " << e.what() << std::endl;
+      } catch (const char* msg) {
+        std::lock_guard<std::mutex> lock(catalogMutex);
+        std::cerr << "Failed to load table " << tableName << ": " << msg << std::endl;
+      }
+    });
+  }
+
+  // Number of threads used to load tables and build indexes.
+  size_t getLoadThreads() const {
+    return loadPool->size();
+  }
+
+  /**
+   * Returns whether a table is currently materialized in memory.
+   * 
+   * @param tableName Name of the table.
+   * @return true if the table has been loaded or created in this session.
+   */
+  bool isTableLoaded(const std::string& tableName) const {
+    std::lock_guard<std::mutex> lock(catalogMutex);
+    return tables.find(tableName) != tables.end();
   }
 
   /**
@@ -98,157 +318,329 @@ public:
    * storage.createTable("users", {"id", "name", "email"});
    */
   void createTable(const std::string& tableName, const std::vector<std::string>& columns, const std::vector<Value::Type>& columnTypes) {
-    if (tables.find(tableName) != tables.end()) {
-      throw std::invalid_argument("Table already exists");
+    uint64_t lsn;
+    {
+      std::lock_guard<std::mutex> lock(writeMutex);
+      std::lock_guard<std::mutex> catalogLock(catalogMutex);
+      if (catalog.find(tableName) != catalog.end()) {
+        throw std::invalid_argument("Table already exists");
+      }
+      tables[tableName] = Table(tableName, columns, columnTypes);
+      catalog.insert(tableName);
+      lsn = wal.appendCreateTable(tableName, columns, columnTypes);
+      dirtyTables.insert(tableName);
     }
-    tables[tableName] = Table(tableName, columns, columnTypes);
+    wal.commit(lsn);
   }
 
-  void persistTable(const std::string& tableName) {
-    auto it = tables.find(tableName);
-    if (it == tables.end()) {
-      throw std::invalid_argument("Table not found");
+  /**
+   * Inserts a row into a table and commits it to the write-ahead log.
+   * Safe to call from several threads; concurrent inserts share a log flush.
+   * Triggers a checkpoint once the log has grown past WAL_CHECKPOINT_BYTES.
+   * 
+   * @param tableName Name of the table to insert into.
+   * @param values The row to insert.
+   * @throws std::out_of_range if the table does not exist.
+   * @throws std::invalid_argument if the row does not match the table schema.
+   * 
+   * @example
+   * storage.insertRow("users", {Value(1), Value("Alice")});
+   */
+  void insertRow(const std::string& tableName, const std::vector<Value>& values) {
+    uint64_t lsn;
+    {
+      std::lock_guard<std::mutex> lock(writeMutex);
+      getTable(tableName).insertRow(values);
+      lsn = wal.appendInsert(tableName, values);
+      dirtyTables.insert(tableName);
     }
+    wal.commit(lsn);
 
-    std::ofstream outFile(get_table_path(tableName));
-    if (!outFile) {
-      throw std::runtime_error("Failed to open file for writing");
+    if (wal.pendingBytes() >= WAL_CHECKPOINT_BYTES) {
+      checkpoint();
     }
+  }
 
-    Table& table = it->second;
-    std::vector<std::string> columnNames = table.getColumnNames();
-    
-    // Write column count
-    outFile << columnNames.size() << "\n";
-    
-    // Write column names
-    for (const std::string& colName : columnNames) {
-      outFile << colName << "\n";
+  /**
+   * Inserts several rows into a table as one statement. The rows are logged
+   * as a single write-ahead log record and committed once, so after a crash
+   * either all of them or none are recovered.
+   * 
+   * @param tableName Name of the table to insert into.
+   * @param rows The rows to insert.
+   * @throws std::out_of_range if the table does not exist.
+   * @throws std::invalid_argument if any row does not match the table schema; nothing is inserted then.
+   * 
+   * @example
+   * storage.insertRows("users", {{Value(1), Value("Alice")}, {Value(2), Value("Bob")}});
+   */
+  void insertRows(const std::string& tableName, const std::vector<std::vector<Value>>& rows) {
+    if (rows.empty()) return;
+    uint64_t lsn;
+    {
+      std::lock_guard<std::mutex> lock(writeMutex);
+      getTable(tableName).insertRows(rows, loadPool.get());
+      lsn = wal.appendInsertRows(tableName, rows);
+      dirtyTables.insert(tableName);
     }
+    wal.commit(lsn);
 
-    for (const Value::Type& type : table.getColumnTypes()) {
-      outFile << Value::typeToString(type) << "\n";
+    if (wal.pendingBytes() >= WAL_CHECKPOINT_BYTES) {
+      checkpoint();
     }
-    
-    // Write row count
-    outFile << table.getRowCount() << "\n";
-    
-    // Write rows
-    for(size_t i = 0; i < table.getRowCount(); i++) {
-      const std::vector<Value>& row = table.getRow(i);
-      for (size_t j = 0; j < row.size(); j++) {
-        const Value& val = row[j];
-        Value::Type type = val.getType();
-        
-        // Write type identifier
-        outFile << static_cast<int>(type) << " ";
-        
-        // Write value based on type
-        switch (type) {
-          case Value::INT:
-            outFile << val.getInt();
-            break;
-          case Value::STRING:
-            outFile << "\"" << val.getString() << "\"";
-            break;
-          case Value::BOOL:
-            outFile << (val.getBool() ? "true" : "false");
-            break;
-          default:
-            break;
-        }
-        
-        if (j < row.size() - 1) {
-          outFile << " ";
-        }
+  }
+
+  /**
+   * Bulk loads rows into a table. nextBatch is called repeatedly to refill
+   * a batch of rows until it returns false. Batches are appended without
+   * index maintenance or logging; once the source is exhausted the indexes
+   * are rebuilt in one pass and the table file is written once, which makes
+   * the load durable.
+   * If nextBatch or a row throws, every row appended by this call is
+   * removed again and the exception is rethrown.
+   * 
+   * @param tableName Name of the table to load into.
+   * @param nextBatch Fills its argument with the next rows; returns false when there are no more.
+   * @return Number of rows loaded.
+   * @throws std::out_of_range if the table does not exist.
+   * @throws std::invalid_argument if a row does not match the table schema.
+   * 
+   * @example
+   * size_t loaded = storage.copyRows("users", [&](std::vector<std::vector<Value>>& batch) {
+   *   return reader.readBatch(batch);
+   * });
+   */
+  size_t copyRows(const std::string& tableName, const std::function<bool(std::vector<std::vector<Value>>&)>& nextBatch) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    Table& table = getTable(tableName);
+    const size_t firstRow = table.getRowCount();
+    std::vector<std::vector<Value>> batch;
+    try {
+      while (nextBatch(batch)) {
+        table.appendRows(batch);
       }
-      outFile << "\n";
+    } catch (...) {
+      table.truncateRows(firstRow);
+      table.buildIndexes(loadPool.get());
+      throw;
     }
-    
-    outFile.close();
+    table.buildIndexes(loadPool.get());
+
+    std::lock_guard<std::mutex> catalogLock(catalogMutex);
+    persistTableLocked(tableName);
+    return table.getRowCount() - firstRow;
   }
-  
+
   /**
-   * Loads a table from disk into memory.
-   * Throws an exception if the table file cannot be read or is malformed.
+   * Sets how commits are made durable.
    * 
-   * @param tableName Name of the table to load.
-   * @throws const char* if file operations fail or data is malformed.
+   * @param mode OFF (no fsync), BATCH (group commit with a commit window) or FULL (fsync every commit).
    * 
    * @example
-   * Storage storage("myDatabase");
-   * storage.loadTable("users");
+   * storage.setSyncMode(WriteAheadLog::SyncMode::BATCH);
    */
-  void loadTable(std::string& tableName) {
-    std::ifstream inFile(get_table_path(tableName));
-    if (!inFile) {
-      throw std::runtime_error("Failed to open file for reading");
-    }
+  void setSyncMode(WriteAheadLog::SyncMode mode) {
+    wal.setSyncMode(mode);
+  }
+
+  WriteAheadLog::SyncMode getSyncMode() const {
+    return wal.getSyncMode();
+  }
+
+  /**
+   * Sets how long a BATCH commit waits for other commits to share its flush.
+   * 
+   * @param window Commit window in microseconds.
+   * 
+   * @example
+   * storage.setCommitWindow(std::chrono::microseconds(500));
+   */
+  void setCommitWindow(std::chrono::microseconds window) {
+    wal.setCommitWindow(window);
+  }
 
-    size_t columnCount;
-    inFile >> columnCount;
-    inFile.ignore(); // Skip newline
+  std::chrono::microseconds getCommitWindow() const {
+    return wal.getCommitWindow();
+  }
 
-    std::vector<std::string> columnNames;
-    for (size_t i = 0; i < columnCount; ++i) {
-      std::string colName;
-      std::getline(inFile, colName);
-      columnNames.push_back(colName);
+  /**
+   * Sets how many threads a query may use for full scans. Queries already
+   * running keep the pool they started with.
+   * 
+   * @param threads Total threads per scan, including the querying thread; 1 scans serially.
+   * @throws std::invalid_argument if threads is 0 or above ThreadPool::maxThreads().
+   * 
+   * @example
+   * storage.setParallelism(4);
+   */
+  void setParallelism(size_t threads) {
+    if (threads == 0) {
+      throw std::invalid_argument("parallelism must be at least 1");
+    }
+    if (threads > ThreadPool::maxThreads()) {
+      throw std::invalid_argument("parallelism must be at most " + std::to_string(ThreadPool::maxThreads()));
     }
+    auto pool = std::make_shared<ThreadPool>(threads);
+    std::lock_guard<std::mutex> lock(queryPoolMutex);
+    queryPool = std::move(pool);
+  }
+
+  size_t getParallelism() const {
+    return getQueryPool()->size();
+  }
 
-    std::vector<Value::Type> columnTypes;
-    for (size_t i = 0; i < columnCount; ++i) {
-      std::string typeStr;
-      std::getline(inFile, typeStr);
-      columnTypes.push_back(Value::stringToType(typeStr));
+  // Pool for query scans. Holding the returned pointer keeps the pool alive across a setParallelism.
+  std::shared_ptr<ThreadPool> getQueryPool() const {
+    std::lock_guard<std::mutex> lock(queryPoolMutex);
+    return queryPool;
+  }
+
+  /**
+   * Sets how much working memory a hash join may use before it spills its
+   * partitions to files in getSpillDirectory().
+   * 
+   * @param bytes Memory limit per join.
+   * @throws std::invalid_argument if bytes is 0.
+   * 
+   * @example
+   * storage.setJoinMemoryLimit(64 * 1024 * 1024);
+   */
+  void setJoinMemoryLimit(size_t bytes) {
+    if (bytes == 0) {
+      throw std::invalid_argument("join memory limit must be positive");
     }
+    joinMemoryLimit = bytes;
+  }
 
-    Table table(tableName, columnNames, columnTypes);
-    
-    size_t rowCount;
-    inFile >> rowCount;
-    inFile.ignore(); // Skip newline
-    
-    for (size_t i = 0; i < rowCount; i++) {
-      std::vector<Value> row;
-      std::string line;
-      std::getline(inFile, line);
-      std::stringstream ss(line);
-      
-      for (size_t j = 0; j < columnCount; j++) {
-        int typeInt;
-        ss >> typeInt;
-        Value::Type type = static_cast<Value::Type>(typeInt);
-        
-        std::string valueStr;
-        ss >> valueStr;
-        
-        switch (type) {
-          case Value::INT:
-            row.emplace_back(std::stoi(valueStr));
-            break;
-          case Value::STRING:
-            // Remove quotes
-            if (valueStr.size() >= 2 && valueStr.front() == '"' && valueStr.back() == '"') {
-              valueStr = valueStr.substr(1, valueStr.size() - 2);
-            }
-            row.emplace_back(valueStr);
-            break;
-          case Value::BOOL:
-            row.emplace_back(valueStr == "true");
-            break;
-          default:
-            break;
-        }
+  size_t getJoinMemoryLimit() const {
+    return joinMemoryLimit;
+  }
+
+  // Directory for temporary files of queries that spill to disk.
+  std::string getSpillDirectory() const {
+    return get_base_path() + "/tmp";
+  }
+
+  /**
+   * Writes every table changed since the last checkpoint to disk and resets
+   * the write-ahead log.
+   * 
+   * @example
+   * Storage storage("myDatabase");
+   * storage.checkpoint();
+   */
+  void checkpoint() {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    std::lock_guard<std::mutex> catalogLock(catalogMutex);
+    const bool sync = wal.getSyncMode() != WriteAheadLog::SyncMode::OFF;
+    const uint64_t lsn = wal.lastLsn();
+    for (const std::string& tableName : dirtyTables) {
+      auto it = tables.find(tableName);
+      if (it != tables.end()) {
+        TableFile::write(it->second, get_table_path(tableName), lsn, sync);
+        checkpointLsns[tableName] = lsn;
       }
-      table.insertRow(row);
     }
+    dirtyTables.clear();
+    wal.reset();
+  }
 
-    tables[tableName] = table;
+  /**
+   * Writes a table to its .tbl file in the binary page format.
+   * See TableFile for the on-disk layout.
+   * 
+   * @param tableName Name of the table to persist.
+   * @throws std::invalid_argument if the table does not exist.
+   * @throws std::runtime_error if the file cannot be written.
+   * 
+   * @example
+   * Storage storage("myDatabase");
+   * storage.persistTable("users");
+   */
+  void persistTable(const std::string& tableName) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    std::lock_guard<std::mutex> catalogLock(catalogMutex);
+    persistTableLocked(tableName);
+  }
+
+  /**
+   * Creates an index on a table column and builds it over the existing rows.
+   * The definition is stored in the table file, which is rewritten at once.
+   * 
+   * @param tableName Name of the table.
+   * @param definition Name, column and kind of the index.
+   * @throws std::out_of_range if the table does not exist.
+   * @throws std::invalid_argument if the column does not exist, the index name is taken or the kind is unsupported.
+   * 
+   * @example
+   * storage.createIndex("users", {"users_age", "age", IndexKind::BTREE});
+   */
+  void createIndex(const std::string& tableName, const IndexDefinition& definition) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    std::lock_guard<std::mutex> catalogLock(catalogMutex);
+    materializeLocked(tableName).createIndex(definition);
+    persistTableLocked(tableName);
+  }
+
+  /**
+   * Collects column statistics for a table (ANALYZE, see Table::analyze) and
+   * rewrites the table file so they are kept across restarts.
+   * 
+   * @param tableName Name of the table.
+   * @throws std::out_of_range if the table does not exist.
+   * 
+   * @example
+   * storage.analyzeTable("users");
+   */
+  void analyzeTable(const std::string& tableName) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    std::lock_guard<std::mutex> catalogLock(catalogMutex);
+    materializeLocked(tableName).analyze(loadPool.get());
+    persistTableLocked(tableName);
+  }
+
+  /**
+   * Drops an index from a table and rewrites the table file without it.
+   * 
+   * @param tableName Name of the table.
+   * @param indexName Name of the index.
+   * @throws std::out_of_range if the table does not exist.
+   * @throws std::invalid_argument if the table has no such index.
+   * 
+   * @example
+   * storage.dropIndex("users", "users_age");
+   */
+  void dropIndex(const std::string& tableName, const std::string& indexName) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    std::lock_guard<std::mutex> catalogLock(catalogMutex);
+    materializeLocked(tableName).dropIndex(indexName);
+    persistTableLocked(tableName);
   }
   
   /**
-   * Retrieves a reference to a table by name.
+   * Loads a table from disk into memory, replacing any in-memory copy.
+   * The file is memory-mapped while it is decoded. Files still in the
+   * legacy text format are converted to the binary format in place.
+   * Throws an exception if the table file cannot be read or is malformed.
+   * 
+   * @param tableName Name of the table to load.
+   * @throws std::runtime_error if file operations fail or data is malformed.
+   * 
+   * @example
+   * Storage storage("myDatabase");
+   * storage.loadTable("users");
+   */
+  void loadTable(const std::string& tableName) {
+    uint64_t checkpointLsn = 0;
+    Table table = decodeTableFile(tableName, checkpointLsn);
+    std::lock_guard<std::mutex> lock(catalogMutex);
+    tables[tableName] = std::move(table);
+    checkpointLsns[tableName] = checkpointLsn;
+    catalog.insert(tableName);
+  }
+  
+  /**
+   * Retrieves a reference to a table by name, loading it on first access.
    * Throws an exception if the table does not exist.
    * 
    * @param tableName Name of the table to retrieve.
@@ -260,11 +652,7 @@ public:
    * Table& usersTable = storage.getTable("users");
    */
   Table& getTable(const std::string& tableName) {
-    auto it = tables.find(tableName);
-    if (it == tables.end()) {
-      throw std::out_of_range("Table not found");
-    }
-    return it->second;
+    return materialize(tableName);
   }
 
   /**
@@ -280,15 +668,12 @@ public:
    * const Table& usersTable = storage.getTableConst("users");
    */
   const Table& getTableConst(const std::string& tableName) const {
-    auto it = tables.find(tableName);
-    if (it == tables.end()) {
-      throw std::out_of_range("Table not found");
-    }
-    return it->second;
+    return materialize(tableName);
   }
 
   /**
    * Returns a vector of all tables in the storage.
+   * Loads every table that is not in memory yet.
    * 
    * @return Vector of all Table objects.
    * @example
@@ -298,8 +683,9 @@ public:
   std::vector<Table> getAllTables() const {
     std::vector<Table> tableVec;
 
-    for (const auto& pair : tables) {
-      tableVec.push_back(pair.second);
+    std::lock_guard<std::mutex> lock(catalogMutex);
+    for (const std::string& tableName : catalog) {
+      tableVec.push_back(materializeLocked(tableName));
     }
 
     return tableVec;
@@ -0,0 +1,88 @@
+#ifndef STRING_DICTIONARY_H
+#define STRING_DICTIONARY_H
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/*
+===========================================================================
+StringDictionary Class:
+Maps the distinct strings of one STRING column to dense uint32 codes, in
+order of first appearance. Codes are never reassigned, so a code stays
+valid for as long as the dictionary lives.
+
+Strings are kept in a deque, which never moves its elements, so the
+lookup map can key on string_views into them and find() never has to
+build a std::string.
+===========================================================================
+*/
+class StringDictionary {
+private:
+  std::deque<std::string> strings;                    // By code
+  std::unordered_map<std::string_view, uint32_t> codes; // Views into strings
+
+public:
+  StringDictionary() = default;
+
+  StringDictionary(const StringDictionary& other) { *this = other; }
+
+  StringDictionary& operator=(const StringDictionary& other) {
+    if (this != &other) {
+      clear();
+      codes.reserve(other.size());
+      for (const std::string& str : other.strings) encode(str);
+    }
+    return *this;
+  }
+
+  /**
+   * Returns the code of str, adding it to the dictionary if it is new.
+   *
+   * @param str String to encode.
+   * @return Its code.
+   * @throws std::length_error if the dictionary already holds 2^32 - 1 strings.
+   *
+   * @example
+   * uint32_t code = dictionary.encode("Germany");
+   */
+  uint32_t encode(std::string_view str) {
+    auto it = codes.find(str);
+    if (it != codes.end()) return it->second;
+    if (strings.size() >= std::numeric_limits<uint32_t>::max()) {
+      throw std::length_error("String dictionary is full");
+    }
+    const uint32_t code = static_cast<uint32_t>(strings.size());
+    strings.emplace_back(str);
+    codes.emplace(strings.back(), code);
+    return code;
+  }
+
+  /**
+   * Looks up the code of str without adding it.
+   *
+   * @param str String to look up.
+   * @return Its code, or std::nullopt if str does not occur in the column.
+   */
+  std::optional<uint32_t> find(std::string_view str) const {
+    auto it = codes.find(str);
+    if (it == codes.end()) return std::nullopt;
+    return it->second;
+  }
+
+  const std::string& decode(uint32_t code) const { return strings[code]; }
+
+  size_t size() const { return strings.size(); }
+
+  void clear() {
+    codes.clear();
+    strings.clear();
+  }
+};
+
+#endif
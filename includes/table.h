@@ -2,38 +2,90 @@
 #define TABLE_H
 
 #include "value.h"
+#include "column.h"
 #include "indexing/index_manager.h"
-#include "indexing/btree.h"
+#include "indexing/bplustree.h"
+#include "concurrency/thread_pool.h"
+#include "table_statistics.h"
+#include <memory>
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <utility>
 // #include "row.h"
-// #include "column.h"
 
 class Table {
+public:
+  // insertRows rebuilds the indexes instead of updating them once a batch is
+  // at least 1/INDEX_REBUILD_RATIO of the table.
+  static constexpr size_t INDEX_REBUILD_RATIO = 8;
+
 private:
   std::string tableName;
   std::vector<std::string> columnNames;
   std::vector<Value::Type> columnTypes;
   std::unordered_map<std::string, size_t> columnIndexMap;
-  std::vector<std::vector<Value>> rows;
+  std::vector<Column> columns; // Column-major storage, one Column per entry in columnNames
+  size_t rowCount = 0;
   std::unique_ptr<IndexManager> indexManager; 
+  std::shared_ptr<const TableStatistics> statistics; // From the last ANALYZE, if any
 
-  void initializeIndexes() {
-    indexManager = std::make_unique<IndexManager>();
+  void initializeColumns() {
+    columns.clear();
     for (size_t i = 0; i < columnNames.size(); ++i) {
-      indexManager->createIndex(columnNames[i], columnTypes[i]);
+      columns.emplace_back(columnNames[i], columnTypes[i]);
     }
   }
 
-  void rebuildIndexes() {
-    if (!indexManager) {
-      initializeIndexes();
+  const StringDictionary* dictionaryOf(size_t colIdx) const {
+    return columnTypes[colIdx] == Value::STRING ? &columns[colIdx].getDictionary() : nullptr;
+  }
+
+  // Replaces the index structures with empty ones for the given definitions.
+  void resetIndexes(const std::vector<IndexDefinition>& definitions) {
+    indexManager = std::make_unique<IndexManager>();
+    for (const IndexDefinition& def : definitions) {
+      const size_t colIdx = columnIndexMap.at(def.column);
+      indexManager->createIndex(def, columnTypes[colIdx], dictionaryOf(colIdx));
+    }
+  }
+
+  // Empties every index, keeping the definitions.
+  void initializeIndexes() {
+    std::vector<IndexDefinition> definitions;
+    if (indexManager) {
+      definitions = indexManager->getDefinitions();
+    }
+    resetIndexes(definitions);
+  }
+
+  // Bulk loads one (empty) index from its typed column array: a sort plus one pass.
+  void loadIndex(const IndexDefinition& def) {
+    const size_t colIdx = columnIndexMap.at(def.column);
+    const Column& column = columns[colIdx];
+    switch (columnTypes[colIdx]) {
+      case Value::INT:
+        indexManager->bulkLoadIndex(def.name, column.getIntValues());
+        break;
+      case Value::STRING:
+        indexManager->bulkLoadIndex(def.name, column.getDictionary(), column.getStringCodes());
+        break;
+      case Value::BOOL:
+        indexManager->bulkLoadIndex(def.name, column.getBoolValues());
+        break;
+      default:
+        break;
+    }
+  }
+
+  void validateRow(const std::vector<Value>& vals) const {
+    if (vals.size() != columnNames.size()) {
+      throw std::invalid_argument("Column count mismatch");
     }
 
-    for (size_t rowIdx = 0; rowIdx < rows.size(); ++rowIdx) {
-      for (size_t colIdx = 0; colIdx < columnNames.size(); ++colIdx) {
-        indexManager->insertIntoIndex(columnNames[colIdx], rows[rowIdx][colIdx], rowIdx);
+    for (size_t i = 0; i < vals.size(); ++i) {
+      if (!Value::isValidType(vals[i], columnTypes[i])) {
+        throw std::invalid_argument("Type mismatch for column");
       }
     }
   }
@@ -49,7 +101,8 @@ public:
       columnIndexMap[columnNames[i]] = i;
     }
 
-    initializeIndexes();
+    initializeColumns();
+    resetIndexes({});
   }
 
   Table(const Table& other)
@@ -57,9 +110,11 @@ public:
         columnNames(other.columnNames),
         columnTypes(other.columnTypes),
         columnIndexMap(other.columnIndexMap),
-        rows(other.rows) {
-    initializeIndexes();
-    rebuildIndexes();
+        columns(other.columns),
+        rowCount(other.rowCount),
+        statistics(other.statistics) {
+    resetIndexes(other.getIndexDefinitions());
+    buildIndexes();
   }
 
   Table(Table&& other) noexcept = default;
@@ -89,39 +144,211 @@ public:
    * table.insertRow({Value(1), Value("Alice"), Value(30)});
    */
   void insertRow(const std::vector<Value>& vals) {
-    if (vals.size() != columnNames.size()) {
-      throw std::invalid_argument("Column count mismatch");
+    validateRow(vals);
+
+    for (size_t i = 0; i < vals.size(); ++i) {
+      columns[i].insertValue(vals[i]);
+    }
+    size_t rowIndex = rowCount++;
+    for (const IndexDefinition& def : indexManager->getDefinitions()) {
+      indexManager->insertIntoIndex(def.name, vals[columnIndexMap.at(def.column)], rowIndex);
     }
+  }
+
+  /**
+   * Appends a row without updating the indexes.
+   * Used by bulk loads, which call buildIndexes once all rows are in.
+   * 
+   * @param vals Vector of Value objects representing the row to append.
+   * @throws std::invalid_argument if the row does not match the table schema.
+   * 
+   * @example
+   * table.appendRow({Value(1), Value("Alice"), Value(30)});
+   * table.buildIndexes();
+   */
+  void appendRow(const std::vector<Value>& vals) {
+    validateRow(vals);
 
     for (size_t i = 0; i < vals.size(); ++i) {
-      if (!Value::isValidType(vals[i], columnTypes[i])) {
-        throw std::invalid_argument("Type mismatch for column");
+      columns[i].insertValue(vals[i]);
+    }
+    ++rowCount;
+  }
+
+  /**
+   * Inserts several rows as one operation: either every row goes in or, if
+   * any row does not match the schema, none does. Indexes are maintained
+   * row by row while the batch is small next to the table; once it is at
+   * least 1/INDEX_REBUILD_RATIO of the resulting table, rebuilding every
+   * index in bulk is cheaper and is done instead.
+   * 
+   * @param rows Rows to insert.
+   * @param pool Optional thread pool for an index rebuild.
+   * @throws std::invalid_argument if any row does not match the table schema.
+   * 
+   * @example
+   * table.insertRows({{Value(1), Value("Alice")}, {Value(2), Value("Bob")}});
+   */
+  void insertRows(const std::vector<std::vector<Value>>& rows, ThreadPool* pool = nullptr) {
+    const size_t firstRow = rowCount;
+    appendRows(rows);
+
+    const std::vector<IndexDefinition>& definitions = indexManager->getDefinitions();
+    if (definitions.empty() || rows.empty()) return;
+    if (rows.size() * INDEX_REBUILD_RATIO >= rowCount) {
+      buildIndexes(pool);
+      return;
+    }
+    for (const IndexDefinition& def : definitions) {
+      const Column& column = columns[columnIndexMap.at(def.column)];
+      for (size_t row = firstRow; row < rowCount; ++row) {
+        indexManager->insertIntoIndex(def.name, column.getValue(row), row);
       }
     }
+  }
 
-    rows.push_back(vals);
-    size_t rowIndex = rows.size() - 1;
-    for (size_t i = 0; i < vals.size(); ++i) {
-      indexManager->insertIntoIndex(columnNames[i], vals[i], rowIndex);
+  /**
+   * Appends several rows without updating the indexes; every row is
+   * validated before any is appended. Callers must run buildIndexes once
+   * they are done appending.
+   * 
+   * @param rows Rows to append.
+   * @throws std::invalid_argument if any row does not match the table schema.
+   */
+  void appendRows(const std::vector<std::vector<Value>>& rows) {
+    for (const std::vector<Value>& row : rows) {
+      validateRow(row);
+    }
+    for (size_t i = 0; i < columns.size(); ++i) {
+      Column& column = columns[i];
+      column.reserve(rowCount + rows.size());
+      for (const std::vector<Value>& row : rows) {
+        column.insertValue(row[i]);
+      }
+    }
+    rowCount += rows.size();
+  }
+
+  /**
+   * Drops every row from row n on, without updating the indexes. Used to
+   * undo a bulk append that failed part way; run buildIndexes afterwards.
+   * 
+   * @param n Number of rows to keep.
+   */
+  void truncateRows(size_t n) {
+    if (n >= rowCount) return;
+    for (Column& column : columns) {
+      column.truncate(n);
+    }
+    rowCount = n;
+  }
+
+  /**
+   * Discards the contents of every index and rebuilds them from the column data.
+   * Every index is bulk loaded (sorted, then built bottom-up) rather than
+   * filled row by row. The indexes are independent, so with a pool they
+   * are built concurrently.
+   * 
+   * @param pool Optional thread pool to build the indexes on.
+   * 
+   * @example
+   * ThreadPool pool(4);
+   * table.buildIndexes(&pool);
+   */
+  void buildIndexes(ThreadPool* pool = nullptr) {
+    initializeIndexes();
+
+    const std::vector<IndexDefinition>& definitions = indexManager->getDefinitions();
+    if (pool) {
+      pool->parallelFor(definitions.size(), [&](size_t i) { loadIndex(definitions[i]); });
+    } else {
+      for (const IndexDefinition& def : definitions) {
+        loadIndex(def);
+      }
+    }
+  }
+
+  /**
+   * Creates an index over existing data and keeps it up to date on insert.
+   * 
+   * @param definition Name, column and kind of the index.
+   * @throws std::invalid_argument if the column does not exist, the name is taken or the kind is unsupported.
+   * 
+   * @example
+   * table.createIndex({"users_age", "age", IndexKind::BTREE});
+   */
+  void createIndex(const IndexDefinition& definition) {
+    auto it = columnIndexMap.find(definition.column);
+    if (it == columnIndexMap.end()) {
+      throw std::invalid_argument("Column not found: " + definition.column);
     }
+    indexManager->createIndex(definition, columnTypes[it->second], dictionaryOf(it->second));
+    loadIndex(definition);
+  }
+
+  /**
+   * Drops an index by name.
+   * 
+   * @param indexName Name of the index.
+   * @throws std::invalid_argument if there is no such index.
+   * 
+   * @example
+   * table.dropIndex("users_age");
+   */
+  void dropIndex(const std::string& indexName) {
+    indexManager->dropIndex(indexName);
+  }
+
+  /**
+   * Returns the definitions of the table's indexes, in creation order.
+   * 
+   * @return Const reference to the index definitions.
+   */
+  const std::vector<IndexDefinition>& getIndexDefinitions() const {
+    static const std::vector<IndexDefinition> none; // Moved-from tables have no index manager
+    return indexManager ? indexManager->getDefinitions() : none;
   }
 
   /**
    * Retrieves a row by its index.
+   * The row is reconstructed from the column storage, so prefer getColumn
+   * when scanning only a few columns.
    * 
    * @param index Index of the row to retrieve.
-   * @return Const reference to the requested row.
+   * @return The requested row, one Value per column.
    * @throws const char* if the index is out of bounds.
    * 
    * @example
    * Table table("users", {"id", "name", "age"}, {Value::INT, Value::STRING, Value::INT});
-   * const std::vector<Value>& row = table.getRow(0);
+   * std::vector<Value> row = table.getRow(0);
    */
-  const std::vector<Value>& getRow(size_t index) const {
-    if (index >= rows.size()) {
+  std::vector<Value> getRow(size_t index) const {
+    if (index >= rowCount) {
       throw std::out_of_range("Row index out of bounds");
     }
-    return rows[index];
+    std::vector<Value> row;
+    row.reserve(columns.size());
+    for (const Column& column : columns) {
+      row.push_back(column.getValue(index));
+    }
+    return row;
+  }
+
+  /**
+   * Returns the storage of a single column.
+   * 
+   * @param colIndex Position of the column, as found in getColumnIndexMap.
+   * @return Const reference to the column.
+   * @throws std::out_of_range if the column index is out of bounds.
+   * 
+   * @example
+   * const Column& ages = table.getColumn(table.getColumnIndexMap().at("age"));
+   */
+  const Column& getColumn(size_t colIndex) const {
+    if (colIndex >= columns.size()) {
+      throw std::out_of_range("Column index out of bounds");
+    }
+    return columns[colIndex];
   }
 
   /**
@@ -163,7 +390,7 @@ public:
    * Value val = table.getValue(0, "name");
    */
   const Value getValue(size_t rowIndex, const std::string& colName) const {
-    if (rowIndex >= rows.size()) {
+    if (rowIndex >= rowCount) {
       throw std::out_of_range("Row index out of bounds");
     }
     auto it = columnIndexMap.find(colName);
@@ -171,7 +398,7 @@ public:
       throw std::invalid_argument("Column not found");
     }
 
-    return rows[rowIndex][it->second];
+    return columns[it->second].getValue(rowIndex);
   }
 
   /**
@@ -187,7 +414,7 @@ public:
    * table.setValue(0, "age", Value(31));
    */
   void setValue(size_t rowIndex, const std::string& colName, const Value& val) {
-    if (rowIndex >= rows.size()) {
+    if (rowIndex >= rowCount) {
       throw std::out_of_range("Row index out of bounds");
     }
 
@@ -201,7 +428,7 @@ public:
       throw std::invalid_argument("Type mismatch for column");
     }
 
-    rows[rowIndex][it->second] = val;
+    columns[it->second].setValue(val, rowIndex);
   }
 
   /**
@@ -213,7 +440,7 @@ public:
    * size_t rowCount = table.getRowCount();
    */
   size_t getRowCount() const {
-    return rows.size();
+    return rowCount;
   }
 
   /**
@@ -224,7 +451,10 @@ public:
    * table.clearRows();
    */
   void clearRows() {
-    rows.clear();
+    for (Column& column : columns) {
+      column.clear();
+    }
+    rowCount = 0;
     initializeIndexes();
   }
 
@@ -251,12 +481,15 @@ public:
     columnNames.push_back(colName);
     columnTypes.push_back(type);
     columnIndexMap[colName] = columnNames.size() - 1;
-    for (auto& row : rows) {
-      row.push_back(defaultValue);
+    Column column(colName, type);
+    column.reserve(rowCount);
+    for (size_t i = 0; i < rowCount; ++i) {
+      column.insertValue(defaultValue);
     }
+    columns.push_back(std::move(column));
+    statistics.reset(); // No longer one entry per column
 
-    initializeIndexes();
-    rebuildIndexes();
+    buildIndexes();
   }
 
     /**
@@ -286,18 +519,163 @@ public:
     return columnTypes;
   }
 
+  // Whether some index on colName can answer equality lookups.
   bool hasIndexForColumn(const std::string& colName) const {
+    return indexManager && indexManager->findIndexForColumn(colName) != nullptr;
+  }
+
+  // Whether some index on colName can answer range lookups.
+  bool hasOrderedIndexForColumn(const std::string& colName) const {
+    return indexManager && indexManager->findIndexForColumn(colName, /*ordered=*/true) != nullptr;
+  }
+
+  std::vector<size_t> searchRowsByIndexedValue(const std::string& colName, const Value& value) const {
+    const IndexDefinition* def = indexManager ? indexManager->findIndexForColumn(colName) : nullptr;
+    if (!def) {
+      return {};
+    }
+    return indexManager->searchIndex(def->name, value);
+  }
+
+  /**
+   * Returns the rows holding value as a compressed bitmap, for combining
+   * several predicates with & and | before any rows are materialized.
+   * 
+   * @param colName Name of the indexed column.
+   * @param value Value to look up.
+   * @return The value's rows (empty if it does not occur), or nullptr if colName has no bitmap index.
+   * 
+   * @example
+   * const RoaringBitmap* active = table.searchBitmapByIndexedValue("active", Value(true));
+   * const RoaringBitmap* admins = table.searchBitmapByIndexedValue("role", Value(std::string("admin")));
+   * if (active && admins) rows = (*active & *admins).toRows();
+   */
+  const RoaringBitmap* searchBitmapByIndexedValue(const std::string& colName, const Value& value) const {
+    static const RoaringBitmap empty;
     if (!indexManager) {
-      return false;
+      return nullptr;
+    }
+    for (const IndexDefinition& def : indexManager->getDefinitions()) {
+      if (def.column == colName && def.kind == IndexKind::BITMAP) {
+        const RoaringBitmap* rows = indexManager->searchBitmap(def.name, value);
+        return rows ? rows : &empty;
+      }
     }
-    return indexManager->hasIndex(colName);
+    return nullptr;
   }
 
-  std::vector<size_t> searchRowsByIndexedValue(const std::string& colName, const Value& value) {
-    if (!indexManager || !indexManager->hasIndex(colName)) {
+  /**
+   * Looks up the rows whose indexed value lies in range.
+   * 
+   * @param colName Name of the indexed column.
+   * @param range Bounds to match; a missing bound is open.
+   * @return Matching row indices in ascending key order, or none if the column has no ordered index.
+   * 
+   * @example
+   * ValueRange recent{Value(1700000000), true, std::nullopt, true};
+   * std::vector<size_t> rows = table.searchRowsByIndexedRange("created_at", recent);
+   */
+  std::vector<size_t> searchRowsByIndexedRange(const std::string& colName, const ValueRange& range) const {
+    const IndexDefinition* def = indexManager ? indexManager->findIndexForColumn(colName, /*ordered=*/true) : nullptr;
+    if (!def) {
       return {};
     }
-    return indexManager->searchIndex(colName, value);
+    return indexManager->rangeSearchIndex(def->name, range);
+  }
+
+  // The index searchRowsByIndexedValue (or, if ordered, searchRowsByIndexedRange) would use for colName, or nullptr.
+  const IndexDefinition* findIndexForColumn(const std::string& colName, bool ordered = false) const {
+    return indexManager ? indexManager->findIndexForColumn(colName, ordered) : nullptr;
+  }
+
+  /**
+   * Looks a value up in one specific index, for callers that choose
+   * between several indexes on the same column.
+   *
+   * @param def One of getIndexDefinitions().
+   * @param value Value to look up.
+   * @return Matching row indices.
+   *
+   * @example
+   * for (const IndexDefinition& def : table.getIndexDefinitions()) {
+   *   if (def.column == "city" && def.kind == IndexKind::BITMAP) rows = table.searchRowsByIndex(def, Value(std::string("Oslo")));
+   * }
+   */
+  std::vector<size_t> searchRowsByIndex(const IndexDefinition& def, const Value& value) const {
+    return indexManager->searchIndex(def.name, value);
+  }
+
+  /**
+   * Looks several values up in one specific index at once (see
+   * searchRowsByIndex); the index is resolved once for the whole batch and
+   * the rows are collected into one array.
+   *
+   * @param def One of getIndexDefinitions().
+   * @param values Values to look up.
+   * @param offsets Receives values.size() + 1 offsets: the rows of values[i] are rows[offsets[i] .. offsets[i + 1]).
+   * @param rows Receives the matching row indices.
+   *
+   * @example
+   * std::vector<size_t> offsets, rows;
+   * table.searchRowsByIndexBatch(*table.findIndexForColumn("id"), {Value(3), Value(7)}, offsets, rows);
+   */
+  void searchRowsByIndexBatch(const IndexDefinition& def, const std::vector<Value>& values,
+                              std::vector<size_t>& offsets, std::vector<size_t>& rows) const {
+    indexManager->searchIndexBatch(def.name, values, offsets, rows);
+  }
+
+  /**
+   * Gives visit the B+tree behind a BTREE index, so its keys can be walked
+   * in order (BPlusTree::rangeSearch with open bounds) without collecting
+   * the rows first.
+   *
+   * @param def One of getIndexDefinitions(), of kind BTREE.
+   * @param visit Callable taking a const BPlusTree<int>&, <std::string>& or <bool>&.
+   * @throws std::runtime_error if def is not a B+tree index of this table.
+   *
+   * @example
+   * table.visitIndexTree(*table.findIndexForColumn("id", true), [](const auto& tree) {
+   *   for (auto it = tree.rangeSearch(std::nullopt, std::nullopt); it.valid(); it.next()) use(it.key(), it.rows());
+   * });
+   */
+  template<typename Visitor>
+  void visitIndexTree(const IndexDefinition& def, Visitor&& visit) const {
+    indexManager->visitTree(def.name, std::forward<Visitor>(visit));
+  }
+
+  /**
+   * Collects statistics for every column (see ColumnStatistics) and keeps
+   * them with the table, replacing any earlier ones. Rows inserted later
+   * are not reflected until the next call.
+   * 
+   * @param pool Optional thread pool; columns are then analyzed concurrently.
+   * 
+   * @example
+   * table.analyze();
+   * const TableStatistics* stats = table.getStatistics();
+   */
+  void analyze(ThreadPool* pool = nullptr) {
+    auto collected = std::make_shared<TableStatistics>();
+    collected->rowCount = rowCount;
+    collected->columns.resize(columns.size());
+    if (pool) {
+      pool->parallelFor(columns.size(), [&](size_t i) { collected->columns[i] = ColumnStatistics::collect(columns[i]); });
+    } else {
+      for (size_t i = 0; i < columns.size(); ++i) {
+        collected->columns[i] = ColumnStatistics::collect(columns[i]);
+      }
+    }
+    statistics = std::move(collected);
+  }
+
+  // Statistics from the last analyze (or the table file), or nullptr.
+  const TableStatistics* getStatistics() const { return statistics.get(); }
+
+  void setStatistics(TableStatistics stats) {
+    if (stats.columns.size() != columns.size()) {
+      throw std::invalid_argument("Statistics do not match the table's columns");
+    }
+    statistics = std::make_shared<const TableStatistics>(std::move(stats));
   }
 
   Table& operator=(const Table& other) {
@@ -306,9 +684,11 @@ public:
       columnNames = other.columnNames;
       columnTypes = other.columnTypes;
       columnIndexMap = other.columnIndexMap;
-      rows = other.rows;
-      initializeIndexes();
-      rebuildIndexes();
+      columns = other.columns;
+      rowCount = other.rowCount;
+      statistics = other.statistics;
+      resetIndexes(other.getIndexDefinitions());
+      buildIndexes();
     }
     return *this;
   }
@@ -0,0 +1,169 @@
+#ifndef TABLE_STATISTICS_H
+#define TABLE_STATISTICS_H
+
+#include "value.h"
+#include "column.h"
+#include <algorithm>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/*
+===========================================================================
+ColumnStatistics:
+Summary of one column's values, collected by ANALYZE and used by the
+query cost model to estimate how many rows a predicate matches.
+
+The histogram is equi-depth: bounds holds BUCKETS + 1 values, the minimum,
+then the value at which each successive 1/BUCKETS of the rows (in sorted
+order) ends. Every bucket holds about the same number of rows, so a value
+that is a bound of several buckets is a frequent one, and narrow buckets
+mark dense ranges. Columns cannot hold NULLs yet, so nullCount is 0.
+===========================================================================
+*/
+struct ColumnStatistics {
+  static constexpr size_t BUCKETS = 64;
+
+  uint64_t rowCount = 0;
+  uint64_t nullCount = 0;
+  uint64_t distinctCount = 0;
+  std::vector<Value> bounds; // Empty for an empty column
+
+  /**
+   * Collects the statistics of a column. INT columns are sorted once;
+   * BOOL and STRING columns are counted per value (per dictionary code),
+   * so only the distinct strings are sorted.
+   *
+   * @param column Column to summarize.
+   * @return The column's statistics.
+   *
+   * @example
+   * ColumnStatistics ages = ColumnStatistics::collect(table.getColumn(2));
+   */
+  static ColumnStatistics collect(const Column& column) {
+    switch (column.getType()) {
+      case Value::INT: {
+        std::vector<int> sorted = column.getIntValues();
+        std::sort(sorted.begin(), sorted.end());
+        std::vector<int> keys;
+        std::vector<uint64_t> counts;
+        for (size_t i = 0; i < sorted.size(); ++i) {
+          if (i == 0 || sorted[i] != sorted[i - 1]) {
+            keys.push_back(sorted[i]);
+            counts.push_back(0);
+          }
+          ++counts.back();
+        }
+        return fromCounts(counts, [&](size_t i) { return Value(keys[i]); });
+      }
+      case Value::BOOL: {
+        uint64_t trues = 0;
+        for (uint8_t v : column.getBoolValues()) trues += v;
+        std::vector<bool> keys;
+        std::vector<uint64_t> counts;
+        const uint64_t falses = column.getBoolValues().size() - trues;
+        if (falses) { keys.push_back(false); counts.push_back(falses); }
+        if (trues) { keys.push_back(true); counts.push_back(trues); }
+        return fromCounts(counts, [&](size_t i) { return Value(static_cast<bool>(keys[i])); });
+      }
+      case Value::STRING: {
+        const StringDictionary& dictionary = column.getDictionary();
+        std::vector<uint64_t> perCode(dictionary.size());
+        for (uint32_t code : column.getStringCodes()) ++perCode[code];
+        std::vector<uint32_t> codes;
+        for (uint32_t code = 0; code < perCode.size(); ++code) {
+          if (perCode[code]) codes.push_back(code);
+        }
+        std::sort(codes.begin(), codes.end(), [&](uint32_t a, uint32_t b) {
+          return std::string_view(dictionary.decode(a)) < std::string_view(dictionary.decode(b));
+        });
+        std::vector<uint64_t> counts;
+        counts.reserve(codes.size());
+        for (uint32_t code : codes) counts.push_back(perCode[code]);
+        return fromCounts(counts, [&](size_t i) { return Value(std::string_view(dictionary.decode(codes[i]))); });
+      }
+      default:
+        return ColumnStatistics();
+    }
+  }
+
+  /**
+   * Estimates the fraction of rows equal to value.
+   *
+   * @param value Value to look up.
+   * @return Estimated fraction in [0, 1].
+   */
+  double equalsFraction(const Value& value) const {
+    if (bounds.empty() || value.getType() != bounds[0].getType()) return 0.0;
+    if (value < bounds.front() || bounds.back() < value) return 0.0;
+    // A value closing k buckets covers at least k - 1 whole buckets.
+    auto range = std::equal_range(bounds.begin() + 1, bounds.end(), value);
+    const double spanned = static_cast<double>(range.second - range.first) - 1.0;
+    return std::min(1.0, std::max(1.0 / static_cast<double>(distinctCount), spanned / bucketCount()));
+  }
+
+  /**
+   * Estimates the fraction of rows inside range.
+   *
+   * @param range Bounds; a missing bound is open.
+   * @return Estimated fraction in [0, 1].
+   */
+  double rangeFraction(const ValueRange& range) const {
+    if (bounds.empty()) return 0.0;
+    double high = 1.0;
+    double low = 0.0;
+    if (range.upper) {
+      high = atMost(*range.upper) - (range.upperInclusive ? 0.0 : equalsFraction(*range.upper));
+    }
+    if (range.lower) {
+      low = atMost(*range.lower) - (range.lowerInclusive ? equalsFraction(*range.lower) : 0.0);
+    }
+    return std::clamp(high - low, 0.0, 1.0);
+  }
+
+private:
+  double bucketCount() const { return static_cast<double>(bounds.size() - 1); }
+
+  // Estimated fraction of rows <= value: whole buckets below it, plus a
+  // linear share of the bucket it falls in (half a bucket for non-INT).
+  double atMost(const Value& value) const {
+    if (value.getType() != bounds[0].getType()) return 0.0;
+    if (value < bounds.front()) return 0.0;
+    if (!(value < bounds.back())) return 1.0;
+    const size_t bucket = static_cast<size_t>(std::upper_bound(bounds.begin(), bounds.end(), value) - bounds.begin()) - 1;
+    double within = 0.5;
+    if (value.getType() == Value::INT) {
+      const double lo = bounds[bucket].getInt();
+      const double hi = bounds[bucket + 1].getInt();
+      within = hi > lo ? (value.getInt() - lo) / (hi - lo) : 1.0;
+    }
+    return (static_cast<double>(bucket) + within) / bucketCount();
+  }
+
+  // Builds the statistics from per-value counts in ascending value order.
+  template<typename ValueAt>
+  static ColumnStatistics fromCounts(const std::vector<uint64_t>& counts, ValueAt valueAt) {
+    ColumnStatistics stats;
+    stats.distinctCount = counts.size();
+    for (uint64_t count : counts) stats.rowCount += count;
+    if (counts.empty()) return stats;
+
+    stats.bounds.push_back(valueAt(0));
+    uint64_t seen = 0;
+    size_t i = 0;
+    for (size_t bucket = 1; bucket <= BUCKETS; ++bucket) {
+      const uint64_t target = (stats.rowCount * bucket + BUCKETS - 1) / BUCKETS;
+      while (seen + counts[i] < target) seen += counts[i++];
+      stats.bounds.push_back(valueAt(i));
+    }
+    return stats;
+  }
+};
+
+// Statistics for every column of a table, in column order.
+struct TableStatistics {
+  uint64_t rowCount = 0;
+  std::vector<ColumnStatistics> columns;
+};
+
+#endif
@@ -1,47 +1,107 @@
 #ifndef VALUE_H
 #define VALUE_H
 
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <stdexcept>
 
-class Value {
+/*
+===========================================================================
+Value Class:
+A 16-byte tagged value. INT and BOOL live in the payload bytes; strings of
+up to INLINE_CAPACITY characters are stored inline, longer ones in a heap
+block whose pointer and length take the payload's place. Moves steal the
+heap block and are noexcept, so vectors of Values relocate without
+copying strings.
+===========================================================================
+*/
+class alignas(8) Value {
 public:
-  enum Type { INT, STRING, BOOL, NULL_TYPE };
+  enum Type : uint8_t { INT, STRING, BOOL, NULL_TYPE };
 
 private:
+  static constexpr size_t INLINE_CAPACITY = 14;
+  static constexpr uint8_t HEAP_STRING = 0xFF;
+
+  char payload[INLINE_CAPACITY]; // int, bool, inline characters, or heap pointer + uint32 length
+  uint8_t stringLength = 0;      // Length of an inline string, or HEAP_STRING
   Type type;
-  union {
-    int intValue;
-    bool boolValue;
-  };
-  std::string stringValue; // Keep string outside the union
+
+  bool isHeapString() const { return type == STRING && stringLength == HEAP_STRING; }
+
+  char* heapData() const {
+    char* data;
+    std::memcpy(&data, payload, sizeof(data));
+    return data;
+  }
+
+  uint32_t heapLength() const {
+    uint32_t length;
+    std::memcpy(&length, payload + sizeof(char*), sizeof(length));
+    return length;
+  }
+
+  void setString(const char* data, size_t length) {
+    if (length <= INLINE_CAPACITY) {
+      std::memcpy(payload, data, length);
+      stringLength = static_cast<uint8_t>(length);
+      return;
+    }
+    if (length > std::numeric_limits<uint32_t>::max()) {
+      throw std::length_error("String too long for a Value");
+    }
+    char* heap = new char[length];
+    std::memcpy(heap, data, length);
+    const uint32_t heapSize = static_cast<uint32_t>(length);
+    std::memcpy(payload, &heap, sizeof(heap));
+    std::memcpy(payload + sizeof(char*), &heapSize, sizeof(heapSize));
+    stringLength = HEAP_STRING;
+  }
+
+  void copyFrom(const Value& other) {
+    if (other.isHeapString()) {
+      type = NULL_TYPE; // Stays valid if the allocation throws
+      setString(other.heapData(), other.heapLength());
+    } else {
+      std::memcpy(payload, other.payload, INLINE_CAPACITY);
+      stringLength = other.stringLength;
+    }
+    type = other.type;
+  }
+
+  // Takes other's bytes (and heap block, if any) and leaves it NULL.
+  void stealFrom(Value& other) noexcept {
+    std::memcpy(payload, other.payload, INLINE_CAPACITY);
+    stringLength = other.stringLength;
+    type = other.type;
+    other.type = NULL_TYPE;
+    other.stringLength = 0;
+  }
+
+  void release() noexcept {
+    if (isHeapString()) delete[] heapData();
+  }
 
 public:
   Value() : type(NULL_TYPE) {}
   
-  Value(int v) : type(INT), intValue(v) {}
+  Value(int v) : type(INT) { std::memcpy(payload, &v, sizeof(v)); }
+  
+  Value(const std::string& v) : type(STRING) { setString(v.data(), v.size()); }
   
-  Value(const std::string& v) : type(STRING), stringValue(v) {}
+  Value(std::string_view v) : type(STRING) { setString(v.data(), v.size()); }
   
-  Value(const char* v) : type(STRING), stringValue(v) {}
+  Value(const char* v) : type(STRING) { setString(v, std::strlen(v)); }
   
-  Value(bool v) : type(BOOL), boolValue(v) {}
+  Value(bool v) : type(BOOL) { payload[0] = v ? 1 : 0; }
 
-  Value(const Value& other) : type(other.type) {
-    switch (type) {
-      case INT:
-        intValue = other.intValue;
-        break;
-      case STRING:
-        stringValue = other.stringValue;
-        break;
-      case BOOL:
-        boolValue = other.boolValue;
-        break;
-      case NULL_TYPE:
-        break;
-    }
-  }
+  Value(const Value& other) : type(NULL_TYPE) { copyFrom(other); }
+
+  Value(Value&& other) noexcept { stealFrom(other); }
 
   /**
    * Assignment operator.
@@ -56,25 +116,33 @@ public:
    */
   Value& operator=(const Value& other) {
     if (this != &other) {
-      type = other.type;
-      switch (type) {
-        case INT:
-          intValue = other.intValue;
-          break;
-        case STRING:
-          stringValue = other.stringValue;
-          break;
-        case BOOL:
-          boolValue = other.boolValue;
-          break;
-        case NULL_TYPE:
-          break;
-      }
+      release();
+      type = NULL_TYPE;
+      copyFrom(other);
+    }
+    return *this;
+  }
+
+  /**
+   * Move assignment. Takes over other's string storage without copying and
+   * leaves other NULL.
+   * 
+   * @param other The Value to move from.
+   * @return Reference to this Value.
+   * 
+   * @example
+   * std::vector<Value> row;
+   * row.push_back(Value(std::string(100, 'x'))); // Moved, not copied
+   */
+  Value& operator=(Value&& other) noexcept {
+    if (this != &other) {
+      release();
+      stealFrom(other);
     }
     return *this;
   }
   
-  ~Value() = default;
+  ~Value() { release(); }
 
   Type getType() const { return type; }
 
@@ -92,7 +160,9 @@ public:
    */
   int getInt() const {
     if (type != INT) throw std::runtime_error("Type mismatch: not an int");
-    return intValue;
+    int v;
+    std::memcpy(&v, payload, sizeof(v));
+    return v;
   }
 
   /**
@@ -107,9 +177,25 @@ public:
    * Value intVal(42);
    * std::string invalidStr = intVal.getString(); // Throws std::runtime_error
    */
-  const std::string& getString() const {
+  std::string getString() const {
+    return std::string(getStringView());
+  }
+
+  /**
+   * Gets the string value without copying it. The view is valid as long as
+   * this Value is neither modified nor destroyed.
+   * 
+   * @return View of the string value.
+   * @throws std::runtime_error if the Value is not of type STRING.
+   * 
+   * @example
+   * Value val("hello");
+   * bool greeting = val.getStringView() == "hello"; // greeting will be true
+   */
+  std::string_view getStringView() const {
     if (type != STRING) throw std::runtime_error("Type mismatch: not a string");
-    return stringValue;
+    if (stringLength == HEAP_STRING) return std::string_view(heapData(), heapLength());
+    return std::string_view(payload, stringLength);
   }
 
   /**
@@ -126,7 +212,7 @@ public:
    */
   bool getBool() const {
     if (type != BOOL) throw std::runtime_error("Type mismatch: not a bool");
-    return boolValue;
+    return payload[0] != 0;
   }
 
   /**
@@ -146,17 +232,43 @@ public:
     if (type != other.type) return false;
     switch (type) {
       case INT:
-        return intValue == other.intValue;
+        return getInt() == other.getInt();
       case STRING:
-        return stringValue == other.stringValue;
+        return getStringView() == other.getStringView();
       case BOOL:
-        return boolValue == other.boolValue;
+        return getBool() == other.getBool();
       case NULL_TYPE:
         return true; // Both are NULL_TYPE
     }
     return false; // Should never reach here
   }
 
+  /**
+   * Ordering operator.
+   * Values of the same type compare by content (false < true for BOOL);
+   * values of different types are ordered by their Type.
+   * 
+   * @param other The Value to compare with.
+   * @return true if this Value sorts before other.
+   * 
+   * @example
+   * bool less = Value(1) < Value(2); // less will be true
+   */
+  bool operator<(const Value& other) const {
+    if (type != other.type) return type < other.type;
+    switch (type) {
+      case INT:
+        return getInt() < other.getInt();
+      case STRING:
+        return getStringView() < other.getStringView();
+      case BOOL:
+        return getBool() < other.getBool();
+      case NULL_TYPE:
+        return false;
+    }
+    return false;
+  }
+
   /**
    * Checks if the Value matches the expected type.
    * 
@@ -219,4 +331,36 @@ public:
   }
 };
 
+static_assert(sizeof(Value) == 16, "Value should stay 16 bytes");
+
+/*
+===========================================================================
+ValueRange:
+Bounds of a range predicate such as "age >= 18" or "id BETWEEN 1 AND 10".
+A missing bound leaves that side of the range open.
+===========================================================================
+*/
+struct ValueRange {
+  std::optional<Value> lower;
+  bool lowerInclusive = true;
+  std::optional<Value> upper;
+  bool upperInclusive = true;
+
+  /**
+   * Checks whether a value lies inside the range.
+   * 
+   * @param val The Value to test.
+   * @return true if val satisfies both bounds.
+   * 
+   * @example
+   * ValueRange adults{Value(18), true, std::nullopt, true};
+   * bool ok = adults.contains(Value(30)); // ok will be true
+   */
+  bool contains(const Value& val) const {
+    if (lower && (lowerInclusive ? val < *lower : !(*lower < val))) return false;
+    if (upper && (upperInclusive ? *upper < val : !(val < *upper))) return false;
+    return true;
+  }
+};
+
 #endif
@@ -1,32 +1,84 @@
 // simpleDB
 
+#include <cstring>
 #include <iostream>
+#include <string>
 #include "../includes/query_processor.h"
 #include "../includes/storage.h"
 
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--load-threads N] [--preload]\n";
+    std::cerr << "  --load-threads N  threads used to load tables and build indexes (default: all cores, at most "
+              << ThreadPool::maxThreads() << ")\n";
+    std::cerr << "  --preload         load every table at startup instead of on first use\n";
+}
+
+int main(int argc, char* argv[]) {
+    size_t loadThreads = 0;
+    bool preload = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--load-threads") == 0 && i + 1 < argc) {
+            try {
+                long threads = std::stol(argv[++i]);
+                if (threads < 1) throw std::invalid_argument("must be at least 1");
+                loadThreads = static_cast<size_t>(threads);
+            } catch (const std::exception&) {
+                std::cerr << "Invalid value for --load-threads: " << argv[i] << "\n";
+                return 1;
+            }
+            if (loadThreads > ThreadPool::maxThreads()) {
+                std::cerr << "--load-threads must be at most " << ThreadPool::maxThreads() << "\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--preload") == 0) {
+            preload = true;
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
 
-int main() {
     std::cout << "simpleDB - A minimal DBMS written in C++\n";
     std::cout << "Type 'EXIT' to quit, 'HELP' for commands\n";
     
-    Storage storage("simpledb_data");
+    Storage storage("simpledb_data", loadThreads);
+    if (preload) {
+        storage.loadAllTables();
+    }
     QueryProcessor processor(storage);
     
     std::string input;
     while (true) {
         std::cout << "simpledb> ";
-        std::getline(std::cin, input);
+        if (!std::getline(std::cin, input)) {
+            input = "EXIT"; // End of input behaves like EXIT
+        }
         
         if (input == "EXIT" || input == "exit") {
-            for(const Table& table : storage.getAllTables()) {
-                storage.persistTable(table.getTableName());
-            }
+            storage.checkpoint();
             break;
         } else if (input == "HELP" || input == "help") {
             std::cout << "Supported commands:\n";
             std::cout << "  CREATE TABLE table_name\n";
-            std::cout << "  INSERT INTO table_name VALUES (val1, val2, ...)\n";
+            std::cout << "  CREATE INDEX index_name ON table_name(column) [USING btree|hash|bitmap]\n";
+            std::cout << "  DROP INDEX index_name ON table_name\n";
+            std::cout << "  ANALYZE table_name\n";
+            std::cout << "  INSERT INTO table_name VALUES val1, val2, ...\n";
+            std::cout << "  INSERT INTO table_name VALUES (val1, val2, ...), (val1, val2, ...)\n";
+            std::cout << "  COPY table_name FROM 'file.csv' [HEADER]\n";
             std::cout << "  SELECT * FROM table_name\n";
+            std::cout << "  SELECT col1, col2 FROM table_name WHERE col (= | < | <= | > | >=) value\n";
+            std::cout << "  SELECT * FROM table_name WHERE col BETWEEN low AND high\n";
+            std::cout << "  SELECT * FROM table_name WHERE a <> 1 AND (b IN (x, y) OR NOT c IS NULL)\n";
+            std::cout << "  SELECT a.x, b.y FROM t1 a JOIN t2 b ON a.k = b.k [WHERE ...]\n";
+            std::cout << "  SELECT col, COUNT(*), SUM(x), MIN(x), MAX(x), AVG(x), COUNT(DISTINCT y) FROM table_name [WHERE ...] GROUP BY col\n";
+            std::cout << "  PREPARE name AS SELECT ... | INSERT ...   (? marks a parameter)\n";
+            std::cout << "  EXECUTE name(val1, val2, ...)\n";
+            std::cout << "  DEALLOCATE name\n";
+            std::cout << "  SET sync = off | batch | full\n";
+            std::cout << "  SET commit_window = microseconds\n";
+            std::cout << "  SET parallelism = threads\n";
+            std::cout << "  SET join_memory_kb = kilobytes\n";
         } else if (!input.empty()) {
             processor.execute(input);
         }